@@ -1,11 +1,14 @@
 #include "cmdline.h"
 
 struct args cmdline_args = {
-    .pl_mem_base     = 0x400000000,
-    .pl_mem_size     = 0x100000000,
-    .udp_port        = 1234,
-    .server_buf_size = 4096,
-    .etherbone_abort = false,
+    .pl_mem_file      = "/dev/mem",
+    .pl_mem_base      = 0x400000000,
+    .pl_mem_size      = 0x100000000,
+    .udp_port         = 1234,
+    .server_buf_size  = 4096,
+    .etherbone_abort  = false,
+    .compare_port     = 1235,
+    .compare_buf_size = 65536,
 };
 
 #define PARSE_ARG(store, name) do {               \
@@ -25,6 +28,19 @@ struct args cmdline_args = {
         }                                         \
     } while (0);
 
+#define PARSE_STRING_ARG(store, name) do {        \
+        if (strcmp(argv[i], name) == 0) {         \
+            i++;                                  \
+            if (i >= argc) {                      \
+                perror("Missing value for" name); \
+                exit(1);                          \
+            }                                     \
+            store = argv[i];                      \
+            found = 1;                            \
+            continue;                             \
+        }                                         \
+    } while (0);
+
 #define PARSE_BOOLEAN_ARG(store, name) do {       \
         if (strcmp(argv[i], name) == 0) {         \
             store = true;                         \
@@ -41,17 +57,23 @@ void parse_args(int argc, char *argv[]) {
                 "Usage: %s [args...]\n"
                 "\n"
                 "Options:\n"
+                "  --pl-mem-file      Device or file providing the PL memory (default: %s)\n"
                 "  --pl-mem-base      Base physical address of memory connected to PL (default: 0x%012lx)\n"
                 "  --pl-mem-size      Size of the PL memory area (default: 0x%012lx)\n"
                 "  --udp-port         UDP port to use (default: %d)\n"
                 "  --server-buf-size  Size of internal server buffer (default: %lu)\n"
                 "  --etherbone-abort  Abort on EtherBone packet errors (default: false)\n"
+                "  --compare-port     UDP port of the row compare service, 0 disables it (default: %d)\n"
+                "  --compare-buf-size Size of the row compare server buffer (default: %lu)\n"
                 ;
             printf(usage, argv[0],
+                    cmdline_args.pl_mem_file,
                     cmdline_args.pl_mem_base,
                     cmdline_args.pl_mem_size,
                     cmdline_args.udp_port,
-                    cmdline_args.server_buf_size);
+                    cmdline_args.server_buf_size,
+                    cmdline_args.compare_port,
+                    cmdline_args.compare_buf_size);
             exit(0);
         }
     }
@@ -61,11 +83,14 @@ void parse_args(int argc, char *argv[]) {
     while (i < argc) {
         char *res;
         int found = 0;
+        PARSE_STRING_ARG(cmdline_args.pl_mem_file, "--pl-mem-file");
         PARSE_ARG(cmdline_args.pl_mem_base,     "--pl-mem-base");
         PARSE_ARG(cmdline_args.pl_mem_size,     "--pl-mem-size");
         PARSE_ARG(cmdline_args.udp_port,        "--udp-port");
         PARSE_ARG(cmdline_args.server_buf_size, "--server-buf-size");
         PARSE_BOOLEAN_ARG(cmdline_args.etherbone_abort, "--etherbone-abort");
+        PARSE_ARG(cmdline_args.compare_port,     "--compare-port");
+        PARSE_ARG(cmdline_args.compare_buf_size, "--compare-buf-size");
         if (found == 0) {
             printf("Error: wrong argument: %s\n", argv[i]);
             exit(1);
@@ -8,11 +8,14 @@
 #include <string.h>
 
 struct args {
+    const char *pl_mem_file;
     off_t pl_mem_base;
     size_t pl_mem_size;
     int udp_port;
     size_t server_buf_size;
     bool etherbone_abort;
+    int compare_port;
+    size_t compare_buf_size;
 };
 
 extern struct args cmdline_args;
@@ -2,10 +2,14 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
 
 #include "pl_mmap.h"
 #include "udp_server.h"
 #include "etherbone.h"
+#include "row_compare.h"
 #include "cmdline.h"
 #include "debug.h"
 
@@ -46,17 +50,43 @@ int run_server(struct pl_mmap *pl_mem) {
     return udp_server_run(&mem, callback, cmdline_args.udp_port, cmdline_args.server_buf_size);
 }
 
+// Serve row compare requests from a child process sharing the PL memory mapping,
+// so that long compares never stall the EtherBone server.
+pid_t start_row_compare_server(struct pl_mmap *pl_mem) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Could not start row compare server");
+        return pid;
+    }
+    if (pid == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        int ret = udp_server_run(pl_mem, (udp_server_callback) &row_compare_callback,
+                cmdline_args.compare_port, cmdline_args.compare_buf_size);
+        exit(ret < 0 ? 1 : 0);
+    }
+    return pid;
+}
+
 int main(int argc, char *argv[])
 {
     parse_args(argc, argv);
 
     struct pl_mmap pl_mem;
-    if (pl_mmap_open(&pl_mem, cmdline_args.pl_mem_base, cmdline_args.pl_mem_size) < 0) {
+    if (pl_mmap_open(&pl_mem, cmdline_args.pl_mem_file, cmdline_args.pl_mem_base, cmdline_args.pl_mem_size) < 0) {
         return 1;
     }
 
+    pid_t compare_pid = -1;
+    if (cmdline_args.compare_port != 0) {
+        compare_pid = start_row_compare_server(&pl_mem);
+    }
+
     int ret = run_server(&pl_mem);
 
+    if (compare_pid > 0) {
+        kill(compare_pid, SIGTERM);
+    }
+
     pl_mmap_close(&pl_mem);
 
     return ret;
@@ -3,15 +3,16 @@
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #include "pl_mmap.h"
 
-int pl_mmap_open(struct pl_mmap *pl_mem, off_t base_address, size_t size) {
+int pl_mmap_open(struct pl_mmap *pl_mem, const char *path, off_t base_address, size_t size) {
     memset(pl_mem, 0, sizeof(struct pl_mmap));
 
-    int mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+    int mem_fd = open(path, O_RDWR | O_SYNC);
     if (mem_fd < 0) {
-        perror("Could not open /dev/mem");
+        perror("Could not open memory device");
         goto error;
     }
 
@@ -21,6 +22,15 @@ int pl_mmap_open(struct pl_mmap *pl_mem, off_t base_address, size_t size) {
     off_t page_offset = base_address - page_base;
     off_t len = page_offset + size;
 
+    // File-backed window: make sure the mapped range exists
+    struct stat st;
+    if (fstat(mem_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size < page_base + len) {
+        if (ftruncate(mem_fd, page_base + len) < 0) {
+            perror("Could not resize memory file");
+            goto error;
+        }
+    }
+
     void *mem = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, page_base);
     if (mem == MAP_FAILED) {
         perror("Could not map memory");
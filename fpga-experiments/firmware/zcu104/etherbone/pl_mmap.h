@@ -9,7 +9,9 @@ struct pl_mmap {
     size_t len;
 };
 
-int pl_mmap_open(struct pl_mmap *pl_mem, off_t base_address, size_t size);
+// path is usually /dev/mem; a regular file can be used instead to test on a host
+// machine (base_address is then an offset into the file, which is grown to size)
+int pl_mmap_open(struct pl_mmap *pl_mem, const char *path, off_t base_address, size_t size);
 void pl_mmap_close(struct pl_mmap *pl_mem);
 
 #endif /* PL_MMAP_H */
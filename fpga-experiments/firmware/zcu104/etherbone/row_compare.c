@@ -0,0 +1,190 @@
+#include "row_compare.h"
+
+#include <arpa/inet.h>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// words compared per iteration of the vector loop
+#define BLOCK_WORDS 16
+
+struct compare_state {
+    struct row_compare_mismatch *out;
+    uint32_t max_reported;
+    uint32_t nreported;
+    uint32_t nmismatches;
+};
+
+static void report_mismatch(struct compare_state *state,
+        uint32_t addr, uint32_t data, uint32_t expected)
+{
+    dbg_printf("0x%08x: 0x%08x != 0x%08x\n", addr, data, expected);
+    if (state->nreported < state->max_reported) {
+        struct row_compare_mismatch *m = &state->out[state->nreported++];
+        m->addr = htonl(addr);
+        m->data = htonl(data);
+        m->expected = htonl(expected);
+    }
+    state->nmismatches++;
+}
+
+static void compare_words_scalar(struct compare_state *state,
+        const volatile uint32_t *mem, uint32_t addr, size_t from, size_t to,
+        const uint32_t *pattern, uint32_t npattern)
+{
+    for (size_t i = from; i < to; ++i) {
+        uint32_t data = mem[i];
+        uint32_t expected = pattern[i % npattern];
+        if (data != expected) {
+            report_mismatch(state, addr + 4 * i, data, expected);
+        }
+    }
+}
+
+#ifdef __ARM_NEON
+// Compares BLOCK_WORDS words at a time and only falls back to per-word checks
+// for blocks containing a mismatch. Requires 16-byte aligned memory and a
+// pattern that is either a single word or a multiple of 4 words long.
+static size_t compare_words_neon(struct compare_state *state,
+        const volatile uint32_t *mem, uint32_t addr, size_t nwords,
+        const uint32_t *pattern, uint32_t npattern)
+{
+    // vld1q cannot take a volatile pointer; every word is still read exactly once
+    const uint32_t *src = (const uint32_t *) mem;
+    uint32x4_t fill = vdupq_n_u32(pattern[0]);
+    size_t i = 0;
+
+    for (; i + BLOCK_WORDS <= nwords; i += BLOCK_WORDS) {
+        uint32x4_t data[4], expected[4];
+        uint32x4_t diff = vdupq_n_u32(0);
+        for (int j = 0; j < 4; ++j) {
+            data[j] = vld1q_u32(src + i + 4 * j);
+            expected[j] = npattern == 1 ? fill : vld1q_u32(pattern + (i + 4 * j) % npattern);
+            diff = vorrq_u32(diff, veorq_u32(data[j], expected[j]));
+        }
+        if (vmaxvq_u32(diff) == 0) {
+            continue;
+        }
+
+        uint32_t data_words[BLOCK_WORDS], expected_words[BLOCK_WORDS];
+        for (int j = 0; j < 4; ++j) {
+            vst1q_u32(data_words + 4 * j, data[j]);
+            vst1q_u32(expected_words + 4 * j, expected[j]);
+        }
+        for (int j = 0; j < BLOCK_WORDS; ++j) {
+            if (data_words[j] != expected_words[j]) {
+                report_mismatch(state, addr + 4 * (i + j), data_words[j], expected_words[j]);
+            }
+        }
+    }
+
+    return i;
+}
+#endif
+
+static void compare_range(struct compare_state *state, struct pl_mmap *pl_mem,
+        uint32_t addr, uint32_t len, const uint32_t *pattern, uint32_t npattern)
+{
+    const volatile uint32_t *mem = (const volatile uint32_t *) ((uint8_t *) pl_mem->mem + addr);
+    size_t nwords = len / 4;
+    size_t done = 0;
+
+#ifdef __ARM_NEON
+    if (((uintptr_t) mem % 16) == 0 && (npattern == 1 || npattern % 4 == 0)) {
+        done = compare_words_neon(state, mem, addr, nwords, pattern, npattern);
+    }
+#endif
+
+    compare_words_scalar(state, mem, addr, done, nwords, pattern, npattern);
+}
+
+static int row_compare_error(uint8_t *buf, uint32_t seq, uint16_t status)
+{
+    struct row_compare_response *resp = (struct row_compare_response *) buf;
+    memset(resp, 0, sizeof(*resp));
+    resp->magic = htonl(ROW_COMPARE_MAGIC);
+    resp->version = htons(ROW_COMPARE_VERSION);
+    resp->status = htons(status);
+    resp->seq = htonl(seq);
+    return sizeof(*resp);
+}
+
+int row_compare_callback(struct pl_mmap *pl_mem,
+        uint8_t *buf, size_t buf_size, size_t recv_len)
+{
+    if (recv_len < sizeof(struct row_compare_request) || buf_size < sizeof(struct row_compare_response)) {
+        fprintf(stderr, "Row compare request too short: recv_len=%lu\n", recv_len);
+        return 0;
+    }
+
+    struct row_compare_request *req = (struct row_compare_request *) buf;
+    if (ntohl(req->magic) != ROW_COMPARE_MAGIC) {
+        fprintf(stderr, "Wrong row compare magic: 0x%08x\n", ntohl(req->magic));
+        return 0;
+    }
+
+    uint32_t seq = ntohl(req->seq);
+    uint32_t nranges = ntohl(req->nranges);
+    uint32_t npattern = ntohl(req->npattern);
+    uint32_t max_mismatches = ntohl(req->max_mismatches);
+
+    size_t req_len = sizeof(struct row_compare_request)
+        + (size_t) nranges * sizeof(struct row_compare_range)
+        + (size_t) npattern * sizeof(uint32_t);
+    if (ntohs(req->version) != ROW_COMPARE_VERSION || npattern == 0 || req_len > recv_len) {
+        fprintf(stderr, "Malformed row compare request: version=%d, nranges=%u, npattern=%u, recv_len=%lu\n",
+                ntohs(req->version), nranges, npattern, recv_len);
+        return row_compare_error(buf, seq, ROW_COMPARE_BAD_REQUEST);
+    }
+
+    // the response is written to buf, so keep a copy of the request
+    uint8_t *req_copy = malloc(req_len);
+    if (req_copy == NULL) {
+        fprintf(stderr, "Could not allocate buffer for row compare request: len=%lu\n", req_len);
+        return -1;
+    }
+    memcpy(req_copy, buf, req_len);
+
+    struct row_compare_range *ranges = (struct row_compare_range *)
+        (req_copy + sizeof(struct row_compare_request));
+    uint32_t *pattern = (uint32_t *) (ranges + nranges);
+    for (uint32_t i = 0; i < npattern; ++i) {
+        pattern[i] = ntohl(pattern[i]);
+    }
+
+    size_t capacity = (buf_size - sizeof(struct row_compare_response)) / sizeof(struct row_compare_mismatch);
+    struct compare_state state = {
+        .out = (struct row_compare_mismatch *) (buf + sizeof(struct row_compare_response)),
+        .max_reported = max_mismatches < capacity ? max_mismatches : capacity,
+        .nreported = 0,
+        .nmismatches = 0,
+    };
+
+    uint16_t status = ROW_COMPARE_OK;
+    for (uint32_t i = 0; i < nranges; ++i) {
+        uint32_t addr = ntohl(ranges[i].addr);
+        uint32_t len = ntohl(ranges[i].len);
+        if (addr % 4 != 0 || len % 4 != 0 || (size_t) addr + len > pl_mem->len) {
+            fprintf(stderr, "Row compare range out of bounds: addr=0x%08x, len=0x%08x\n", addr, len);
+            status = ROW_COMPARE_BAD_RANGE;
+            break;
+        }
+        compare_range(&state, pl_mem, addr, len, pattern, npattern);
+    }
+
+    free(req_copy);
+
+    if (status != ROW_COMPARE_OK) {
+        return row_compare_error(buf, seq, status);
+    }
+
+    struct row_compare_response *resp = (struct row_compare_response *) buf;
+    resp->magic = htonl(ROW_COMPARE_MAGIC);
+    resp->version = htons(ROW_COMPARE_VERSION);
+    resp->status = htons(ROW_COMPARE_OK);
+    resp->seq = htonl(seq);
+    resp->nreported = htonl(state.nreported);
+    resp->nmismatches = htonl(state.nmismatches);
+    return sizeof(*resp) + state.nreported * sizeof(struct row_compare_mismatch);
+}
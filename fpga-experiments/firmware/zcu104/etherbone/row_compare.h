@@ -0,0 +1,70 @@
+#ifndef ROW_COMPARE_H
+#define ROW_COMPARE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pl_mmap.h"
+#include "debug.h"
+
+// Row compare service
+//
+// Compares ranges of the PL memory window against an expected pattern in place
+// and replies with the mismatching 32-bit words only, so that checking victim
+// rows does not require transferring whole rows to the host. Addresses are the
+// same as the ones used by the EtherBone server. All fields are in network byte
+// order.
+//
+// Request:  row_compare_request, nranges * row_compare_range, npattern * uint32_t
+// Response: row_compare_response, nreported * row_compare_mismatch
+//
+// The pattern is repeated from the start of every range, so npattern == 1 is a
+// 32-bit fill pattern and npattern == range length / 4 is a per-row pattern.
+// nmismatches counts all mismatching words, nreported only the ones that fit in
+// the response (bounded by max_mismatches and the server buffer size).
+
+#define ROW_COMPARE_MAGIC 0x52434d50  // "RCMP"
+#define ROW_COMPARE_VERSION 1
+
+enum row_compare_status {
+    ROW_COMPARE_OK = 0,
+    ROW_COMPARE_BAD_REQUEST = 1,
+    ROW_COMPARE_BAD_RANGE = 2,
+};
+
+struct row_compare_request {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t seq;
+    uint32_t nranges;
+    uint32_t npattern;
+    uint32_t max_mismatches;
+} __attribute__((packed));
+
+struct row_compare_range {
+    uint32_t addr;
+    uint32_t len;  // in bytes, multiple of 4
+} __attribute__((packed));
+
+struct row_compare_response {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t status;
+    uint32_t seq;
+    uint32_t nreported;
+    uint32_t nmismatches;
+} __attribute__((packed));
+
+struct row_compare_mismatch {
+    uint32_t addr;
+    uint32_t data;
+    uint32_t expected;
+} __attribute__((packed));
+
+int row_compare_callback(struct pl_mmap *pl_mem,
+        uint8_t *buf, size_t buf_size, size_t recv_len);
+
+#endif /* ROW_COMPARE_H */
@@ -26,6 +26,23 @@ class PatternMemory(Module):
         self.specials += self.data, self.addr
 
 
+class ErrorMapMemory(Module):
+    """
+    Memory for accumulating BISTReader errors per DRAM region
+
+    It consists of two separate memories of `depth` entries: `count` holds the
+    number of erroneous DMA transfers and `mask` the OR of the flipped bits
+    (data XOR expected) of all transfers mapped to the entry. Which transfers
+    map to which entry is configured in the Reader, typically one entry per row
+    or per chunk of columns.
+    """
+
+    def __init__(self, data_width, depth):
+        self.count = Memory(32, depth)
+        self.mask = Memory(data_width, depth)
+        self.specials += self.count, self.mask
+
+
 class AddressSelector(Module):
     # Selects addresses given two mask as done in:
     # https://github.com/google/hammer-kit/blob/40f3988cac39e20ed0294d20bc886e17376ef47b/hammer.c#L270
@@ -263,8 +280,9 @@ Pattern
 
 
 class Reader(BISTModule, AutoCSR, AutoDoc):
-    def __init__(self, dram_port, pattern_mem, *, rowbits, row_shift):
+    def __init__(self, dram_port, pattern_mem, *, rowbits, row_shift, error_map=None):
         super().__init__(pattern_mem)
+        self.error_map = error_map
 
         self.doc = ModuleDoc(
             f"""
@@ -293,6 +311,18 @@ The final number of errors can be read from `error_count`.
 NOTE: This value represents the number of erroneous *DMA transfers*.
 
 The current progress can be read from the `done` CSR.
+
+Error map
+---------
+
+If the module has been built with an `ErrorMapMemory`, setting
+`error_map_enable` accumulates the errors on-chip instead. The map is
+cleared on `start`. Each erroneous DMA transfer at DMA address `offset`
+updates entry `(offset - error_map_base) >> error_map_shift` of the map:
+its count is incremented and the flipped bits are ORed into its mask.
+Errors outside of the map are counted in `error_map_overflow`. Setting
+`skip_fifo` together with `error_map_enable` scans without stalling, and
+the map can be read back from memory after the transfer.
         """
         )
 
@@ -401,6 +431,52 @@ The current progress can be read from the `done` CSR.
             row_shift=row_shift,
         )
 
+        # ------------- Error map ----------------
+        self.error_map_enable = Signal()
+        self.error_map_base = Signal(32)
+        self.error_map_shift = Signal(5)
+        self.error_map_overflow = Signal(32)
+
+        after_error = If(self.skip_fifo, NextState("COMPUTE_MEM_ADDR")).Else(NextState("WR_ERR"))
+        after_start = NextState("COMPUTE_MEM_ADDR")
+
+        if error_map is not None:
+            map_depth = error_map.count.depth
+            map_count = error_map.count.get_port(write_capable=True, mode=READ_FIRST)
+            map_mask = error_map.mask.get_port(write_capable=True, mode=READ_FIRST)
+            self.specials += map_count, map_mask
+
+            map_adr = Signal(max=max(2, map_depth))
+            map_hit = Signal()
+            map_diff = Signal.like(dma.source.data)
+            map_offset = Signal(32)
+            map_entry = Signal(32)
+
+            self.comb += [
+                map_offset.eq(address_fifo.source.address - self.error_map_base),
+                map_entry.eq(map_offset >> self.error_map_shift),
+                map_count.adr.eq(map_adr),
+                map_mask.adr.eq(map_adr),
+            ]
+
+            error_to_map = [
+                NextValue(map_adr, map_entry),
+                NextValue(
+                    map_hit,
+                    (address_fifo.source.address >= self.error_map_base) & (map_entry < map_depth),
+                ),
+                NextValue(map_diff, dma.source.data ^ data_expected),
+            ]
+            after_error = If(
+                self.error_map_enable, *error_to_map, NextState("MAP_READ")
+            ).Else(after_error)
+            after_start = If(
+                self.error_map_enable,
+                NextValue(map_adr, 0),
+                NextValue(self.error_map_overflow, 0),
+                NextState("MAP_CLEAR"),
+            ).Else(after_start)
+
         self.submodules.fsm_pattern = fsm_pattern = FSM()
         fsm_pattern.act(
             "READY",
@@ -410,9 +486,43 @@ The current progress can be read from the `done` CSR.
                 NextValue(counter_gen, 0),
                 NextValue(data_mem_addr, 0),
                 NextValue(self.error_count, 0),
-                NextState("COMPUTE_MEM_ADDR"),
+                after_start,
             ),
         )
+        if error_map is not None:
+            fsm_pattern.act(
+                "MAP_CLEAR",
+                map_count.we.eq(1),
+                map_count.dat_w.eq(0),
+                map_mask.we.eq(1),
+                map_mask.dat_w.eq(0),
+                NextValue(map_adr, map_adr + 1),
+                If(map_adr == map_depth - 1, NextState("COMPUTE_MEM_ADDR")),
+            )
+            # Memory read takes a cycle, so the entry is updated in MAP_UPDATE
+            fsm_pattern.act(
+                "MAP_READ",
+                If(
+                    map_hit,
+                    NextState("MAP_UPDATE"),
+                ).Else(
+                    NextValue(self.error_map_overflow, self.error_map_overflow + 1),
+                    If(self.skip_fifo, NextState("COMPUTE_MEM_ADDR")).Else(NextState("WR_ERR")),
+                ),
+            )
+            fsm_pattern.act(
+                "MAP_UPDATE",
+                map_count.we.eq(1),
+                If(
+                    map_count.dat_r == 0xFFFFFFFF,
+                    map_count.dat_w.eq(map_count.dat_r),
+                ).Else(
+                    map_count.dat_w.eq(map_count.dat_r + 1),
+                ),
+                map_mask.we.eq(1),
+                map_mask.dat_w.eq(map_mask.dat_r | map_diff),
+                If(self.skip_fifo, NextState("COMPUTE_MEM_ADDR")).Else(NextState("WR_ERR")),
+            )
         fsm_pattern.act(
             "COMPUTE_MEM_ADDR",
             If(
@@ -452,7 +562,7 @@ The current progress can be read from the `done` CSR.
                     NextValue(error_fifo.sink.offset, address_fifo.source.address),
                     NextValue(error_fifo.sink.data, dma.source.data),
                     NextValue(error_fifo.sink.expected, data_expected),
-                    If(self.skip_fifo, NextState("COMPUTE_MEM_ADDR")).Else(NextState("WR_ERR")),
+                    after_error,
                 ).Else(NextState("COMPUTE_MEM_ADDR")),
             ),
         )
@@ -541,3 +651,26 @@ The current progress can be read from the `done` CSR.
             self.error.ready.eq(self._error_continue.re),
             self._error_ready.status.eq(self.error.valid),
         ]
+
+        if self.error_map is not None:
+            self._error_map_enable = CSRStorage(
+                description="Accumulate errors in the error map instead of only the FIFO"
+            )
+            self._error_map_base = CSRStorage(
+                size=len(self.error_map_base), description="DMA address of the first map entry"
+            )
+            self._error_map_shift = CSRStorage(
+                size=len(self.error_map_shift),
+                description="log2 of the number of DMA transfers per map entry",
+            )
+            self._error_map_overflow = CSRStatus(
+                size=len(self.error_map_overflow),
+                description="Number of errors outside of the error map",
+            )
+
+            self.comb += [
+                self.error_map_enable.eq(self._error_map_enable.storage),
+                self.error_map_base.eq(self._error_map_base.storage),
+                self.error_map_shift.eq(self._error_map_shift.storage),
+                self._error_map_overflow.status.eq(self.error_map_overflow),
+            ]
@@ -249,6 +249,77 @@ class Encoder:
             ret.extend(self.encode_spec(i))
         return ret
 
+    def encode_arrays(
+        self, op_code, timeslice=0, *, bank=0, row=0, col=0, rank=0, count=0, jump=0
+    ):
+        """Struct-of-arrays counterpart of `encode_payload`
+
+        Every field is a numpy array (or scalar) with one entry per instruction.
+        ACT takes its address from `row`, other DFI commands from `col`; LOOP
+        uses `count` and `jump`. Returns the payload words as a uint32 array,
+        bit for bit equal to encoding the equivalent list of `Instruction`,
+        including the NOOPs that extend DFI timeslices above the field width.
+        """
+        import numpy as np
+
+        op = np.asarray(op_code, dtype=np.int64)
+        n = len(op)
+
+        def field(values):
+            return np.broadcast_to(np.asarray(values, dtype=np.int64), (n,))
+
+        ts, bank, row, col, rank, count, jump = map(
+            field, (timeslice, bank, row, col, rank, count, jump)
+        )
+        is_noop = op == OpCode.NOOP
+        is_loop = op == OpCode.LOOP
+        is_dfi = ~(is_noop | is_loop)
+        assert np.all(
+            count[is_loop] < 2**Decoder.LOOP_COUNT
+        ), f"LOOP count value exceeded max value:{2**Decoder.LOOP_COUNT - 1}"
+        assert np.all(
+            ts[is_noop] < 2**Decoder.TIMESLICE_NOOP
+        ), f"Timeslice value exceeded max value:{2**Decoder.TIMESLICE_NOOP - 1}"
+        assert np.all(ts[is_dfi] != 0), "Timeslice for instructions other than NOOP should be > 0"
+
+        def pack(*parts):
+            word = np.zeros_like(parts[0][1])
+            shift = 0
+            for width, val in parts:
+                word |= (val & (2**width - 1)) << shift
+                shift += width
+            return word
+
+        rowcol = np.where(op == OpCode.ACT, row, col)
+        address = (bank & (2**self.bankbits - 1)) | (rowcol << self.bankbits)
+        if self.nranks > 1:
+            address = (address << log2_int(self.nranks)) | rank
+        base_ts = np.maximum(ts & (2**Decoder.TIMESLICE - 1), 1)
+        words = np.select(
+            [is_noop, is_loop],
+            [
+                pack((Decoder.OP_CODE, op), (Decoder.TIMESLICE_NOOP, ts)),
+                pack((Decoder.OP_CODE, op), (Decoder.LOOP_COUNT, count), (Decoder.LOOP_JUMP, jump)),
+            ],
+            pack((Decoder.OP_CODE, op), (Decoder.TIMESLICE, base_ts), (Decoder.ADDRESS, address)),
+        )
+
+        # Same split of the remaining timeslice into NOOPs as in `Instruction`
+        noop_step = Decoder.TIMESLICE_NOOP - 1
+        remaining = np.where(is_dfi, ts - base_ts, 0)
+        extra = -(-remaining // noop_step)
+        first_extra = np.cumsum(extra) - extra
+        position = np.arange(n) + first_extra
+        out = np.empty(n + int(extra.sum()), dtype=np.uint32)
+        out[position] = words
+        owner = np.repeat(np.arange(n), extra)
+        nth = np.arange(len(owner)) - first_extra[owner]
+        wait = np.minimum(remaining[owner] - nth * noop_step, noop_step)
+        out[position[owner] + 1 + nth] = pack(
+            (Decoder.OP_CODE, np.full_like(wait, OpCode.NOOP)), (Decoder.TIMESLICE_NOOP, wait)
+        )
+        return out
+
     def address(self, *, rank=None, bank=0, row=None, col=None):
         assert not (row is not None and col is not None)
         if row is not None:
@@ -522,6 +593,11 @@ class PayloadExecutor(Module, AutoCSR, AutoDoc):
             f"""
         Executes the DRAM payload from memory
 
+        `mem_payload` may be a list of memories of equal size (payload banks).
+        The bank to execute is selected with the `bank` register and latched
+        when execution starts, so the host can upload the next payload into
+        an idle bank while the current one executes.
+
         {Decoder.__doc__}
         """
         )
@@ -553,13 +629,26 @@ class PayloadExecutor(Module, AutoCSR, AutoDoc):
 
         # Fetcher
         # uses synchronous port, mem_data is ready 1 cycle after mem_addr is asserted
-        assert (
-            mem_payload.width == Decoder.INSTRUCTION
-        ), f"Wrong payload memory word width: {mem_payload.width} vs {Decoder.INSTRUCTION}"
+        if isinstance(mem_payload, (list, tuple)):
+            mems_payload = list(mem_payload)
+        else:
+            mems_payload = [mem_payload]
+        for mem in mems_payload:
+            assert (
+                mem.width == Decoder.INSTRUCTION
+            ), f"Wrong payload memory word width: {mem.width} vs {Decoder.INSTRUCTION}"
+            assert (
+                mem.depth == mems_payload[0].depth
+            ), f"Payload banks differ in depth: {mem.depth} vs {mems_payload[0].depth}"
+        self.nbanks = len(mems_payload)
+
+        # Bank for the next execution and the bank being executed
+        self.bank = Signal(max=max(self.nbanks, 2))
+        self.active_bank = Signal.like(self.bank)
 
         self.instruction = Signal(Decoder.INSTRUCTION)
 
-        self.mem_addr = Signal(max=mem_payload.depth)
+        self.mem_addr = Signal(max=mems_payload[0].depth)
         self.mem_data = Signal.like(self.instruction)
         self.stall = Signal()
         self.bubble = Signal()  # Helper signal for tests, doesn't get used in logic
@@ -570,12 +659,15 @@ class PayloadExecutor(Module, AutoCSR, AutoDoc):
             self.mem_addr, self.stall, self.jump, self.jump_offset, self.PIPELINE_DELAY
         )
 
-        payload_port = mem_payload.get_port(write_capable=False)
-        self.specials += payload_port
-        self.comb += [
-            payload_port.adr.eq(self.mem_addr),
-            self.mem_data.eq(payload_port.dat_r),
-        ]
+        # active_bank only changes while the executor is READY, all ports read
+        # the same address so the selected data is valid right after a switch
+        for i, mem in enumerate(mems_payload):
+            payload_port = mem.get_port(write_capable=False)
+            self.specials += payload_port
+            self.comb += [
+                payload_port.adr.eq(self.mem_addr),
+                If(self.active_bank == i, self.mem_data.eq(payload_port.dat_r)),
+            ]
 
         self.sync += [If(~self.stall, self.instruction.eq(self.mem_data))]
 
@@ -601,6 +693,7 @@ class PayloadExecutor(Module, AutoCSR, AutoDoc):
             If(
                 self.start,
                 NextValue(dfi_switch.wants_dfi, 1),
+                NextValue(self.active_bank, self.bank),
                 NextState("WAIT-DFI"),
             ),
         )
@@ -717,6 +810,22 @@ class PayloadExecutor(Module, AutoCSR, AutoDoc):
             description="Number of cycles elapsed until the end of the payload execution.",
         )
 
+        if self.nbanks > 1:
+            self._bank = CSRStorage(
+                len(self.bank),
+                reset=0,
+                description="Payload memory bank to execute on the next `start`."
+                " Latched at `start`, so the other banks can be rewritten during execution.",
+            )
+            self._active_bank = CSRStatus(
+                len(self.active_bank),
+                description="Payload memory bank of the current or last execution",
+            )
+            self.comb += [
+                self.bank.eq(self._bank.storage),
+                self._active_bank.status.eq(self.active_bank),
+            ]
+
         self.comb += [
             self.start.eq(self._start.re),
             self._status.fields.ready.eq(self.ready),
@@ -0,0 +1,238 @@
+"""
+Batched CSR access through litex_server.
+
+`RemoteClient.read()` costs a full network round-trip per register. CSRBatch
+queues reads and writes into multi-access etherbone records, keeps several
+records on the wire and returns reads as CSRFuture objects that resolve once
+the response arrives.
+
+litex_server handles one record per packet and only answers records with
+reads. Its framing cannot handle records mixing writes and reads, so
+consecutive accesses are packed into either a write burst (consecutive
+addresses) or a list of up to 255 reads, in program order. Write records are
+posted without waiting, so a sequence like "write update register, read
+counter" costs a single round-trip, and the board sees the accesses in
+exactly the order they were issued.
+
+While a batch has reads in flight, the underlying client must not be used
+directly, as its responses would be interleaved with the batch's; call
+flush() first. Example:
+
+    with CSRBatch(wb) as batch:
+        batch.regs.dfi_switch_refresh_update.write(1)
+        count = batch.regs.dfi_switch_refresh_count.read()
+    print(count.result())
+"""
+
+import collections
+from dataclasses import dataclass
+from typing import Callable, List, Optional
+
+from litex.tools.remote.csr_builder import CSRElements
+from litex.tools.remote.etherbone import (
+    EtherbonePacket,
+    EtherboneReads,
+    EtherboneRecord,
+    EtherboneWrites,
+)
+
+# Writes and reads per record are limited by the 8-bit wcount/rcount fields
+MAX_RECORD_ACCESSES = 255
+
+
+class CSRBatchError(RuntimeError):
+    pass
+
+
+class CSRFuture:
+    def __init__(self, batch: "CSRBatch", combine: Callable[[List[int]], int]):
+        self._batch = batch
+        self._combine = combine
+        self._done = False
+        self._value = None
+
+    def done(self) -> bool:
+        return self._done
+
+    def result(self) -> int:
+        if not self._done:
+            self._batch._wait(self)
+        return self._value
+
+    def _set(self, datas: List[int]):
+        self._value = self._combine(datas)
+        self._done = True
+
+
+class BatchedCSRRegister:
+    """Same interface as litex CSRRegister, but read() returns a CSRFuture."""
+
+    def __init__(self, batch: "CSRBatch", reg):
+        self._batch = batch
+        self.name = reg.name
+        self.addr = reg.addr
+        self.length = reg.length
+        self.data_width = reg.data_width
+        self.mode = reg.mode
+
+    def read(self) -> CSRFuture:
+        if self.mode not in ["rw", "ro"]:
+            raise KeyError(self.name + " register not readable")
+
+        def combine(datas):
+            data = 0
+            for d in datas:
+                data = (data << self.data_width) | d
+            return data
+
+        return self._batch.read(self.addr, length=self.length, combine=combine)
+
+    def write(self, value: int):
+        if self.mode not in ["rw", "wo"]:
+            raise KeyError(self.name + " register not writable")
+        mask = 2**self.data_width - 1
+        datas = [
+            (value >> ((self.length - 1 - i) * self.data_width)) & mask for i in range(self.length)
+        ]
+        self._batch.write(self.addr, datas)
+
+
+@dataclass
+class CSRBatchStats:
+    packets: int = 0
+    responses: int = 0
+    reads: int = 0
+    writes: int = 0
+    # Largest number of records awaiting a response at the same time
+    peak_inflight: int = 0
+
+
+class CSRBatch:
+    def __init__(self, client, max_inflight: int = 4):
+        if max_inflight < 1:
+            raise ValueError("max_inflight must be at least 1")
+        # Accept the RemoteClientWrapper from utils.py as well as a plain RemoteClient
+        self.client = getattr(client, "client", client)
+        self.max_inflight = max_inflight
+        self.stats = CSRBatchStats()
+
+        if hasattr(self.client, "regs"):
+            self.regs = CSRElements(
+                {name: BatchedCSRRegister(self, reg) for name, reg in self.client.regs.d.items()}
+            )
+
+        self._write_base = 0
+        self._write_datas = []
+        self._read_addrs = []
+        self._read_futures = []
+        # One list of (future, nwords) per sent record that expects a response
+        self._inflight = collections.deque()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        if exc_type is None:
+            self.flush()
+
+    def write(self, addr: int, datas):
+        datas = datas if isinstance(datas, list) else [datas]
+        addr += self.client.base_address
+        for i, data in enumerate(datas):
+            a = addr + 4 * i
+            if self._read_addrs or (
+                self._write_datas
+                and (
+                    a != self._write_base + 4 * len(self._write_datas)
+                    or len(self._write_datas) == MAX_RECORD_ACCESSES
+                )
+            ):
+                self.submit()
+            if not self._write_datas:
+                self._write_base = a
+            self._write_datas.append(data)
+        self.stats.writes += len(datas)
+
+    def read(
+        self,
+        addr: int,
+        length: Optional[int] = None,
+        combine: Optional[Callable[[List[int]], int]] = None,
+    ) -> CSRFuture:
+        """
+        Queues a read of `length` consecutive words (one if None). The future
+        resolves to `combine(words)`, by default the word itself or the list
+        of words if `length` was given.
+        """
+        nwords = 1 if length is None else length
+        if nwords > MAX_RECORD_ACCESSES:
+            raise ValueError(f"Read of {nwords} words exceeds {MAX_RECORD_ACCESSES}")
+        if combine is None:
+            combine = (lambda datas: datas[0]) if length is None else list
+
+        if self._write_datas or len(self._read_addrs) + nwords > MAX_RECORD_ACCESSES:
+            self.submit()
+        addr += self.client.base_address
+        self._read_addrs.extend(addr + 4 * j for j in range(nwords))
+        future = CSRFuture(self, combine)
+        self._read_futures.append((future, nwords))
+        self.stats.reads += nwords
+        return future
+
+    def submit(self):
+        """Sends the record being built without waiting for its response."""
+        if not self._write_datas and not self._read_addrs:
+            return
+
+        record = EtherboneRecord()
+        if self._write_datas:
+            record.writes = EtherboneWrites(base_addr=self._write_base, datas=self._write_datas)
+        else:
+            record.reads = EtherboneReads(addrs=self._read_addrs)
+        packet = EtherbonePacket()
+        packet.records = [record]
+        packet.encode()
+        self.client.send_packet(self.client.socket, packet)
+        self.stats.packets += 1
+
+        if self._read_futures:
+            self._inflight.append(self._read_futures)
+            self.stats.peak_inflight = max(self.stats.peak_inflight, len(self._inflight))
+
+        self._write_datas = []
+        self._read_addrs = []
+        self._read_futures = []
+
+        while len(self._inflight) > self.max_inflight:
+            self._receive()
+
+    def flush(self):
+        """Sends all queued accesses and waits for all outstanding reads."""
+        self.submit()
+        while self._inflight:
+            self._receive()
+
+    def _wait(self, future: CSRFuture):
+        self.submit()
+        while not future.done():
+            if not self._inflight:
+                raise CSRBatchError("Future does not belong to a pending read of this batch")
+            self._receive()
+
+    def _receive(self):
+        response = self.client.receive_packet(self.client.socket)
+        if response == 0:
+            raise CSRBatchError("Connection to litex_server closed")
+        packet = EtherbonePacket(response)
+        packet.decode()
+        datas = packet.records.pop().writes.get_datas()
+        self.stats.responses += 1
+
+        futures = self._inflight.popleft()
+        expected = sum(nwords for _, nwords in futures)
+        if len(datas) != expected:
+            raise CSRBatchError(f"Expected {expected} words in response, got {len(datas)}")
+        offset = 0
+        for future, nwords in futures:
+            future._set(datas[offset : offset + nwords])
+            offset += nwords
@@ -0,0 +1,171 @@
+"""
+Client for the row compare service of the ZCU104 EtherBone firmware
+(firmware/zcu104/etherbone/row_compare.c).
+
+The service compares memory ranges against an expected pattern on the board
+and only sends back the mismatching 32-bit words, instead of transferring whole
+rows to the host.
+"""
+
+import socket
+import struct
+from dataclasses import dataclass
+from typing import List, Sequence, Tuple
+
+ROW_COMPARE_MAGIC = 0x52434D50  # "RCMP"
+ROW_COMPARE_VERSION = 1
+ROW_COMPARE_PORT = 1235
+
+STATUS_OK = 0
+STATUS_BAD_REQUEST = 1
+STATUS_BAD_RANGE = 2
+
+_REQUEST = struct.Struct("!IHHIIII")
+_RANGE = struct.Struct("!II")
+_RESPONSE = struct.Struct("!IHHIII")
+_MISMATCH = struct.Struct("!III")
+
+# Largest UDP payload over IPv4
+MAX_DATAGRAM = 65507
+
+
+class RowCompareError(RuntimeError):
+    pass
+
+
+@dataclass(frozen=True)
+class RowMismatch:
+    address: int
+    data: int
+    expected: int
+
+    def __repr__(self):
+        return f"RowMismatch(address={hex(self.address)}, data={hex(self.data)}, expected={hex(self.expected)})"
+
+
+@dataclass
+class RowCompareResult:
+    mismatches: List[RowMismatch]
+    # Number of mismatching words, including the ones that were not reported
+    total: int
+
+    @property
+    def truncated(self) -> bool:
+        return self.total > len(self.mismatches)
+
+
+def encode_request(
+    seq: int, ranges: Sequence[Tuple[int, int]], pattern: Sequence[int], max_mismatches: int
+) -> bytes:
+    parts = [
+        _REQUEST.pack(
+            ROW_COMPARE_MAGIC,
+            ROW_COMPARE_VERSION,
+            0,
+            seq,
+            len(ranges),
+            len(pattern),
+            max_mismatches,
+        )
+    ]
+    parts.extend(_RANGE.pack(addr, length) for addr, length in ranges)
+    parts.append(struct.pack(f"!{len(pattern)}I", *(p & 0xFFFFFFFF for p in pattern)))
+    return b"".join(parts)
+
+
+def decode_response(packet: bytes) -> Tuple[int, int, RowCompareResult]:
+    """Returns (seq, status, result)."""
+    if len(packet) < _RESPONSE.size:
+        raise RowCompareError(f"Row compare response too short: {len(packet)} bytes")
+    magic, version, status, seq, nreported, total = _RESPONSE.unpack_from(packet)
+    if magic != ROW_COMPARE_MAGIC or version != ROW_COMPARE_VERSION:
+        raise RowCompareError(f"Unexpected row compare response: magic={magic:#x}, version={version}")
+
+    expected_len = _RESPONSE.size + nreported * _MISMATCH.size
+    if status == STATUS_OK and len(packet) < expected_len:
+        raise RowCompareError(f"Truncated row compare response: {len(packet)} < {expected_len} bytes")
+
+    mismatches = []
+    if status == STATUS_OK:
+        for i in range(nreported):
+            addr, data, expected = _MISMATCH.unpack_from(packet, _RESPONSE.size + i * _MISMATCH.size)
+            mismatches.append(RowMismatch(address=addr, data=data, expected=expected))
+    return seq, status, RowCompareResult(mismatches=mismatches, total=total)
+
+
+class RowCompareClient:
+    def __init__(
+        self,
+        host: str,
+        port: int = ROW_COMPARE_PORT,
+        timeout: float = 5.0,
+        max_mismatches: int = 4096,
+        max_request_size: int = MAX_DATAGRAM,
+    ):
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+        self.max_mismatches = max_mismatches
+        self.max_request_size = max_request_size
+        self.socket = None
+        self._seq = 0
+
+    def open(self):
+        if self.socket is None:
+            self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self.socket.settimeout(self.timeout)
+
+    def close(self):
+        if self.socket is not None:
+            self.socket.close()
+            self.socket = None
+
+    def __enter__(self):
+        self.open()
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.close()
+
+    def compare(self, ranges: Sequence[Tuple[int, int]], pattern: Sequence[int]) -> RowCompareResult:
+        """
+        Compare every (address, length) range against `pattern`, which is repeated
+        from the start of each range. Ranges are split into as few requests as fit
+        in a datagram.
+        """
+        if not pattern:
+            raise ValueError("Row compare pattern must not be empty")
+
+        fixed = _REQUEST.size + 4 * len(pattern)
+        per_request = (self.max_request_size - fixed) // _RANGE.size
+        if per_request <= 0:
+            raise ValueError(f"Row compare pattern too long: {len(pattern)} words")
+
+        self.open()
+        result = RowCompareResult(mismatches=[], total=0)
+        for i in range(0, len(ranges), per_request):
+            part = self._request(ranges[i : i + per_request], pattern)
+            result.mismatches.extend(part.mismatches)
+            result.total += part.total
+        return result
+
+    def _request(self, ranges: Sequence[Tuple[int, int]], pattern: Sequence[int]) -> RowCompareResult:
+        self._seq = (self._seq + 1) & 0xFFFFFFFF
+        request = encode_request(self._seq, ranges, pattern, self.max_mismatches)
+        self.socket.sendto(request, (self.host, self.port))
+
+        while True:
+            try:
+                packet = self.socket.recv(MAX_DATAGRAM)
+            except socket.timeout:
+                raise RowCompareError(
+                    f"No row compare response from {self.host}:{self.port}"
+                ) from None
+            seq, status, result = decode_response(packet)
+            if seq == self._seq:
+                break
+            # Late reply to an earlier request, skip it
+
+        if status != STATUS_OK:
+            raise RowCompareError(f"Row compare request rejected: status={status}")
+        return result
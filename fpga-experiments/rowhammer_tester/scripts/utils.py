@@ -9,12 +9,13 @@ import time
 from dataclasses import dataclass
 from functools import reduce
 from operator import or_
-from typing import List, Tuple
+from typing import Callable, List, Optional, Tuple
 
 from litex.soc.cores.i2c_worker import I2CQueueEntry, I2CState
 from migen import log2_int
 
 from rowhammer_tester.gateware.payload_executor import OpCode
+from rowhammer_tester.scripts.csr_batch import CSRBatch
 
 # ###########################################################################
 
@@ -105,6 +106,10 @@ def RemoteClient(*args, **kwargs):
             # Forward attribute access to the underlying client object
             return getattr(self.client, name)
 
+        def batch(self, max_inflight=4):
+            # Queue accesses into etherbone records instead of one round-trip per read
+            return CSRBatch(self.client, max_inflight=max_inflight)
+
     return RemoteClientWrapper(*args, **kwargs)
 
 
@@ -501,16 +506,26 @@ def hw_memtest(wb, offset, size, patterns, dbg=False, print_progress=True) -> Li
 
     # Read unmatched offset
     def append_errors(wb, err):
-        while wb.regs.reader_error_ready.read():
+        # Error details are read together with error_ready (they are ignored if it is not set)
+        # and error_continue is sent with the next reads, so each error costs one round-trip
+        batch = CSRBatch(wb)
+        while True:
+            ready = batch.regs.reader_error_ready.read()
+            offset = batch.regs.reader_error_offset.read()
+            data = batch.regs.reader_error_data.read()
+            expected = batch.regs.reader_error_expected.read()
+            if not ready.result():
+                break
             err.append(
                 BISTError(
-                    offset=wb.regs.reader_error_offset.read(),
-                    data=wb.regs.reader_error_data.read(),
-                    expected=wb.regs.reader_error_expected.read(),
+                    offset=offset.result(),
+                    data=data.result(),
+                    expected=expected.result(),
                     dma_data_bytes=dma_data_bytes
                 ))
-            wb.regs.reader_error_continue.write(1)
+            batch.regs.reader_error_continue.write(1)
             progress()
+        batch.flush()
 
     # FIXME: Support progress
     while True:
@@ -595,6 +610,103 @@ def hw_memtest_count(wb, offset, size, patterns, dbg=False) -> int:
 
     return count
 
+@dataclass
+class BISTErrorMapEntry:
+    # Byte offset of the first DMA transfer of the entry
+    offset: int
+    # Number of erroneous DMA transfers
+    count: int
+    # OR of the flipped bits of all erroneous DMA transfers
+    mask: int
+    dma_data_bytes: int
+
+    def __repr__(self):
+        return f"BISTErrorMapEntry(offset={self.offset}, count={self.count}, mask={hex(self.mask)})"
+
+
+def hw_memtest_error_map(
+    wb, offset, size, patterns, transfers_per_entry, dbg=False
+) -> Tuple[List[BISTErrorMapEntry], int]:
+    """
+    Like hw_memtest, but errors are accumulated on the FPGA in the Reader error map, one entry per
+    `transfers_per_entry` DMA transfers (e.g. one DRAM row). Returns the entries with errors and
+    the number of errors that did not fit in the map.
+    """
+    settings = get_litedram_settings()
+    dma_data_width = settings.phy.dfi_databits * settings.phy.nphases
+    dma_data_bytes = dma_data_width // 8
+
+    assert size % dma_data_bytes == 0, f"DMA data width is {dma_data_width} bits"
+    assert len(patterns) == 1  # FIXME: Support more patterns
+    assert transfers_per_entry & (transfers_per_entry - 1) == 0, "Must be power of 2"
+    assert hasattr(wb.regs, "reader_error_map_enable"), "Target built without BIST error map"
+
+    pattern = patterns[0] & 0xFFFFFFFF
+    depth = wb.mems.reader_error_map_count.size // 4
+    entry_bytes = transfers_per_entry * dma_data_bytes
+
+    if dbg:
+        print(
+            f"hw_memtest_error_map: offset: 0x{offset:08x}, size: 0x{size:08x},"
+            f" pattern: 0x{pattern:08x}, entries: {size // entry_bytes}/{depth}"
+        )
+
+    # Disable error FIFO, errors only go to the map; restored once the scan is done
+    skip_fifo = wb.regs.reader_skip_fifo.read()
+    wb.regs.reader_skip_fifo.write(1)
+    time.sleep(0.001)
+
+    assert wb.regs.reader_ready.read() == 1
+
+    wb.regs.reader_mem_mask.write(0xFFFFFFFF)
+    wb.write(wb.mems.reader_pattern_data.base, [pattern] * (dma_data_bytes // 4))
+    wb.write(wb.mems.reader_pattern_addr.base, offset // dma_data_bytes)
+    wb.regs.reader_data_mask.write(0x00000000)
+
+    wb.regs.reader_error_map_enable.write(1)
+    wb.regs.reader_error_map_base.write(offset // dma_data_bytes)
+    wb.regs.reader_error_map_shift.write(log2_int(transfers_per_entry))
+
+    wb.regs.reader_count.write(size // dma_data_bytes)
+    wb.regs.reader_start.write(1)
+
+    while not wb.regs.reader_ready.read():
+        time.sleep(10e-3)
+
+    overflow = wb.regs.reader_error_map_overflow.read()
+    wb.regs.reader_error_map_enable.write(0)
+    wb.regs.reader_skip_fifo.write(skip_fifo)
+
+    counts = memread(wb, depth, base=wb.mems.reader_error_map_count.base)
+    mask_words = dma_data_bytes // 4
+    with CSRBatch(wb) as batch:
+        masks = {
+            entry: batch.read(
+                wb.mems.reader_error_map_mask.base + entry * dma_data_bytes, length=mask_words
+            )
+            for entry, count in enumerate(counts)
+            if count
+        }
+
+    entries = []
+    for entry, words in masks.items():
+        # Lower addresses hold the less significant words of wide memories
+        mask = sum(word << (32 * i) for i, word in enumerate(words.result()))
+        entries.append(
+            BISTErrorMapEntry(
+                offset=offset + entry * entry_bytes,
+                count=counts[entry],
+                mask=mask,
+                dma_data_bytes=dma_data_bytes,
+            )
+        )
+
+    if dbg:
+        print(f"hw_memtest_error_map: entries with errors: {len(entries)}, overflow: {overflow}")
+
+    return entries, overflow
+
+
 # Inversion_tuple has two elements: divisor and mask
 def setup_inverters(wb, divisor, mask):
     assert (divisor & (divisor - 1)) == 0, "Divisor must be power of 2"
@@ -620,10 +732,30 @@ def get_expected_execution_cycles(payload):
     return cycles
 
 
-def execute_payload(payload: List[int], wb, verbose: bool = False):
-    if verbose:
-        print('\nTransferring the payload ...')
-    memwrite(wb, payload, base=wb.mems.payload.base)
+def payload_bank_base(wb, bank: int) -> int:
+    return getattr(wb.mems, "payload" + (str(bank) if bank else "")).base
+
+
+def execute_payload(
+    payload: Optional[List[int]],
+    wb,
+    verbose: bool = False,
+    *,
+    bank: Optional[int] = None,
+    while_running: Optional[Callable[[], None]] = None,
+):
+    """Upload `payload` (None if the bank already holds it) and execute it.
+
+    `bank` selects the payload memory on SoCs built with `--payload-banks 2`;
+    `while_running` is called once the executor has started, e.g. to upload
+    the next payload into the idle bank.
+    """
+    if payload is not None:
+        if verbose:
+            print('\nTransferring the payload ...')
+        memwrite(wb, payload, base=payload_bank_base(wb, bank or 0))
+    if bank is not None:
+        wb.regs.payload_executor_bank.write(bank)
 
     def ready():
         status = wb.regs.payload_executor_status.read()
@@ -636,11 +768,14 @@ def execute_payload(payload: List[int], wb, verbose: bool = False):
     )
 
     def check_refresh_at(force=False):
-        at = wb.regs.dfi_switch_at_refresh.read()
+        # Single round-trip for at_refresh and the latched refresh count
+        with CSRBatch(wb) as batch:
+            at = batch.regs.dfi_switch_at_refresh.read()
+            batch.regs.dfi_switch_refresh_update.write(1)
+            now = batch.regs.dfi_switch_refresh_count.read()
+        at, now = at.result(), now.result()
         # if at_refresh is not zero, then dfi switch will be blocked until refresh count is reached
         if at != 0:
-            wb.regs.dfi_switch_refresh_update.write(1)
-            now = wb.regs.dfi_switch_refresh_count.read()
             if force or at >= now:
                 print(f"\rWaiting for refresh, remaining {at - now:10} ...", end=" ")
             if at < now:
@@ -654,6 +789,8 @@ def execute_payload(payload: List[int], wb, verbose: bool = False):
     start = time.time()
     start_transition = None
     wb.regs.payload_executor_start.write(1)
+    if while_running is not None:
+        while_running()
 
     transitioned = False
     first = True
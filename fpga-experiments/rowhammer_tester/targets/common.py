@@ -34,7 +34,7 @@ from litex.tools.litex_sim import get_sdram_phy_settings
 from migen import READ_FIRST, Constant, Memory, Module, Signal
 
 import rowhammer_tester.targets.modules as local_modules
-from rowhammer_tester.gateware.bist import PatternMemory, Reader, Writer
+from rowhammer_tester.gateware.bist import ErrorMapMemory, PatternMemory, Reader, Writer
 from rowhammer_tester.gateware.payload_executor import DFISwitch, PayloadExecutor, SyncableRefresher
 from rowhammer_tester.gateware.rowhammer import RowHammerDMA
 from rowhammer_tester.gateware.sram import SRAM
@@ -376,10 +376,34 @@ class RowHammerSoC(SoCCore):
             self.writer.add_csrs()
             self.add_csr("writer")
 
+            # Reader error map
+            error_map_depth = int(self.args.bist_error_map_depth, 0)
+            reader_error_map = None
+            if error_map_depth > 0:
+                self.submodules.reader_error_map = reader_error_map = ErrorMapMemory(
+                    data_width=pattern_data_width, depth=error_map_depth
+                )
+                self.add_memory(
+                    reader_error_map.count, name="reader_error_map_count", origin=0x24000000
+                )
+                self.add_memory(
+                    reader_error_map.mask, name="reader_error_map_mask", origin=0x25000000
+                )
+                self.logger.info(
+                    "{}: Length: {}, Data Width: {}-bit".format(
+                        colorer("Reader BIST error map"),
+                        colorer(error_map_depth),
+                        colorer(pattern_data_width),
+                    )
+                )
+
             # Reader
             dram_rd_port = self.sdram.crossbar.get_port()
             self.submodules.reader = Reader(
-                dram_rd_port, self.reader_pattern_mem, **inversion_kwargs
+                dram_rd_port,
+                self.reader_pattern_mem,
+                error_map=reader_error_map,
+                **inversion_kwargs,
             )
             self.reader.add_csrs()
             self.add_csr("reader")
@@ -394,22 +418,35 @@ class RowHammerSoC(SoCCore):
 
             scratchpad_width = phy_settings.dfi_databits * phy_settings.nphases
             payload_size = int(args.payload_size, 0)
+            payload_banks = int(args.payload_banks, 0)
             scratchpad_size = int(args.scratchpad_size, 0)
             assert payload_size % 4 == 0, "Payload memory size must be multiple of 4 bytes"
+            assert payload_banks in (1, 2), "Payload memory supports 1 or 2 banks"
+            assert payload_banks == 1 or payload_size <= 0x800000, "Payload bank exceeds 8 MiB"
             assert (
                 scratchpad_size % (scratchpad_width // 8) == 0
             ), f"Scratchpad memory size must be multiple of {scratchpad_width // 8} bytes"
 
             scratchpad_depth = scratchpad_size // (scratchpad_width // 8)
-            payload_mem = Memory(32, payload_size // 4)
+            payload_mems = [Memory(32, payload_size // 4) for _ in range(payload_banks)]
             scratchpad_mem = Memory(scratchpad_width, scratchpad_depth)
-            self.specials += payload_mem, scratchpad_mem
-
-            self.add_memory(payload_mem, name="payload", origin=0x30000000, sram_type=SRAM)
+            self.specials += *payload_mems, scratchpad_mem
+
+            # Second bank is filled by the host while the first one executes
+            for i, payload_mem in enumerate(payload_mems):
+                self.add_memory(
+                    payload_mem,
+                    name="payload" + (str(i) if i else ""),
+                    origin=0x30000000 + i * 0x800000,
+                    sram_type=SRAM,
+                )
             self.add_memory(scratchpad_mem, name="scratchpad", origin=0x31000000)
             self.logger.info(
-                "{}: Length: {}, Data Width: {}-bit".format(
-                    colorer("Instruction payload"), colorer(payload_size // 4), colorer(32)
+                "{}: Length: {}, Data Width: {}-bit, Banks: {}".format(
+                    colorer("Instruction payload"),
+                    colorer(payload_size // 4),
+                    colorer(32),
+                    colorer(payload_banks),
                 )
             )
             self.logger.info(
@@ -430,7 +467,7 @@ class RowHammerSoC(SoCCore):
             self.add_csr("dfi_switch")
 
             self.submodules.payload_executor = PayloadExecutor(
-                mem_payload=payload_mem,
+                mem_payload=payload_mems if payload_banks > 1 else payload_mems[0],
                 mem_scratchpad=scratchpad_mem,
                 dfi_switch=self.dfi_switch,
                 nranks=self.sdram.controller.settings.phy.nranks,
@@ -579,6 +616,12 @@ class ArgumentParser(argparse.ArgumentParser):
             g, "--no-payload-executor", action="store_true", help="Disable Payload Executor module"
         )
         self.add(g, "--payload-size", default="32768", help="Payload memory size in bytes")
+        self.add(
+            g,
+            "--payload-banks",
+            default="1",
+            help="Payload memory banks; with 2 the next payload uploads during execution",
+        )
         self.add(g, "--scratchpad-size", default="1024", help="Scratchpad memory size in bytes")
         self.add(g, "--ip-address", default="192.168.100.50", help="Use given IP address")
         self.add(g, "--mac-address", default="0x10e2d5000001", help="Use given MAC address")
@@ -595,6 +638,12 @@ class ArgumentParser(argparse.ArgumentParser):
             default="5",
             help="Number of row bits used for BIST data inversion feature",
         )
+        self.add(
+            g,
+            "--bist-error-map-depth",
+            default="0",
+            help="Number of BIST Reader error map entries (0: no error map)",
+        )
 
         # Litex args
         builder_args(self.add_argument_group(title="Builder"))
@@ -5,7 +5,7 @@ from litedram.common import LiteDRAMNativePort
 from litex.gen.sim import passive, run_simulation
 from migen import Module
 
-from rowhammer_tester.gateware.bist import PatternMemory, Reader, Writer
+from rowhammer_tester.gateware.bist import ErrorMapMemory, PatternMemory, Reader, Writer
 
 # DUT ----------------------------------------------------------------------------------------------
 
@@ -21,6 +21,7 @@ class BISTDUT(Module):
         row_shift=10,
         writer=False,
         reader=False,
+        error_map_depth=None,
     ):
         self.address_width = address_width
         self.data_width = data_width
@@ -39,10 +40,19 @@ class BISTDUT(Module):
         inverter_kwargs = dict(rowbits=rowbits, row_shift=row_shift)
 
         if reader:
+            error_map = None
+            if error_map_depth is not None:
+                self.submodules.error_map = error_map = ErrorMapMemory(data_width, error_map_depth)
+                self.error_map_count = error_map.count.get_port(write_capable=True)
+                self.error_map_mask = error_map.mask.get_port()
+                self.specials += self.error_map_count, self.error_map_mask
+
             self.read_port = LiteDRAMNativePort(
                 address_width=address_width, data_width=data_width, mode="read"
             )
-            self.submodules.reader = Reader(self.read_port, self.pattern_mem, **inverter_kwargs)
+            self.submodules.reader = Reader(
+                self.read_port, self.pattern_mem, error_map=error_map, **inverter_kwargs
+            )
             self.reader.add_csrs()
 
         if writer:
@@ -55,6 +65,13 @@ class BISTDUT(Module):
         # storage for port_handler (addr, we, data)
         self.commands = []
 
+    @staticmethod
+    def mem_read(mem, addr):
+        yield mem.adr.eq(addr)
+        yield
+        yield
+        return (yield mem.dat_r)
+
     @staticmethod
     def mem_write(mem, addr, data):
         yield mem.we.eq(1)
@@ -526,3 +543,91 @@ class TestReader(unittest.TestCase):
                     else 0xAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
                 )
             self.assertEqual(data, expected, msg=addr)
+
+    def run_error_map_scan(self, dut, count, base, shift, skip_fifo=1):
+        yield from dut.reader._count.write(count)
+        yield from dut.reader._mem_mask.write(0xFFFFFFFF)
+        yield from dut.reader._data_mask.write(0x00000000)
+        yield from dut.reader._skip_fifo.write(skip_fifo)
+        yield from dut.reader._error_map_enable.write(1)
+        yield from dut.reader._error_map_base.write(base)
+        yield from dut.reader._error_map_shift.write(shift)
+
+        yield from dut.reader._start.write(1)
+        yield
+        yield from dut.reader._start.write(0)
+
+    def read_error_map(self, dut):
+        error_map = {}
+        for entry in range(dut.error_map.count.depth):
+            count = yield from dut.mem_read(dut.error_map_count, entry)
+            mask = yield from dut.mem_read(dut.error_map_mask, entry)
+            if count or mask:
+                error_map[entry] = (count, mask)
+        return error_map
+
+    def test_error_map(self):
+        # Errors accumulate per entry of 4 DMA transfers, starting at base 0x08
+        expected_data = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF
+        flips = {
+            0x03: 1 << 0,  # below base: overflow
+            0x09: 1 << 3,
+            0x0A: 1 << 64,
+            0x0B: 1 << 3,
+            0x11: (1 << 127) | (1 << 5),
+            0x2F: 1 << 9,  # above the 8-entry map: overflow
+        }
+        count = 0x30
+
+        def rdata_callback(addr):
+            return expected_data ^ flips.get(addr, 0)
+
+        def generator(dut):
+            # Leftovers from a previous scan must be cleared on start
+            yield from dut.mem_write(dut.error_map_count, 7, 123)
+
+            yield from self.run_error_map_scan(dut, count, base=0x08, shift=2)
+            yield from wait_or_timeout(2000, dut.reader._ready.read)
+
+            self.assertEqual((yield from dut.reader._done.read()), count)
+            self.assertEqual((yield from dut.reader._error_count.read()), len(flips))
+            self.assertEqual((yield from dut.reader._error_map_overflow.read()), 2)
+            self.assertEqual((yield from dut.reader._error_ready.read()), 0)
+            self.assertEqual(
+                (yield from self.read_error_map(dut)),
+                {
+                    0: (3, (1 << 3) | (1 << 64)),  # 0x08-0x0B
+                    2: (1, (1 << 127) | (1 << 5)),  # 0x10-0x13
+                },
+            )
+
+        dut = BISTDUT(pattern_init=[(0x00, expected_data)], reader=True, error_map_depth=8)
+        generators = [generator(dut), dut.read_handler(rdata_callback)]
+        run_simulation(dut, generators)
+
+    def test_error_map_with_fifo(self):
+        # With skip_fifo=0 errors are still reported through the FIFO as well
+        expected_data = 0xAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
+        errors = [0x1, 0x6]
+
+        def rdata_callback(addr):
+            return expected_data ^ (1 << addr) if addr in errors else expected_data
+
+        def generator(dut):
+            yield from self.run_error_map_scan(dut, 0x8, base=0, shift=1, skip_fifo=0)
+
+            for error in errors:
+                yield from wait_or_timeout(100, dut.reader._error_ready.read)
+                self.assertEqual((yield from dut.reader._error_offset.read()), error)
+                yield from dut.reader._error_continue.write(1)
+                yield
+
+            yield from wait_or_timeout(100, dut.reader._ready.read)
+            self.assertEqual(
+                (yield from self.read_error_map(dut)),
+                {0: (1, 1 << 0x1), 3: (1, 1 << 0x6)},
+            )
+
+        dut = BISTDUT(pattern_init=[(0x00, expected_data)], reader=True, error_map_depth=4)
+        generators = [generator(dut), dut.read_handler(rdata_callback)]
+        run_simulation(dut, generators)
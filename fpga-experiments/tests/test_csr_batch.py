@@ -0,0 +1,191 @@
+import os
+import socket
+import tempfile
+import threading
+import unittest
+
+from litex.tools.litex_client import RemoteClient
+from litex.tools.litex_server import RemoteServer
+
+from rowhammer_tester.scripts.csr_batch import MAX_RECORD_ACCESSES, CSRBatch
+
+CSR_BASE = 0x1000
+REGS = {
+    # name: (offset, length, mode)
+    "ctrl_update": (0x00, 1, "wo"),
+    "ctrl_count": (0x04, 1, "ro"),
+    "ctrl_wide": (0x08, 2, "rw"),
+    "ctrl_scratch": (0x10, 1, "rw"),
+}
+
+
+class FakeComm:
+    """Wishbone bus behind the stand-in litex_server; records every access in order."""
+
+    def __init__(self):
+        self.mem = {}
+        self.log = []
+        self.lock = threading.Lock()
+
+    def open(self):
+        pass
+
+    def close(self):
+        pass
+
+    def write(self, addr, datas):
+        with self.lock:
+            for i, data in enumerate(datas):
+                a = addr + 4 * i
+                self.log.append(("w", a, data))
+                if a == CSR_BASE + REGS["ctrl_update"][0]:
+                    # Latch scratch into count, like refresh_update/refresh_count
+                    self.mem[CSR_BASE + REGS["ctrl_count"][0]] = self.mem.get(
+                        CSR_BASE + REGS["ctrl_scratch"][0], 0
+                    )
+                else:
+                    self.mem[a] = data
+
+    def read(self, addr, length=1, burst="incr"):
+        with self.lock:
+            datas = []
+            for i in range(length):
+                a = addr + 4 * i
+                self.log.append(("r", a))
+                datas.append(self.mem.get(a, a ^ 0xFFFF0000))
+            return datas
+
+
+class CountingServer(RemoteServer):
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.packets = 0
+
+    def receive_packet(self, socket):
+        packet = super().receive_packet(socket)
+        if packet != 0:
+            self.packets += 1
+        return packet
+
+
+def free_tcp_port():
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+class TestCSRBatch(unittest.TestCase):
+    def setUp(self):
+        self.tmpdir = tempfile.TemporaryDirectory()
+        csr_csv = os.path.join(self.tmpdir.name, "csr.csv")
+        with open(csr_csv, "w") as f:
+            f.write("csr_base,ctrl,0x{:08x},,\n".format(CSR_BASE))
+            for name, (offset, length, mode) in REGS.items():
+                f.write(f"csr_register,{name},0x{CSR_BASE + offset:08x},{length},{mode}\n")
+            f.write("constant,config_csr_data_width,32,,\n")
+
+        self.comm = FakeComm()
+        port = free_tcp_port()
+        self.server = CountingServer(self.comm, "127.0.0.1", port)
+        self.server.open()
+        self.server.start(1)
+        self.wb = RemoteClient(host="127.0.0.1", port=port, csr_csv=csr_csv)
+        self.wb.open()
+
+    def tearDown(self):
+        self.wb.close()
+        self.server.close()
+        self.tmpdir.cleanup()
+
+    def test_registers(self):
+        with CSRBatch(self.wb) as batch:
+            batch.regs.ctrl_wide.write(0x1122334455667788)
+            batch.regs.ctrl_scratch.write(42)
+            batch.regs.ctrl_update.write(1)
+            wide = batch.regs.ctrl_wide.read()
+            count = batch.regs.ctrl_count.read()
+            self.assertFalse(count.done())
+        self.assertTrue(count.done())
+        self.assertEqual(wide.result(), 0x1122334455667788)
+        self.assertEqual(count.result(), 42)
+        # Values are visible to the non-batched client afterwards
+        self.assertEqual(self.wb.regs.ctrl_wide.read(), 0x1122334455667788)
+
+        with self.assertRaises(KeyError):
+            batch.regs.ctrl_update.read()
+        with self.assertRaises(KeyError):
+            batch.regs.ctrl_count.write(0)
+
+    def test_accesses_keep_program_order(self):
+        scratch = CSR_BASE + REGS["ctrl_scratch"][0]
+        with CSRBatch(self.wb) as batch:
+            batch.write(scratch, 1)
+            first = batch.read(scratch)
+            batch.write(scratch, 2)
+            second = batch.read(scratch)
+            batch.write(scratch + 0x100, [7, 8])
+            batch.write(scratch + 0x200, 9)
+            third = batch.read(scratch + 0x100, length=2)
+
+        self.assertEqual([first.result(), second.result(), third.result()], [1, 2, [7, 8]])
+        self.assertEqual(
+            self.comm.log,
+            [
+                ("w", scratch, 1),
+                ("r", scratch),
+                ("w", scratch, 2),
+                ("r", scratch),
+                ("w", scratch + 0x100, 7),
+                ("w", scratch + 0x104, 8),
+                ("w", scratch + 0x200, 9),
+                ("r", scratch + 0x100),
+                ("r", scratch + 0x104),
+            ],
+        )
+        # Records hold either consecutive writes or reads
+        self.assertEqual(batch.stats.packets, 7)
+
+    def test_reads_are_coalesced(self):
+        base = 0x40000000
+        n = 3 * MAX_RECORD_ACCESSES + 10
+        with CSRBatch(self.wb, max_inflight=2) as batch:
+            futures = [batch.read(base + 16 * i) for i in range(n)]
+
+        self.assertEqual(
+            [f.result() for f in futures], [(base + 16 * i) ^ 0xFFFF0000 for i in range(n)]
+        )
+        self.assertEqual(batch.stats.packets, 4)
+        self.assertEqual(batch.stats.responses, 4)
+        self.assertEqual(self.server.packets, 4)
+        self.assertEqual(batch.stats.peak_inflight, 3)
+
+    def test_records_stay_in_flight(self):
+        scratch = CSR_BASE + REGS["ctrl_scratch"][0]
+        batch = CSRBatch(self.wb, max_inflight=4)
+        futures = []
+        for i in range(4):
+            batch.write(scratch, i)
+            futures.append(batch.read(scratch))
+        batch.submit()
+        # All four records were sent before any response was consumed
+        self.assertEqual(batch.stats.peak_inflight, 4)
+        self.assertEqual(batch.stats.responses, 0)
+
+        # Resolving the last future consumes the responses in order
+        self.assertEqual(futures[3].result(), 3)
+        self.assertTrue(all(f.done() for f in futures))
+        self.assertEqual([f.result() for f in futures], [0, 1, 2, 3])
+        self.assertEqual(self.wb.read(scratch), 3)
+
+    def test_long_write_bursts_are_split(self):
+        base = 0x40000000
+        datas = list(range(2 * MAX_RECORD_ACCESSES + 1))
+        with CSRBatch(self.wb) as batch:
+            batch.write(base, datas)
+            back = batch.read(base + 4 * MAX_RECORD_ACCESSES, length=3)
+        self.assertEqual(back.result(), datas[MAX_RECORD_ACCESSES : MAX_RECORD_ACCESSES + 3])
+        self.assertEqual(batch.stats.packets, 4)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,6 +1,11 @@
 import unittest
 from collections import namedtuple
-from random import randint
+from random import Random, randint
+
+try:
+    import numpy as np
+except ImportError:  # only needed by Encoder.encode_arrays
+    np = None
 
 from litedram.dfii import DFIInjector
 from litedram.phy import dfi
@@ -242,6 +247,80 @@ class TestDecoder(unittest.TestCase):
         run_simulation(dut, generator(dut))
 
 
+@unittest.skipUnless(np is not None, "numpy not installed")
+class TestEncoderArrays(unittest.TestCase):
+    @staticmethod
+    def random_program(n, seed, *, nranks=1, long_timeslices=True):
+        rng = Random(seed)
+        ops = [OpCode.NOOP, OpCode.LOOP, OpCode.ACT, OpCode.PRE, OpCode.REF, OpCode.READ]
+        fields = {k: [] for k in ["op_code", "timeslice", "bank", "row", "col", "rank"]}
+        fields.update(count=[], jump=[])
+        for _ in range(n):
+            op = rng.choice(ops)
+            max_timeslice = 200 if long_timeslices else 2**Decoder.TIMESLICE - 1
+            values = dict(
+                op_code=op,
+                timeslice=rng.randint(0 if op == OpCode.NOOP else 1, max_timeslice),
+                bank=rng.randint(0, 2**3 - 1),
+                row=rng.randint(0, 2**14 - 1),
+                col=rng.choice([rng.randint(0, 2**10 - 1), 1 << 10]),
+                rank=rng.randint(0, nranks - 1),
+                count=rng.randint(0, 2**Decoder.LOOP_COUNT - 1),
+                jump=rng.randint(1, 2**Decoder.LOOP_JUMP - 1),
+            )
+            for k, v in values.items():
+                fields[k].append(v)
+        return fields
+
+    @staticmethod
+    def instructions(encoder, fields):
+        payload = []
+        for op, timeslice, bank, row, col, rank, count, jump in zip(*fields.values()):
+            if op == OpCode.LOOP:
+                payload.append(encoder.Instruction(op, count=count, jump=jump))
+            elif op == OpCode.NOOP:
+                payload.append(encoder.Instruction(op, timeslice=timeslice))
+            else:
+                rowcol = dict(row=row) if op == OpCode.ACT else dict(col=col)
+                address = encoder.address(bank=bank, rank=rank, **rowcol)
+                payload.append(encoder.Instruction(op, timeslice=timeslice, address=address))
+        return payload
+
+    def check_matches(self, encoder, fields):
+        expected = encoder(self.instructions(encoder, fields))
+        arrays = {k: np.array(v) for k, v in fields.items()}
+        encoded = encoder.encode_arrays(**arrays)
+        self.assertEqual(encoded.dtype, np.uint32)
+        self.assertEqual(encoded.tolist(), expected)
+
+    def test_matches_encoder(self):
+        self.check_matches(Encoder(bankbits=3), self.random_program(500, seed=1))
+
+    def test_matches_encoder_ranks(self):
+        encoder = Encoder(bankbits=3, nranks=4)
+        self.check_matches(encoder, self.random_program(500, seed=2, nranks=4))
+
+    def test_long_timeslice_noops(self):
+        # Every DFI instruction above 31 cycles is continued by NOOPs
+        fields = self.random_program(1, seed=0)
+        fields.update(op_code=[OpCode.ACT], timeslice=[88])
+        self.check_matches(Encoder(bankbits=3), fields)
+        self.assertEqual(len(Encoder(bankbits=3).encode_arrays(**fields)), 4)
+
+    def test_scalar_fields_broadcast(self):
+        encoder = Encoder(bankbits=3)
+        rows = np.arange(16)
+        encoded = encoder.encode_arrays(np.full(16, OpCode.ACT), 5, bank=2, row=rows)
+        expected = [
+            encoder(OpCode.ACT, timeslice=5, address=encoder.address(bank=2, row=row))[0]
+            for row in range(16)
+        ]
+        self.assertEqual(encoded.tolist(), expected)
+
+    def test_empty(self):
+        self.assertEqual(len(Encoder(bankbits=3).encode_arrays(np.array([], dtype=int))), 0)
+
+
 # DFIExecutor ------------------------------------------------------------------
 
 
@@ -353,6 +432,7 @@ class PayloadExecutorDUT(Module):
         rdphase=2,
         with_refresh=True,
         refresh_delay=3,
+        payload_banks=1,
     ):
         # store to be able to extract from dut later
         self.params = locals()
@@ -360,8 +440,15 @@ class PayloadExecutorDUT(Module):
 
         assert len(payload) <= payload_depth, f"{len(payload)} vs {payload_depth}"
         self.mem_scratchpad = Memory(data_width, scratchpad_depth)
-        self.mem_payload = Memory(instruction_width, payload_depth, init=payload)
-        self.specials += self.mem_scratchpad, self.mem_payload
+        # `payload` is loaded into bank 0, the others start empty
+        self.mem_payloads = [Memory(instruction_width, payload_depth, init=payload)] + [
+            Memory(instruction_width, payload_depth) for _ in range(payload_banks - 1)
+        ]
+        self.mem_payload = self.mem_payloads[0]
+        self.specials += self.mem_scratchpad, *self.mem_payloads
+        # Host side of the payload memories (the SoC bus)
+        self.payload_write_ports = [mem.get_port(write_capable=True) for mem in self.mem_payloads]
+        self.specials += self.payload_write_ports
 
         dfi_params = dict(
             addressbits=max(rowbits, colbits),
@@ -377,7 +464,7 @@ class PayloadExecutorDUT(Module):
         )
 
         self.submodules.payload_executor = PayloadExecutor(
-            self.mem_payload,
+            self.mem_payloads if payload_banks > 1 else self.mem_payload,
             self.mem_scratchpad,
             self.dfi_switch,
             nranks=nranks,
@@ -391,6 +478,21 @@ class PayloadExecutorDUT(Module):
         self.runtime_cycles = 0  # time when memory controller is disconnected
         self.execution_cycles = 0  # time when actually executing the payload
 
+    def upload(self, payload, bank=0):
+        # Write a payload like the host does over the bus, one word per cycle,
+        # terminated by a STOP in case a longer payload was there before
+        port = self.payload_write_ports[bank]
+        words = list(payload)
+        if len(words) < self.params["payload_depth"]:
+            words.append(0)  # NOOP with timeslice 0
+        for adr, word in enumerate(words):
+            yield port.adr.eq(adr)
+            yield port.dat_w.eq(word)
+            yield port.we.eq(1)
+            yield
+        yield port.we.eq(0)
+        yield
+
     def get_generators(self):
         return [self.dfi_monitor(), self.cycles_counter(), self.refresher()]
 
@@ -908,6 +1010,130 @@ class TestPayloadExecutor(unittest.TestCase):
                 dut.dfi_switch.add_csrs()
                 run_simulation(dut, [generator(dut, switch_at), *dut.get_generators()])
 
+    # Payload banks ------------------------------------------------------------
+
+    @staticmethod
+    def bank_payloads(encoder):
+        # Distinct command sequences, long enough to outlast an upload of the next one
+        return [
+            [
+                encoder.Instruction(OpCode.ACT, timeslice=20, address=encoder.address(row=1)),
+                encoder.Instruction(OpCode.PRE, timeslice=20, address=0),
+                encoder.Instruction(OpCode.REF, timeslice=20),
+            ],
+            [
+                encoder.Instruction(OpCode.REF, timeslice=20),
+                encoder.Instruction(OpCode.ACT, timeslice=20, address=encoder.address(row=2)),
+                encoder.Instruction(OpCode.READ, timeslice=20, address=encoder.address(col=8)),
+                encoder.Instruction(OpCode.PRE, timeslice=20, address=0),
+            ],
+            [
+                encoder.Instruction(OpCode.ACT, timeslice=20, address=encoder.address(row=3)),
+                encoder.Instruction(OpCode.READ, timeslice=20, address=encoder.address(col=8)),
+                encoder.Instruction(OpCode.PRE, timeslice=20, address=0),
+            ],
+        ]
+
+    @passive
+    def execution_monitor(self, dut, spans):
+        # Record [first, last + 1) cycle of every execution
+        cycle = 0
+        executing = False
+        while True:
+            now = bool((yield dut.payload_executor.executing))
+            if now and not executing:
+                spans.append([cycle, None])
+            if executing and not now:
+                spans[-1][1] = cycle
+            executing = now
+            yield
+            cycle += 1
+
+    def run_back_to_back(self, encoder, payloads, *, double_buffered):
+        # Single bank: each payload is uploaded once the previous one finished.
+        # Double buffered: it is uploaded into the idle bank while the previous
+        # one executes, so starting it only selects the bank.
+        encoded = [encoder(payload) for payload in payloads]
+        dut = PayloadExecutorDUT(
+            encoded[0], with_refresh=False, payload_banks=2 if double_buffered else 1
+        )
+        dut.payload_executor.add_csrs()
+        spans = []
+        banks = []
+
+        def generator(dut):
+            for i in range(len(encoded)):
+                bank = i % 2 if double_buffered else 0
+                if i > 0 and not double_buffered:
+                    yield from dut.upload(encoded[i])
+                if double_buffered:
+                    yield from dut.payload_executor._bank.write(bank)
+                yield from dut.payload_executor._start.write(1)
+                yield  # for the executor to leave READY
+                if double_buffered and i + 1 < len(encoded):
+                    yield from dut.upload(encoded[i + 1], bank=1 - bank)
+                    # the upload must finish within the execution to hide it
+                    self.assertFalse((yield dut.payload_executor.ready))
+                while not (yield dut.payload_executor.ready):
+                    yield
+                if double_buffered:
+                    banks.append((yield from dut.payload_executor._active_bank.read()))
+
+        run_simulation(
+            dut, [generator(dut), self.execution_monitor(dut, spans), *dut.get_generators()]
+        )
+        gaps = [nxt[0] - prev[1] for prev, nxt in zip(spans, spans[1:])]
+        return dut, spans, gaps, banks
+
+    def test_payload_banks_back_to_back(self):
+        # Check that payloads alternate between the banks and run in full
+        encoder = Encoder(bankbits=3)
+        payloads = self.bank_payloads(encoder)
+        dut, spans, _, banks = self.run_back_to_back(encoder, payloads, double_buffered=True)
+
+        self.assertEqual(len(spans), len(payloads))
+        self.assertEqual(banks, [0, 1, 0])
+        op_codes = [instr.op_code for payload in payloads for instr in payload]
+        self.assert_history(dut.dfi_history, op_codes)
+
+    def test_payload_bank_latched_at_start(self):
+        # Check that selecting and rewriting another bank during execution
+        # does not affect the running payload
+        encoder = Encoder(bankbits=3)
+        payloads = self.bank_payloads(encoder)
+        dut = PayloadExecutorDUT(encoder(payloads[0]), with_refresh=False, payload_banks=2)
+        dut.payload_executor.add_csrs()
+
+        def generator(dut):
+            yield from dut.payload_executor._start.write(1)
+            yield
+            yield from dut.payload_executor._bank.write(1)
+            yield from dut.upload(encoder(payloads[1]), bank=1)
+            self.assertEqual((yield dut.payload_executor.active_bank), 0)
+            while not (yield dut.payload_executor.ready):
+                yield
+
+        run_simulation(dut, [generator(dut), *dut.get_generators()])
+        self.assert_history(dut.dfi_history, [instr.op_code for instr in payloads[0]])
+
+    def test_payload_banks_inter_payload_gap(self):
+        # Compare the cycles between the end of one payload and the start of
+        # the next when the upload is serialized and when it is hidden. The
+        # upload is modelled as one word per cycle, far faster than Etherbone,
+        # so this checks the ordering, not the size of the saving on hardware.
+        encoder = Encoder(bankbits=3)
+        payloads = self.bank_payloads(encoder)
+        _, _, single, _ = self.run_back_to_back(encoder, payloads, double_buffered=False)
+        _, _, double, _ = self.run_back_to_back(encoder, payloads, double_buffered=True)
+
+        self.assertEqual(len(single), len(payloads) - 1)
+        self.assertEqual(len(double), len(payloads) - 1)
+        # With a hidden upload, the gap is the constant start latency
+        self.assertEqual(len(set(double)), 1)
+        # Serialized, every uploaded word adds at least a cycle
+        for i, (s, d) in enumerate(zip(single, double)):
+            self.assertGreaterEqual(s - d, len(encoder(payloads[i + 1])))
+
 
 class TestPayloadExecutorDDR5(unittest.TestCase):
     def run_payload(self, dut, **kwargs):
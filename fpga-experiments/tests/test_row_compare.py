@@ -0,0 +1,163 @@
+import os
+import random
+import shutil
+import socket
+import struct
+import subprocess
+import tempfile
+import time
+import unittest
+
+from rowhammer_tester.scripts.row_compare import (
+    RowCompareClient,
+    RowCompareError,
+    RowMismatch,
+    encode_request,
+)
+
+FIRMWARE_DIR = os.path.join(
+    os.path.dirname(__file__), "..", "firmware", "zcu104", "etherbone"
+)
+CC = os.environ.get("CC", "cc")
+
+MEM_SIZE = 1 << 20
+ROW_BYTES = 8192
+
+
+def free_udp_port():
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+@unittest.skipIf(shutil.which(CC) is None, "no host C compiler")
+class TestRowCompare(unittest.TestCase):
+    """Runs the ZCU104 firmware on the host with a file-backed PL memory window."""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.tmpdir = tempfile.TemporaryDirectory()
+        cls.binary = os.path.join(cls.tmpdir.name, "zcu104_etherbone")
+        sources = sorted(
+            os.path.join(FIRMWARE_DIR, f) for f in os.listdir(FIRMWARE_DIR) if f.endswith(".c")
+        )
+        subprocess.run(
+            [CC, "-O2", "-DNDEBUG", "-Wall", "-Wextra", "-Werror", "-o", cls.binary, *sources],
+            check=True,
+        )
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.tmpdir.cleanup()
+
+    def setUp(self):
+        self.mem_file = os.path.join(self.tmpdir.name, "pl_mem.bin")
+        self.pattern = 0xAAAAAAAA
+        with open(self.mem_file, "wb") as f:
+            f.write(struct.pack("<I", self.pattern) * (MEM_SIZE // 4))
+
+        self.port = free_udp_port()
+        self.server = subprocess.Popen(
+            [
+                self.binary,
+                "--pl-mem-file", self.mem_file,
+                "--pl-mem-base", "0",
+                "--pl-mem-size", str(MEM_SIZE),
+                "--udp-port", str(free_udp_port()),
+                "--compare-port", str(self.port),
+            ],
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        )
+        self.client = RowCompareClient("127.0.0.1", self.port, timeout=0.5)
+        self.wait_for_server()
+
+    def tearDown(self):
+        self.client.close()
+        self.server.terminate()
+        self.server.wait()
+
+    def wait_for_server(self):
+        for _ in range(40):
+            try:
+                self.client.compare([(0, 4)], [self.pattern])
+                return
+            except RowCompareError:
+                time.sleep(0.05)
+        self.fail("row compare server did not start")
+
+    def poke(self, addr, value):
+        with open(self.mem_file, "r+b") as f:
+            f.seek(addr)
+            f.write(struct.pack("<I", value))
+
+    def row_ranges(self, rows):
+        return [(row * ROW_BYTES, ROW_BYTES) for row in rows]
+
+    def test_no_mismatches(self):
+        result = self.client.compare(self.row_ranges(range(16)), [self.pattern])
+        self.assertEqual(result.mismatches, [])
+        self.assertEqual(result.total, 0)
+
+    def test_fill_pattern_mismatches(self):
+        # first, middle of a 16-word block and last word of a row, plus an unaligned word
+        flips = {
+            1 * ROW_BYTES: self.pattern ^ 0x1,
+            2 * ROW_BYTES + 0x44: self.pattern ^ 0x80000000,
+            3 * ROW_BYTES - 4: self.pattern ^ 0xFF00,
+            5 * ROW_BYTES + 0x8: self.pattern ^ 0x10,
+        }
+        for addr, value in flips.items():
+            self.poke(addr, value)
+
+        result = self.client.compare(self.row_ranges([1, 2, 5]), [self.pattern])
+        expected = [
+            RowMismatch(address=addr, data=value, expected=self.pattern)
+            for addr, value in sorted(flips.items())
+        ]
+        self.assertEqual(sorted(result.mismatches, key=lambda m: m.address), expected)
+        self.assertEqual(result.total, len(expected))
+
+    def test_per_row_pattern(self):
+        rng = random.Random(42)
+        words = [rng.getrandbits(32) for _ in range(ROW_BYTES // 4)]
+        with open(self.mem_file, "r+b") as f:
+            for row in (3, 7):
+                f.seek(row * ROW_BYTES)
+                f.write(struct.pack(f"<{len(words)}I", *words))
+        self.poke(7 * ROW_BYTES + 4 * 100, words[100] ^ 0x4)
+
+        result = self.client.compare(self.row_ranges([3, 7]), words)
+        self.assertEqual(
+            result.mismatches,
+            [RowMismatch(address=7 * ROW_BYTES + 400, data=words[100] ^ 0x4, expected=words[100])],
+        )
+
+    def test_truncated_report(self):
+        for i in range(10):
+            self.poke(4 * i, ~self.pattern & 0xFFFFFFFF)
+        self.client.max_mismatches = 3
+        result = self.client.compare(self.row_ranges([0]), [self.pattern])
+        self.assertEqual(len(result.mismatches), 3)
+        self.assertEqual(result.total, 10)
+        self.assertTrue(result.truncated)
+
+    def test_split_requests(self):
+        self.poke(100 * ROW_BYTES // 16, 0)
+        self.client.max_request_size = 200
+        ranges = [(i * ROW_BYTES // 16, ROW_BYTES // 16) for i in range(MEM_SIZE * 16 // ROW_BYTES)]
+        result = self.client.compare(ranges, [self.pattern])
+        self.assertEqual(result.mismatches, [RowMismatch(100 * ROW_BYTES // 16, 0, self.pattern)])
+
+    def test_out_of_bounds(self):
+        with self.assertRaises(RowCompareError):
+            self.client.compare([(MEM_SIZE - 4, 8)], [self.pattern])
+
+    def test_malformed_request(self):
+        # a request claiming more pattern words than it carries
+        request = encode_request(1, [(0, 4)], [self.pattern], 16)[:-4]
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+            s.settimeout(0.5)
+            s.sendto(request, ("127.0.0.1", self.port))
+            status = struct.unpack_from("!IHHI", s.recv(1024))[2]
+        self.assertNotEqual(status, 0)
@@ -1,3 +1,4 @@
+import bisect
 import logging
 import sys
 from typing import List, Iterable, Dict, Tuple
@@ -6,9 +7,11 @@ from bitarray import bitarray
 
 from rowhammer_tester.gateware.payload_executor import Encoder, OpCode
 from rowhammer_tester.scripts.litedram_settings import LiteDramSettings
+from rowhammer_tester.scripts.row_compare import RowCompareClient, ROW_COMPARE_PORT
 from rowhammer_tester.scripts.utils import (
     RemoteClient,
     get_generated_file,
+    get_generated_defs,
     DRAMAddressConverter,
     memread,
     hw_memtest,
@@ -21,6 +24,7 @@ from utrr.dram.bitflip_location import BitFlipLocation
 from utrr.dram.bitutil import BitUtil
 from utrr.dram.dram_address import DramAddress
 from utrr.dram.dram_row_mapping import DramRowMapping
+from utrr.dram.payload_banks import PayloadBanks
 
 logger = logging.getLogger(__name__)
 
@@ -218,7 +222,11 @@ class DramController:
         self.main_ram_size = self.client.mems.main_ram.size
         self.payload_mem_size = self.client.mems.payload.size
 
-        self._last_payload = None
+        # With two payload banks the next payload uploads while one executes
+        self.payload_banks = (
+            PayloadBanks(self.client) if hasattr(self.client.mems, "payload1") else None
+        )
+        self._row_compare = None
         self.encoder = Encoder(
             bankbits=self.settings.geom.bankbits, nranks=self.settings.phy.nranks
         )
@@ -525,6 +533,84 @@ class DramController:
 
         return bitflip_locations
 
+    def row_compare_client(self) -> RowCompareClient:
+        """Client of the on-board row compare service (ZCU104 firmware only)."""
+        if self._row_compare is None:
+            defs = get_generated_defs()
+            self._row_compare = RowCompareClient(
+                host=defs["IP_ADDRESS"], port=ROW_COMPARE_PORT
+            )
+        return self._row_compare
+
+    def compare_rows(
+        self, bank: int, rows: Iterable[int], pattern_32bit: int
+    ) -> List[BitFlipLocation]:
+        """
+        Like dma_memtest_rows, but the rows are compared on the board and only
+        the mismatching words are transferred.
+        """
+        return self.compare_addresses(
+            [DramAddress(bank=bank, row=row) for row in set(rows)], pattern_32bit
+        )
+
+    def compare_addresses(
+        self, addresses: Iterable[DramAddress], pattern_32bit: int
+    ) -> List[BitFlipLocation]:
+        return self._compare_rows_on_board(addresses, [pattern_32bit], full_row=True)
+
+    def compare_rowsbits(
+        self, bank: int, rows: Iterable[int], expected_bits: bitarray
+    ) -> List[BitFlipLocation]:
+        """Like memtest_rowsbits, compared on the board."""
+        return self._compare_rows_on_board(
+            [DramAddress(bank=bank, row=row) for row in set(rows)],
+            BitUtil.bitarray_to_int_list(expected_bits.copy()),
+            full_row=False,
+        )
+
+    def _compare_rows_on_board(
+        self, addresses: Iterable[DramAddress], pattern: List[int], full_row: bool
+    ) -> List[BitFlipLocation]:
+        # (start, end, address) of every row, sorted by start address
+        row_ranges = []
+        for address in set(addresses):
+            start, end, _ = self.compute_row_address_range(
+                converter=self.converter,
+                bank=address.bank,
+                row=self.to_logical_row(address.row),
+                base=self.main_ram_base,
+            )
+            if not full_row:
+                end = start + 4 * len(pattern)
+            row_ranges.append((start, end, address))
+        row_ranges.sort(key=lambda r: r[0])
+
+        result = self.row_compare_client().compare(
+            [(start, end - start) for start, end, _ in row_ranges], pattern
+        )
+        if result.truncated:
+            logger.warning(
+                f"Row compare reported {len(result.mismatches)} of {result.total} mismatching words"
+            )
+
+        starts = [start for start, _, _ in row_ranges]
+        bitflip_locations = []
+        for mismatch in result.mismatches:
+            start, _, address = row_ranges[bisect.bisect_right(starts, mismatch.address) - 1]
+            bit_offset = (mismatch.address - start) // 4 * 32
+            diff = mismatch.data ^ mismatch.expected
+            for bit_position in range(32):
+                if diff & (1 << bit_position):
+                    bitflip_locations.append(
+                        BitFlipLocation(
+                            bank=address.bank,
+                            row=address.row,
+                            bit_index=bit_offset + bit_position,
+                        )
+                    )
+
+        return sorted(bitflip_locations)
+
     def align_refresh(self, target_ref_count: int):
         self.disable_refresh()
         ref_count = self.read_refresh_count()
@@ -574,9 +660,10 @@ class DramController:
         self.client.regs.controller_settings_refresh.write(0)
 
     def read_refresh_count(self) -> int:
-        self.client.regs.dfi_switch_refresh_update.write(1)
-        now = self.client.regs.dfi_switch_refresh_count.read()
-        return now
+        with self.client.batch() as batch:
+            batch.regs.dfi_switch_refresh_update.write(1)
+            now = batch.regs.dfi_switch_refresh_count.read()
+        return now.result()
 
     def to_logical_row(self, row: int) -> int:
         return self.dram_row_mapping.physical_to_logical(row)
@@ -672,9 +759,27 @@ class DramController:
         return payload
 
     def execute_payload(self, payload: List[Encoder.Instruction], verbose: bool = True):
-        encoder = self.encoder
+        self.execute_encoded_payload(self.encode_payload(payload), verbose)
+
+    def encode_payload(self, payload: List[Encoder.Instruction]) -> List[int]:
+        """Host-only part of execute_payload, safe to call while the device is busy."""
         assert len(payload) * 4 < self.payload_mem_size
-        execute_payload(encoder(payload), self.client, verbose)
+        return self.encoder(payload)
+
+    def stage_payload(self, encoded: List[int]) -> None:
+        """Announce a payload that will be executed later, in staging order.
+
+        Host-only like encode_payload; the upload itself happens in
+        execute_encoded_payload while the preceding payload executes.
+        """
+        if self.payload_banks is not None:
+            self.payload_banks.stage(encoded)
+
+    def execute_encoded_payload(self, encoded: List[int], verbose: bool = True):
+        if self.payload_banks is None:
+            execute_payload(encoded, self.client, verbose)
+        else:
+            self.payload_banks.execute(encoded, verbose)
 
     @staticmethod
     def compute_row_address_range(
@@ -739,4 +844,6 @@ class DramController:
         return bitflips
 
     def __del__(self):
+        if getattr(self, "_row_compare", None) is not None:
+            self._row_compare.close()
         self.client.close()
@@ -0,0 +1,63 @@
+import collections
+import threading
+from typing import List, Optional
+
+from rowhammer_tester.scripts.utils import execute_payload, memwrite, payload_bank_base
+
+
+class PayloadBanks:
+    """
+    Payload memory of a SoC built with `--payload-banks 2`.
+
+    Keeps track of what each bank holds, executes from a bank that already
+    holds the payload or from the idle one, and uploads the next staged payload
+    into the other bank while the current one executes.
+
+    stage_payload() may be called from another thread (the prefetch runner's
+    prepare thread); everything else runs on the thread driving the device.
+    """
+
+    def __init__(self, client):
+        self.client = client
+        self._contents: List[Optional[List[int]]] = [None, None]
+        self._last_bank = 0
+        self._staged = collections.deque()
+        self._staged_lock = threading.Lock()
+
+    def stage(self, encoded: List[int]) -> None:
+        with self._staged_lock:
+            self._staged.append(encoded)
+
+    def execute(self, encoded: List[int], verbose: bool = True) -> None:
+        with self._staged_lock:
+            # Drop everything staged up to this payload (runs may have been skipped)
+            if any(staged is encoded for staged in self._staged):
+                while self._staged.popleft() is not encoded:
+                    pass
+            upcoming = self._staged[0] if self._staged else None
+
+        bank = self._pick_bank(encoded, keep=upcoming)
+        upload = None if self._contents[bank] == encoded else encoded
+        self._contents[bank] = encoded
+        self._last_bank = bank
+
+        def upload_upcoming():
+            # Look again: the next payload may have been staged in the meantime
+            with self._staged_lock:
+                upcoming = self._staged[0] if self._staged else None
+            idle = 1 - bank
+            if upcoming is not None and upcoming not in self._contents:
+                memwrite(self.client, upcoming, base=payload_bank_base(self.client, idle))
+                self._contents[idle] = upcoming
+
+        execute_payload(upload, self.client, verbose, bank=bank, while_running=upload_upcoming)
+
+    def _pick_bank(self, encoded: List[int], keep: Optional[List[int]]) -> int:
+        """Bank already holding `encoded`, else one not holding `keep`, else the idle one."""
+        for bank, contents in enumerate(self._contents):
+            if contents == encoded:
+                return bank
+        for bank, contents in enumerate(self._contents):
+            if keep is not None and contents == keep:
+                return 1 - bank
+        return 1 - self._last_bank
@@ -33,6 +33,9 @@ class ExperimentResultDir:
     def get_result_export_path(self) -> Path:
         return self.path / "results.jsonl"
 
+    def get_columnar_results_path(self) -> Path:
+        return self.path / "results"
+
     def get_payload_path(self, payload_id: int = 0) -> Path:
         filename = f"payload_{payload_id}.txt"
         return self.path / filename
@@ -0,0 +1,251 @@
+import logging
+import queue
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Iterable, List, Tuple
+
+from utrr.dram.dram_controller import DramController
+from utrr.pipeline.pipeline import Pipeline
+from utrr.pipeline.pipeline_context import PipelineContext
+from utrr.pipeline.stage.stage import Stage
+
+logger = logging.getLogger(__name__)
+
+Interval = Tuple[float, float]
+
+
+@dataclass
+class RunSpec:
+    label: str
+    stages: List[Stage]
+
+
+@dataclass
+class OverlapReport:
+    runs: int = 0
+    wall_s: float = 0.0
+    device_busy_s: float = 0.0
+    host_busy_s: float = 0.0
+    # Time during which host work (prepare/finish) and device work ran concurrently
+    overlap_s: float = 0.0
+    device_intervals: List[Interval] = field(default_factory=list, repr=False)
+    host_intervals: List[Interval] = field(default_factory=list, repr=False)
+
+    @property
+    def host_hidden_ratio(self) -> float:
+        """Fraction of host work hidden behind device work."""
+        return self.overlap_s / self.host_busy_s if self.host_busy_s > 0 else 0.0
+
+    def finalize(self, wall_s: float) -> "OverlapReport":
+        device = _merge(self.device_intervals)
+        host = _merge(self.host_intervals)
+        self.wall_s = wall_s
+        self.device_busy_s = _length(device)
+        self.host_busy_s = _length(host)
+        self.overlap_s = _intersection_length(device, host)
+        return self
+
+    def __str__(self) -> str:
+        return (
+            f"{self.runs} runs in {self.wall_s:.2f} s: "
+            f"device busy {self.device_busy_s:.2f} s, host busy {self.host_busy_s:.2f} s, "
+            f"overlapped {self.overlap_s:.2f} s "
+            f"({100 * self.host_hidden_ratio:.1f}% of host work hidden)"
+        )
+
+
+def _merge(intervals: List[Interval]) -> List[Interval]:
+    merged = []
+    for start, end in sorted(intervals):
+        if merged and start <= merged[-1][1]:
+            merged[-1] = (merged[-1][0], max(merged[-1][1], end))
+        else:
+            merged.append((start, end))
+    return merged
+
+
+def _length(intervals: List[Interval]) -> float:
+    return sum(end - start for start, end in intervals)
+
+
+def _intersection_length(a: List[Interval], b: List[Interval]) -> float:
+    total, i, j = 0.0, 0, 0
+    while i < len(a) and j < len(b):
+        start = max(a[i][0], b[j][0])
+        end = min(a[i][1], b[j][1])
+        if end > start:
+            total += end - start
+        if a[i][1] < b[j][1]:
+            i += 1
+        else:
+            j += 1
+    return total
+
+
+def split_host_tail(stages: List[Stage]) -> Tuple[List[Stage], List[Stage]]:
+    """Splits off the trailing host-only stages, which may run after the device moved on."""
+    split = len(stages)
+    while split > 0 and stages[split - 1].host_only:
+        split -= 1
+    return stages[:split], stages[split:]
+
+
+_DONE = object()
+
+
+class PrefetchRunner:
+    """
+    Runs a sequence of pipelines with three threads connected by bounded queues:
+
+      prepare: builds run N+1 (RunSpec generation, Stage.prepare, e.g. payload
+               compilation and encoding) while run N is on the device
+      device:  executes the device stages of each run, strictly in order
+      finish:  executes the trailing host-only stages of run N (flip decoding,
+               export) while run N+1 is already uploading/executing
+
+    Device stages of different runs never interleave, so a run that rewrites
+    rows shared with the previous run only does so after the previous run's
+    checks have completed; finish stages run in run order as well. `depth`
+    bounds how many prepared runs and unfinished results may be queued.
+    """
+
+    def __init__(self, controller: DramController, depth: int = 2):
+        if depth < 1:
+            raise ValueError("Prefetch depth must be at least 1")
+        self.controller = controller
+        self.depth = depth
+
+    def run(self, specs: Iterable[RunSpec], on_run_done=None) -> OverlapReport:
+        report = OverlapReport()
+        lock = threading.Lock()
+        stop = threading.Event()
+        errors = []
+
+        def record(intervals: List[Interval], start: float):
+            with lock:
+                intervals.append((start, time.time()))
+
+        def put(q: queue.Queue, item) -> bool:
+            while not stop.is_set():
+                try:
+                    q.put(item, timeout=0.1)
+                    return True
+                except queue.Full:
+                    pass
+            return False
+
+        def get(q: queue.Queue):
+            while not stop.is_set():
+                try:
+                    return q.get(timeout=0.1)
+                except queue.Empty:
+                    pass
+            return _DONE
+
+        prepared = queue.Queue(maxsize=self.depth)
+        finished = queue.Queue(maxsize=self.depth)
+
+        def prepare_worker():
+            try:
+                it = iter(specs)
+                while True:
+                    start = time.time()
+                    spec = next(it, None)
+                    if spec is not None:
+                        for stage in spec.stages:
+                            stage.prepare(self.controller)
+                    record(report.host_intervals, start)
+                    if spec is None or not put(prepared, spec):
+                        break
+            except BaseException as e:
+                errors.append(e)
+                stop.set()
+            finally:
+                put(prepared, _DONE)
+
+        def finish_worker():
+            try:
+                while True:
+                    item = get(finished)
+                    if item is _DONE:
+                        break
+                    spec, host_stages, pipe_ctxt = item
+                    start = time.time()
+                    if host_stages:
+                        Pipeline(stages=host_stages).run(
+                            controller=self.controller, pipe_ctxt=pipe_ctxt
+                        )
+                    record(report.host_intervals, start)
+                    if on_run_done is not None:
+                        on_run_done(spec)
+            except BaseException as e:
+                errors.append(e)
+                stop.set()
+
+        threads = [
+            threading.Thread(target=prepare_worker, name="utrr-prepare", daemon=True),
+            threading.Thread(target=finish_worker, name="utrr-finish", daemon=True),
+        ]
+        wall_start = time.time()
+        for thread in threads:
+            thread.start()
+
+        try:
+            while True:
+                spec = get(prepared)
+                if spec is _DONE:
+                    break
+                device_stages, host_stages = split_host_tail(spec.stages)
+                start = time.time()
+                pipe_ctxt = Pipeline(stages=device_stages).run_with_new_ctxt(
+                    controller=self.controller
+                )
+                record(report.device_intervals, start)
+                report.runs += 1
+                if not put(finished, (spec, host_stages, pipe_ctxt)):
+                    break
+        except BaseException:
+            stop.set()
+            raise
+        finally:
+            put(finished, _DONE)
+            for thread in threads:
+                thread.join()
+
+        if errors:
+            raise errors[0]
+
+        report.finalize(time.time() - wall_start)
+        logger.info(f"Prefetch pipeline: {report}")
+        return report
+
+
+def run_sequential(
+    controller: DramController, specs: Iterable[RunSpec], on_run_done=None
+) -> OverlapReport:
+    """Reference behaviour without prefetching, reporting the same statistics."""
+    report = OverlapReport()
+    wall_start = time.time()
+    for spec in specs:
+        start = time.time()
+        for stage in spec.stages:
+            stage.prepare(controller)
+        report.host_intervals.append((start, time.time()))
+
+        device_stages, host_stages = split_host_tail(spec.stages)
+        start = time.time()
+        pipe_ctxt = Pipeline(stages=device_stages).run_with_new_ctxt(controller=controller)
+        report.device_intervals.append((start, time.time()))
+
+        start = time.time()
+        if host_stages:
+            Pipeline(stages=host_stages).run(controller=controller, pipe_ctxt=pipe_ctxt)
+        report.host_intervals.append((start, time.time()))
+        report.runs += 1
+        if on_run_done is not None:
+            on_run_done(spec)
+
+    report.finalize(time.time() - wall_start)
+    logger.info(f"Sequential pipeline: {report}")
+    return report
@@ -0,0 +1,158 @@
+"""
+Columnar storage for uTRR run results.
+
+Every run result directory (e.g. `<experiment>/modulo_3/`) gets a `results/`
+directory of Arrow IPC files with one row per run. The experiment base
+directory holds `results_index.json`, which lists every result directory
+together with the experiment parameters it was recorded with, so that queries
+only need to open the files matching the requested parameters.
+
+plots/utrr_results.py implements the matching loader.
+"""
+
+import json
+import os
+import threading
+import time
+from pathlib import Path
+from typing import Any, Dict, List
+
+import pyarrow as pa
+
+INDEX_FILE_NAME = "results_index.json"
+INDEX_VERSION = 1
+
+ADDRESS_TYPE = pa.struct([("bank", pa.int32()), ("row", pa.int32())])
+
+# Types of the keys emitted by the pipeline stages; other keys are inferred.
+KNOWN_COLUMN_TYPES = {
+    "run": pa.int32(),
+    "refresh_counter_before": pa.int64(),
+    "refresh_counter_after": pa.int64(),
+    "indices_not_bitflipped": pa.list_(pa.int32()),
+    "addresses_not_bitflipped": pa.list_(ADDRESS_TYPE),
+    "addresses_dict_bitflipped": pa.list_(ADDRESS_TYPE),
+}
+
+
+def _normalize_value(value: Any) -> Any:
+    # DramAddress.to_dict() also carries a redundant "row_hex" string
+    if isinstance(value, list) and value and isinstance(value[0], dict) and "row" in value[0]:
+        return [{"bank": v["bank"], "row": v["row"]} for v in value]
+    return value
+
+
+class ResultIndex:
+    """`results_index.json` of an experiment base directory."""
+
+    def __init__(self, base_path: Path):
+        self.base_path = Path(base_path)
+        self.path = self.base_path / INDEX_FILE_NAME
+        self._lock = threading.Lock()
+        self.entries: Dict[str, Dict[str, Any]] = {}
+        if self.path.is_file():
+            with self.path.open() as f:
+                for entry in json.load(f)["entries"]:
+                    self.entries[entry["path"]] = entry
+
+    def update(self, results_path: Path, params: Dict[str, Any], runs: int, columns: List[str]):
+        rel = Path(os.path.relpath(results_path, self.base_path)).as_posix()
+        with self._lock:
+            self.entries[rel] = {
+                "path": rel,
+                "params": params,
+                "runs": runs,
+                "columns": columns,
+            }
+            tmp = self.path.with_suffix(".tmp")
+            with tmp.open("w") as f:
+                json.dump(
+                    {"version": INDEX_VERSION, "entries": list(self.entries.values())},
+                    f,
+                    indent=4,
+                )
+            tmp.replace(self.path)
+
+
+class ColumnarResultWriter:
+    """
+    Buffers per-run result records and writes them as Arrow IPC files of up to
+    `batch_runs` runs each, or of whatever is buffered once the oldest record
+    is `max_buffer_s` seconds old, so an interrupted experiment loses little.
+    Call flush() once the experiment is done.
+
+    The schema grows with the data: keys first seen in a later batch become
+    new columns and columns that were all-None get their type once values
+    appear. Each part carries the schema known when it was written; the
+    loader unifies them.
+    """
+
+    def __init__(
+        self,
+        results_path: Path,
+        index: ResultIndex,
+        params: Dict[str, Any],
+        batch_runs: int = 16,
+        max_buffer_s: float = 30.0,
+    ):
+        self.results_path = Path(results_path)
+        self.index = index
+        self.params = params
+        self.batch_runs = batch_runs
+        self.max_buffer_s = max_buffer_s
+
+        self._records: List[Dict[str, Any]] = []
+        self._first_buffered = 0.0
+        self._runs = 0
+        self._parts = 0
+        self._schema = None
+
+    def append(self, data: Dict[str, Any]) -> None:
+        if not self._records:
+            self._first_buffered = time.monotonic()
+        record = {"run": self._runs + len(self._records)}
+        record.update({key: _normalize_value(value) for key, value in data.items()})
+        self._records.append(record)
+        if (
+            len(self._records) >= self.batch_runs
+            or time.monotonic() - self._first_buffered >= self.max_buffer_s
+        ):
+            self.flush()
+
+    def flush(self) -> None:
+        if not self._records:
+            return
+
+        schema = self._infer_schema(self._records)
+        if self._schema is not None:
+            schema = pa.unify_schemas([self._schema, schema], promote_options="permissive")
+        batch = pa.RecordBatch.from_pylist(self._records, schema=schema)
+        self._schema = schema
+
+        self.results_path.mkdir(parents=True, exist_ok=True)
+        part = self.results_path / f"part-{self._parts:05d}.arrow"
+        tmp = part.with_suffix(".tmp")
+        with pa.OSFile(str(tmp), "wb") as sink:
+            with pa.ipc.new_file(sink, schema) as writer:
+                writer.write_batch(batch)
+        tmp.replace(part)
+
+        self._parts += 1
+        self._runs += len(self._records)
+        self._records = []
+        self.index.update(self.results_path, self.params, self._runs, schema.names)
+
+    @staticmethod
+    def _infer_schema(records: List[Dict[str, Any]]) -> pa.Schema:
+        names = []
+        for record in records:
+            names.extend(key for key in record if key not in names)
+
+        fields = []
+        for name in names:
+            if name in KNOWN_COLUMN_TYPES:
+                fields.append(pa.field(name, KNOWN_COLUMN_TYPES[name]))
+            else:
+                values = pa.array([record.get(name) for record in records])
+                fields.append(pa.field(name, values.type))
+        return pa.schema(fields)
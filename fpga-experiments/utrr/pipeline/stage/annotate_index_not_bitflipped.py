@@ -10,6 +10,8 @@ logger = logging.getLogger(__name__)
 
 
 class AnnotateIndexNotBitflipped(Stage):
+    host_only = True
+
     def __init__(
         self,
         addresses: Dict[DramAddress, List[int]],
@@ -14,15 +14,27 @@ class ExecutePayload(Stage):
     ):
         self.payload = payload
         self.verbose = verbose
+        self._encoded = None
 
     def setup(self, controller: DramController):
         pass
 
+    def _encode(self, controller: DramController) -> List[int]:
+        if self._encoded is None:
+            self._encoded = controller.encode_payload(self.payload)
+        return self._encoded
+
+    def prepare(self, controller: DramController):
+        # Stages are shared by all runs of a spec, so the encoding is cached but
+        # every run stages its payload again, in the order the runs will execute
+        if self.payload:
+            controller.stage_payload(self._encode(controller))
+
     def execute(
         self, controller: DramController, pipe_ctxt: PipelineContext
     ) -> PipelineContext:
         if self.payload:
-            controller.execute_payload(payload=self.payload, verbose=self.verbose)
+            controller.execute_encoded_payload(self._encode(controller), verbose=self.verbose)
         return pipe_ctxt
 
     def __repr__(self) -> str:
@@ -0,0 +1,25 @@
+from utrr.pipeline.pipeline_context import PipelineContext
+from utrr.pipeline.result_store import ColumnarResultWriter
+from utrr.pipeline.stage.stage import Stage
+from utrr.dram.dram_controller import DramController
+
+
+class ExportColumnar(Stage):
+    """Columnar counterpart of ExportPipeContext: appends the `data` field as one row."""
+
+    host_only = True
+
+    def __init__(self, writer: ColumnarResultWriter):
+        self.writer = writer
+
+    def setup(self, controller: DramController):
+        pass
+
+    def execute(
+        self, controller: DramController, pipe_ctxt: PipelineContext
+    ) -> PipelineContext:
+        self.writer.append(pipe_ctxt.data)
+        return pipe_ctxt
+
+    def __repr__(self):
+        return f"{self.__class__.__name__}(path={self.writer.results_path})"
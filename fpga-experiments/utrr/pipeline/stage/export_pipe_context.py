@@ -24,6 +24,8 @@ class ExportPipeContext(Stage):
 
     _instances: Dict[Path, "ExportPipeContext"] = {}
 
+    host_only = True
+
     def __new__(cls, filepath: Path):
         # Check if an instance already exists for this filepath
         if filepath in cls._instances:
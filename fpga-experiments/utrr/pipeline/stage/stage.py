@@ -5,10 +5,22 @@ from utrr.dram.dram_controller import DramController
 
 
 class Stage(ABC):
+    # Stages that never access the device. A trailing run of such stages may be
+    # executed by PrefetchRunner while the next run is already on the device.
+    host_only: bool = False
+
     @abstractmethod
     def setup(self, controller: DramController):
         pass
 
+    def prepare(self, controller: DramController):
+        """
+        Host-only work (e.g. payload encoding) that can be done ahead of time,
+        possibly on another thread while the device executes an earlier run.
+        Must not access the device.
+        """
+        pass
+
     @abstractmethod
     def execute(
         self, controller: DramController, pipe_ctxt: PipelineContext
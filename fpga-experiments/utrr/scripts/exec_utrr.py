@@ -2,6 +2,8 @@
 import argparse
 import json
 import logging
+import signal
+import sys
 from pathlib import Path
 from typing import List, Optional, Tuple, Dict
 
@@ -20,7 +22,8 @@ from utrr.dram.utils import (
 )
 from utrr.dsl.compile import compile_code
 from utrr.pipeline.experiment_result_dir import ExperimentResultDir
-from utrr.pipeline.pipeline import Pipeline
+from utrr.pipeline.prefetch_runner import PrefetchRunner, RunSpec, run_sequential
+from utrr.pipeline.result_store import ColumnarResultWriter, ResultIndex
 from utrr.pipeline.stage.align_mod_refresh import AlignModRefresh
 from utrr.pipeline.stage.annotate_index_not_bitflipped import AnnotateIndexNotBitflipped
 from utrr.pipeline.stage.bitflip_check_dram_address import BitflipCheckDramAddress
@@ -28,11 +31,13 @@ from utrr.pipeline.stage.disable_refresh_stage import DisableRefresh
 from utrr.pipeline.stage.emit_refresh_counter import EmitRefreshCounter
 from utrr.pipeline.stage.enable_refresh_stage import EnableRefresh
 from utrr.pipeline.stage.execute_payload import ExecutePayload
+from utrr.pipeline.stage.export_columnar import ExportColumnar
 from utrr.pipeline.stage.export_pipe_context import ExportPipeContext
 from utrr.pipeline.stage.issue_random_refresh import IssueRandomRefresh
 from utrr.pipeline.stage.no_bitflip_check_dram_address import NoBitflipCheckDramAddress
 from utrr.pipeline.stage.precharge_all import PrechargeAll
 from utrr.pipeline.stage.reset_pipe_ctx import ResetPipelineContext
+from utrr.pipeline.stage.stage import Stage
 from utrr.pipeline.stage.wait_until_elapsed_stage import WaitUntilElapsed
 from utrr.pipeline.stage.write_dram_address_dma import WriteDramAddressDma
 from utrr.scripts.args_utils import convert_byte_to_32bit_pattern, load_pyram_program
@@ -176,6 +181,25 @@ def parse_args() -> argparse.Namespace:
         default=100,
         help="Number of decoy rows to generate (default: 100).",
     )
+    parser.add_argument(
+        "--result-format",
+        type=str,
+        choices=["arrow", "jsonl", "both"],
+        default="jsonl",
+        help=(
+            "Format of the per-run results: JSON lines (results.jsonl), columnar Arrow "
+            "IPC files indexed by the experiment parameters, or both (default: jsonl)."
+        ),
+    )
+    parser.add_argument(
+        "--prefetch-depth",
+        type=int,
+        default=2,
+        help=(
+            "Number of runs prepared ahead and results decoded behind the run executing "
+            "on the device; 0 runs everything strictly in order (default: 2)."
+        ),
+    )
     parser.add_argument(
         "--template-var",
         type=str,
@@ -327,7 +351,7 @@ def create_stages_disable_refresh_all_runs(
     modulus: Optional[int],
     mod_value: Optional[int],
     check_bitflips: bool,
-    export_path: Path,
+    export_stages: List[Stage],
 ):
     flush_rows = [DramAddress(bank=0, row=780), DramAddress(bank=0, row=800)]
 
@@ -361,7 +385,7 @@ def create_stages_disable_refresh_all_runs(
         bitflip_check_addresses, pattern_32bit, check_bitflips, flush_rows
     )
     main_stages.extend(bitflip_stages)
-    main_stages.append(ExportPipeContext(filepath=export_path))
+    main_stages.extend(export_stages)
 
     return prologue + main_stages
 
@@ -376,7 +400,7 @@ def create_stages_enable_refresh_between_runs(
     modulus: Optional[int],
     mod_value: Optional[int],
     check_bitflips: bool,
-    export_path: Path,
+    export_stages: List[Stage],
 ):
     flush_rows = [DramAddress(bank=0, row=780), DramAddress(bank=0, row=800)]
 
@@ -420,7 +444,7 @@ def create_stages_enable_refresh_between_runs(
         bitflip_check_addresses, pattern_32bit, check_bitflips, flush_rows
     )
     main_stages.extend(bitflip_stages)
-    main_stages.append(ExportPipeContext(filepath=export_path))
+    main_stages.extend(export_stages)
 
     return main_stages
 
@@ -486,29 +510,52 @@ def main():
     controller = DramController(dram_row_mapping=row_mapping)
     pbar = tqdm(total=total_experiments, desc="Overall experiment progress")
 
-    for current_modulo in modulo_values:
-        mod_label = (
-            f"modulo_{current_modulo}" if current_modulo is not None else "no_modulo"
-        )
-        pbar.set_description(f"Testing {mod_label}")
-
-        run_result_dir = base_result_dir.get_subdirectory(mod_label)
+    result_index = ResultIndex(base_result_dir.path)
+    writers = []
+    template_params = {f"var_{key}": value for key, value in template_vars.items()}
 
-        if args.disable_refresh_for_all_runs:
-            stages = create_stages_disable_refresh_all_runs(
-                payloads=payloads,
-                execute_payload=args.execute_payload,
-                bitflip_check_addresses=bitflip_check_addresses,
-                pattern_32bit=pattern_32bit,
-                pre_wait_ms=args.pre_wait_ms,
-                wait_ms=args.wait_ms,
-                modulus=args.modulus,
-                mod_value=current_modulo,
-                check_bitflips=args.check_bitflips,
-                export_path=run_result_dir.get_result_export_path(),
+    def create_export_stages(run_result_dir, mod_value) -> List[Stage]:
+        export_stages = []
+        if args.result_format in ("jsonl", "both"):
+            export_stages.append(
+                ExportPipeContext(filepath=run_result_dir.get_result_export_path())
             )
-        else:
-            stages = create_stages_enable_refresh_between_runs(
+        if args.result_format in ("arrow", "both"):
+            writer = ColumnarResultWriter(
+                results_path=run_result_dir.get_columnar_results_path(),
+                index=result_index,
+                params={
+                    "modulus": args.modulus,
+                    "modulo": mod_value,
+                    "retention_pattern": args.retention_pattern,
+                    "num_rows": args.num_rows,
+                    "min_row_distance": args.min_row_distance,
+                    "pre_wait_ms": args.pre_wait_ms,
+                    "wait_ms": args.wait_ms,
+                    "execute_payload": args.execute_payload,
+                    "check_bitflips": args.check_bitflips,
+                    "disable_refresh_for_all_runs": args.disable_refresh_for_all_runs,
+                    "program": ",".join(str(p) for p in args.program),
+                    **template_params,
+                },
+            )
+            writers.append(writer)
+            export_stages.append(ExportColumnar(writer))
+        return export_stages
+
+    def run_specs():
+        # Evaluated lazily by the prefetching thread, one run ahead of the device
+        for current_modulo in modulo_values:
+            mod_label = (
+                f"modulo_{current_modulo}" if current_modulo is not None else "no_modulo"
+            )
+            run_result_dir = base_result_dir.get_subdirectory(mod_label)
+
+            if args.disable_refresh_for_all_runs:
+                create_stages = create_stages_disable_refresh_all_runs
+            else:
+                create_stages = create_stages_enable_refresh_between_runs
+            stages = create_stages(
                 payloads=payloads,
                 execute_payload=args.execute_payload,
                 bitflip_check_addresses=bitflip_check_addresses,
@@ -518,16 +565,31 @@ def main():
                 modulus=args.modulus,
                 mod_value=current_modulo,
                 check_bitflips=args.check_bitflips,
-                export_path=run_result_dir.get_result_export_path(),
+                export_stages=create_export_stages(run_result_dir, current_modulo),
             )
 
-        for run in range(args.num_runs):
-            pbar.set_postfix({"modulo run": f"{run + 1}/{args.num_runs}"})
-            pipe = Pipeline(stages=stages)
-            pipe.run_with_new_ctxt(controller=controller, use_progress_bar=False)
-            pbar.update(1)
+            for run in range(args.num_runs):
+                yield RunSpec(label=f"{mod_label} run {run + 1}/{args.num_runs}", stages=stages)
+
+    def on_run_done(spec: RunSpec):
+        pbar.set_description(f"Testing {spec.label}")
+        pbar.update(1)
+
+    # SIGTERM unwinds like Ctrl-C, so the buffered results below get written
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(128 + signum))
+    try:
+        if args.prefetch_depth > 0:
+            runner = PrefetchRunner(controller=controller, depth=args.prefetch_depth)
+            report = runner.run(run_specs(), on_run_done=on_run_done)
+        else:
+            report = run_sequential(controller, run_specs(), on_run_done=on_run_done)
+    finally:
+        # Keep the runs buffered so far on Ctrl-C or a failing run
+        for writer in writers:
+            writer.flush()
 
     pbar.close()
+    logger.info(f"Host/FPGA overlap: {report}")
     logger.info("All experiments completed.")
 
 
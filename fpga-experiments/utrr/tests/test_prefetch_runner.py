@@ -0,0 +1,258 @@
+import threading
+import time
+from types import SimpleNamespace
+
+import pytest
+
+from rowhammer_tester.gateware.payload_executor import Encoder, OpCode
+from utrr.dram.payload_banks import PayloadBanks
+from utrr.pipeline.prefetch_runner import (
+    PrefetchRunner,
+    RunSpec,
+    run_sequential,
+    split_host_tail,
+)
+from utrr.pipeline.stage.execute_payload import ExecutePayload
+from utrr.pipeline.stage.stage import Stage
+
+
+class FakeController:
+    """Stands in for DramController; records the order of device accesses."""
+
+    def __init__(self):
+        self.log = []
+        self.lock = threading.Lock()
+
+    def access(self, what):
+        with self.lock:
+            self.log.append(what)
+
+
+class DeviceStage(Stage):
+    def __init__(self, run, name, duration=0.0):
+        self.run = run
+        self.name = name
+        self.duration = duration
+        self.prepared_on = None
+
+    def setup(self, controller):
+        pass
+
+    def prepare(self, controller):
+        self.prepared_on = threading.current_thread().name
+        time.sleep(self.duration)
+
+    def execute(self, controller, pipe_ctxt):
+        controller.access((self.run, self.name))
+        time.sleep(self.duration)
+        return pipe_ctxt.add_data(self.name, self.run)
+
+
+class HostStage(Stage):
+    host_only = True
+
+    def __init__(self, run, results, duration=0.0, fail=False):
+        self.run = run
+        self.results = results
+        self.duration = duration
+        self.fail = fail
+
+    def setup(self, controller):
+        pass
+
+    def execute(self, controller, pipe_ctxt):
+        if self.fail:
+            raise RuntimeError("decode failed")
+        time.sleep(self.duration)
+        self.results.append((self.run, dict(pipe_ctxt.data)))
+        return pipe_ctxt
+
+
+def make_specs(n, results, device_s=0.0, host_s=0.0):
+    for run in range(n):
+        yield RunSpec(
+            label=f"run {run}",
+            stages=[
+                DeviceStage(run, "write"),
+                DeviceStage(run, "execute", duration=device_s),
+                DeviceStage(run, "check"),
+                HostStage(run, results, duration=host_s),
+            ],
+        )
+
+
+def test_split_host_tail():
+    stages = [DeviceStage(0, "a"), HostStage(0, []), DeviceStage(0, "b"), HostStage(0, [])]
+    device, host = split_host_tail(stages)
+    assert device == stages[:3]
+    assert host == stages[3:]
+
+
+def test_device_accesses_stay_in_run_order():
+    controller = FakeController()
+    results = []
+    done = []
+
+    report = PrefetchRunner(controller, depth=2).run(
+        make_specs(6, results), on_run_done=lambda spec: done.append(spec.label)
+    )
+
+    assert controller.log == [
+        (run, name) for run in range(6) for name in ("write", "execute", "check")
+    ]
+    assert [run for run, _ in results] == list(range(6))
+    assert results[3][1] == {"write": 3, "execute": 3, "check": 3}
+    assert done == [f"run {run}" for run in range(6)]
+    assert report.runs == 6
+
+
+def test_host_work_overlaps_device_work():
+    controller = FakeController()
+    results = []
+
+    sequential = run_sequential(controller, make_specs(4, results, device_s=0.05, host_s=0.05))
+    assert sequential.overlap_s == pytest.approx(0.0, abs=1e-3)
+
+    prefetched = PrefetchRunner(controller, depth=2).run(
+        make_specs(4, results, device_s=0.05, host_s=0.05)
+    )
+    assert prefetched.overlap_s > 0.1
+    assert prefetched.wall_s < sequential.wall_s
+
+
+def test_prepare_runs_ahead_on_prefetch_thread():
+    controller = FakeController()
+    specs = list(make_specs(3, []))
+
+    PrefetchRunner(controller, depth=1).run(iter(specs))
+
+    assert all(spec.stages[0].prepared_on == "utrr-prepare" for spec in specs)
+
+
+def test_errors_are_propagated():
+    controller = FakeController()
+    specs = [
+        RunSpec(label="bad", stages=[DeviceStage(0, "write"), HostStage(0, [], fail=True)]),
+        *make_specs(5, []),
+    ]
+
+    with pytest.raises(RuntimeError, match="decode failed"):
+        PrefetchRunner(controller, depth=1).run(specs)
+
+
+class FakeCSR:
+    def __init__(self, on_write=None, on_read=None):
+        self.value = 0
+        self.on_write = on_write
+        self.on_read = on_read
+
+    def write(self, value):
+        self.value = value
+        if self.on_write is not None:
+            self.on_write(value)
+
+    def read(self):
+        return self.on_read() if self.on_read is not None else self.value
+
+
+class FakeBankedClient:
+    """Stands in for the RemoteClient of a SoC built with `--payload-banks 2`."""
+
+    def __init__(self, busy_polls=3):
+        self.mems = SimpleNamespace(
+            payload=SimpleNamespace(base=0x30000000, size=0x8000),
+            payload1=SimpleNamespace(base=0x30800000, size=0x8000),
+        )
+        self.regs = SimpleNamespace(
+            payload_executor_bank=FakeCSR(),
+            payload_executor_start=FakeCSR(on_write=self.start),
+            payload_executor_status=FakeCSR(on_read=self.status),
+        )
+        self.memory = {}
+        self.executed = []
+        self.uploads_while_busy = 0
+        self.busy_polls = busy_polls
+        self.busy = 0
+
+    def write(self, addr, data):
+        if self.busy:
+            self.uploads_while_busy += 1
+        for i, word in enumerate(data):
+            self.memory[addr + 4 * i] = word
+
+    def start(self, _):
+        bank = self.regs.payload_executor_bank.value
+        addr = self.mems.payload1.base if bank else self.mems.payload.base
+        words = []
+        while self.memory.get(addr, 0) != 0:  # up to STOP
+            words.append(self.memory[addr])
+            addr += 4
+        self.executed.append(words + [0])
+        self.busy = self.busy_polls
+
+    def status(self):
+        if self.busy:
+            self.busy -= 1
+            return 0
+        return 1
+
+
+class BankedController(FakeController):
+    """FakeController with the payload path of DramController on two banks."""
+
+    def __init__(self, client):
+        super().__init__()
+        self.encoder = Encoder(bankbits=3)
+        self.payload_banks = PayloadBanks(client)
+
+    def encode_payload(self, payload):
+        return self.encoder(payload)
+
+    def stage_payload(self, encoded):
+        self.payload_banks.stage(encoded)
+
+    def execute_encoded_payload(self, encoded, verbose=True):
+        self.payload_banks.execute(encoded, verbose)
+
+
+def hammer_payload(encoder, row):
+    return [
+        encoder.Instruction(OpCode.ACT, timeslice=5, address=encoder.address(bank=1, row=row)),
+        encoder.Instruction(OpCode.NOOP, timeslice=row + 1),
+        encoder.Instruction(OpCode.NOOP, timeslice=0),  # STOP
+    ]
+
+
+def test_two_payload_banks_with_prefetch():
+    client = FakeBankedClient()
+    controller = BankedController(client)
+    # Consecutive runs share payloads, so some need no upload at all
+    payloads = [hammer_payload(controller.encoder, run // 2) for run in range(60)]
+    specs = [
+        RunSpec(label=f"run {run}", stages=[ExecutePayload(p)]) for run, p in enumerate(payloads)
+    ]
+
+    report = PrefetchRunner(controller, depth=3).run(specs)
+
+    assert report.runs == len(payloads)
+    assert client.executed == [controller.encoder(p) for p in payloads]
+    assert client.uploads_while_busy > 0
+
+
+def test_payload_banks_with_stages_shared_across_runs():
+    # exec_utrr yields the same stage list for every run of a spec
+    client = FakeBankedClient()
+    controller = BankedController(client)
+    payloads = [hammer_payload(controller.encoder, row) for row in range(3)]
+    stages = [ExecutePayload(p) for p in payloads]
+    runs = 20
+    specs = [RunSpec(label=f"run {run}", stages=stages) for run in range(runs)]
+
+    report = PrefetchRunner(controller, depth=2).run(specs)
+
+    assert report.runs == runs
+    assert client.executed == [controller.encoder(p) for p in payloads] * runs
+    # With three payloads on two banks every payload after the first needs an
+    # upload; at least the second and third of every run are staged in time to
+    # go to the idle bank while its predecessor runs
+    assert client.uploads_while_busy >= 2 * runs
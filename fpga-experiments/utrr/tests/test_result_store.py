@@ -0,0 +1,98 @@
+import json
+
+import pyarrow as pa
+
+from utrr.pipeline.result_store import ColumnarResultWriter, INDEX_FILE_NAME, ResultIndex
+
+
+def make_record(run):
+    return {
+        "refresh_counter_before": 1000 + run,
+        "refresh_counter_after": 1128 + run,
+        "addresses_not_bitflipped": [{"bank": 0, "row": 10 + run, "row_hex": hex(10 + run)}],
+        "indices_not_bitflipped": [run, run + 1],
+    }
+
+
+def read_parts(path):
+    parts = sorted(path.glob("*.arrow"))
+    tables = [pa.ipc.open_file(str(p)).read_all() for p in parts]
+    return pa.concat_tables(tables, promote_options="permissive"), len(parts)
+
+
+def test_writer_batches_runs_and_updates_index(tmp_path):
+    index = ResultIndex(tmp_path)
+    writers = {
+        modulo: ColumnarResultWriter(
+            tmp_path / f"modulo_{modulo}" / "results",
+            index,
+            params={"modulus": 4, "modulo": modulo},
+            batch_runs=4,
+        )
+        for modulo in range(2)
+    }
+    for run in range(10):
+        for writer in writers.values():
+            writer.append(make_record(run))
+    for writer in writers.values():
+        writer.flush()
+
+    table, num_parts = read_parts(tmp_path / "modulo_1" / "results")
+    assert num_parts == 3
+    assert table.column("run").to_pylist() == list(range(10))
+    assert table.column("refresh_counter_before").type == pa.int64()
+    assert table.column("indices_not_bitflipped").to_pylist()[3] == [3, 4]
+    assert table.column("addresses_not_bitflipped").to_pylist()[2] == [{"bank": 0, "row": 12}]
+
+    with (tmp_path / INDEX_FILE_NAME).open() as f:
+        entries = {e["path"]: e for e in json.load(f)["entries"]}
+    assert set(entries) == {"modulo_0/results", "modulo_1/results"}
+    assert entries["modulo_1/results"]["params"] == {"modulus": 4, "modulo": 1}
+    assert entries["modulo_1/results"]["runs"] == 10
+
+
+def test_index_survives_reopen(tmp_path):
+    writer = ColumnarResultWriter(tmp_path / "no_modulo" / "results", ResultIndex(tmp_path), {})
+    writer.append({"refresh_counter_before": 1, "indices_not_bitflipped": []})
+    writer.flush()
+
+    reopened = ResultIndex(tmp_path)
+    reopened.update(tmp_path / "modulo_3" / "results", {"modulo": 3}, runs=0, columns=[])
+    assert set(ResultIndex(tmp_path).entries) == {"no_modulo/results", "modulo_3/results"}
+
+
+def test_empty_first_lists_keep_types(tmp_path):
+    writer = ColumnarResultWriter(tmp_path / "results", ResultIndex(tmp_path), {}, batch_runs=1)
+    writer.append({"indices_not_bitflipped": [], "custom": 1.5})
+    writer.append({"indices_not_bitflipped": [7], "custom": 2.5})
+
+    table, _ = read_parts(tmp_path / "results")
+    assert table.column("indices_not_bitflipped").to_pylist() == [[], [7]]
+    assert table.column("custom").type == pa.float64()
+
+
+def test_schema_evolves_across_parts(tmp_path):
+    writer = ColumnarResultWriter(tmp_path / "results", ResultIndex(tmp_path), {}, batch_runs=2)
+    writer.append({"custom": None})
+    writer.append({"custom": None})
+    writer.append({"custom": 3, "late": "x"})
+    writer.append({"custom": 4.5})
+    writer.flush()
+
+    table, num_parts = read_parts(tmp_path / "results")
+    assert num_parts == 2
+    assert table.column("custom").to_pylist() == [None, None, 3.0, 4.5]
+    assert table.column("late").to_pylist() == [None, None, "x", None]
+    with (tmp_path / INDEX_FILE_NAME).open() as f:
+        assert json.load(f)["entries"][0]["columns"] == ["run", "custom", "late"]
+
+
+def test_flushes_after_max_buffer_time(tmp_path):
+    writer = ColumnarResultWriter(
+        tmp_path / "results", ResultIndex(tmp_path), {}, batch_runs=100, max_buffer_s=0.0
+    )
+    writer.append({"refresh_counter_before": 1})
+
+    table, num_parts = read_parts(tmp_path / "results")
+    assert num_parts == 1
+    assert table.num_rows == 1
@@ -0,0 +1,395 @@
+#!/usr/bin/env python3
+"""
+Fits a TRR sampler model to uTRR experiment results.
+
+The uTRR sampling experiments hammer a different aggressor in every tREFI of
+a run, each next to a retention-weak victim, and record which victims did
+*not* flip (`indices_not_bitflipped`), i.e. which aggressors TRR refreshed
+the neighbours of. Index `i` of a run is the aggressor of the refresh
+interval ending with refresh `refresh_counter_before + i`.
+
+Sampler model (all refresh positions are REF counts modulo `modulus`):
+
+  - every `sampling_period` REFs (at `c % sampling_period == sampling_phase`)
+    the aggressor of the ending interval is inserted into a table of
+    `table_size` entries
+  - a full table makes room according to `replacement`:
+      fifo        the oldest entry is evicted
+      keep_first  the new aggressor is dropped
+      random      a random entry is evicted
+  - once per `modulus` REFs (at `c % modulus == trr_phase`), after sampling,
+    the neighbours of all table entries are refreshed and the table is
+    cleared
+  - the table starts empty at the beginning of each run, and aggressors still
+    in the table at the end of a run are not refreshed
+  - a refreshed victim still flips with probability `p_miss`, a victim that
+    was not refreshed survives with probability `p_false`
+
+The FPGA refresh counter and the DIMM's internal counter differ by an unknown
+constant, so the phases are only meaningful for the experiment setup they
+were fitted on.
+
+Fitting aggregates all runs into per-(counter position, index) counts, so the
+likelihood of a model is a dot product independent of the number of runs.
+All sampling phases of a candidate are evaluated at once as a circular
+cross-correlation (FFT) over the counter position. The best candidates are
+then refined by fitting `p_miss` and `p_false` with EM.
+
+Output is a JSON model config:
+
+    {
+        "model": "trr_sampler", "version": 1,
+        "modulus": 128, "sampling_period": 4, "sampling_phase": 1, "trr_phase": 37,
+        "table_size": 1, "replacement": "fifo", "p_miss": 0.01, "p_false": 0.002,
+        "fit": {"log_likelihood": ..., "runs": ..., "num_intervals": ..., "candidates": [...]}
+    }
+
+which TrrSamplerModel.load() reads back, e.g. for a simulated DRAM backend
+(TrrSamplerModel.refreshed() / .simulate()).
+
+Example:
+
+    ./trr_model.py zooming/trr_sampling_skh304/20250604_203217_tREFIS=128 \\
+        --moduli 128 256 --output skh304_trr.json
+"""
+import argparse
+import itertools
+import json
+import time
+from dataclasses import asdict, dataclass, field
+from typing import Any, Dict, List, Optional, Sequence
+
+import numpy as np
+import pyarrow as pa
+import pyarrow.compute as pc
+
+from utrr_results import load_results
+
+MODEL_NAME = "trr_sampler"
+MODEL_VERSION = 1
+REPLACEMENT_POLICIES = ("fifo", "keep_first", "random")
+
+# Emission probabilities used while searching the structural parameters
+SEARCH_P_MISS = 0.05
+SEARCH_P_FALSE = 0.05
+EPS = 1e-9
+
+
+def _protection(c0, idx, modulus, period, trr_phase, table_size, replacement):
+    """
+    Probability that the aggressor of interval `idx` of a run starting at
+    counter `c0` gets its neighbours refreshed, for sampling phase 0 (shift
+    `c0` to account for other phases). Arrays broadcast against each other.
+    """
+    c = c0 + idx
+    sampled = c % period == 0
+    # Next TRR at or after c, and whether it still happens within the run
+    trr_at = c + (trr_phase - c) % modulus
+    in_run = trr_at - c0 < idx.shape[-1]
+    # Last TRR strictly before c (or the start of the run)
+    prev_trr = c - 1 - (c - 1 - trr_phase) % modulus
+    window_start = np.maximum(prev_trr, c0 - 1)
+    # Insertions since the table was last cleared, and until the next TRR
+    n_before = (c - 1) // period - window_start // period
+    n_after = trr_at // period - c // period
+
+    if replacement == "fifo":
+        kept = n_after < table_size
+    elif replacement == "keep_first":
+        kept = n_before < table_size
+    elif replacement == "random":
+        evictions = np.maximum(0, n_after - np.maximum(0, table_size - n_before - 1))
+        kept = (1.0 - 1.0 / table_size) ** evictions
+    else:
+        raise ValueError(f"Unknown replacement policy: {replacement}")
+    return np.where(sampled & in_run, kept, 0.0).astype(np.float64)
+
+
+@dataclass
+class TrrSamplerModel:
+    modulus: int
+    sampling_period: int
+    sampling_phase: int
+    trr_phase: int
+    table_size: int
+    replacement: str
+    p_miss: float = 0.0
+    p_false: float = 0.0
+    fit: Dict[str, Any] = field(default_factory=dict, compare=False)
+
+    def refreshed(self, refresh_counter: np.ndarray, num_intervals: int) -> np.ndarray:
+        """Probability per run (rows) and interval index (columns) that TRR refreshed the victim."""
+        c0 = (np.asarray(refresh_counter, dtype=np.int64) - self.sampling_phase) % self.modulus
+        return _protection(
+            c0[:, None],
+            np.arange(num_intervals, dtype=np.int64)[None, :],
+            self.modulus,
+            self.sampling_period,
+            (self.trr_phase - self.sampling_phase) % self.modulus,
+            self.table_size,
+            self.replacement,
+        )
+
+    def survival(self, refresh_counter: np.ndarray, num_intervals: int) -> np.ndarray:
+        """Probability that the victim of each interval does not flip."""
+        q = self.refreshed(refresh_counter, num_intervals)
+        return q * (1 - self.p_miss) + (1 - q) * self.p_false
+
+    def simulate(
+        self, refresh_counter: np.ndarray, num_intervals: int, rng=None
+    ) -> List[List[int]]:
+        """`indices_not_bitflipped` of one run per refresh counter value."""
+        rng = np.random.default_rng() if rng is None else rng
+        survived = rng.random((len(refresh_counter), num_intervals)) < self.survival(
+            refresh_counter, num_intervals
+        )
+        return [np.flatnonzero(row).tolist() for row in survived]
+
+    def params(self) -> Dict[str, Any]:
+        return {k: v for k, v in asdict(self).items() if k != "fit"}
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {"model": MODEL_NAME, "version": MODEL_VERSION, **asdict(self)}
+
+    def save(self, path: str):
+        with open(path, "w") as f:
+            json.dump(self.to_dict(), f, indent=4)
+
+    @classmethod
+    def load(cls, path: str) -> "TrrSamplerModel":
+        with open(path) as f:
+            d = json.load(f)
+        if d.pop("model", None) != MODEL_NAME or d.pop("version", None) != MODEL_VERSION:
+            raise ValueError(f"{path} is not a {MODEL_NAME} v{MODEL_VERSION} model")
+        return cls(**d)
+
+    def describe(self) -> str:
+        return (
+            f"modulus={self.modulus} sampling_period={self.sampling_period}"
+            f" sampling_phase={self.sampling_phase} trr_phase={self.trr_phase}"
+            f" table_size={self.table_size} replacement={self.replacement}"
+            f" p_miss={self.p_miss:.4f} p_false={self.p_false:.4f}"
+        )
+
+
+@dataclass
+class Observations:
+    """Runs aggregated by refresh counter position modulo `modulus`."""
+
+    modulus: int
+    num_intervals: int
+    runs: np.ndarray  # (modulus,) runs starting at each counter position
+    survived: np.ndarray  # (modulus, num_intervals) runs in which the victim did not flip
+
+    @property
+    def flipped(self) -> np.ndarray:
+        return self.runs[:, None] - self.survived
+
+    @classmethod
+    def from_runs(
+        cls, refresh_counter: np.ndarray, indices: pa.Array, modulus: int, num_intervals: int
+    ) -> "Observations":
+        c0 = np.asarray(refresh_counter, dtype=np.int64) % modulus
+        runs = np.bincount(c0, minlength=modulus).astype(np.float64)
+
+        flat = pc.list_flatten(indices).to_numpy(zero_copy_only=False).astype(np.int64)
+        parents = pc.list_parent_indices(indices).to_numpy(zero_copy_only=False)
+        keep = flat < num_intervals
+        cells = c0[parents[keep]] * num_intervals + flat[keep]
+        survived = np.bincount(cells, minlength=modulus * num_intervals).astype(np.float64)
+        return cls(modulus, num_intervals, runs, survived.reshape(modulus, num_intervals))
+
+    def log_likelihood(self, survival: np.ndarray) -> float:
+        p = np.clip(survival, EPS, 1 - EPS)
+        return float(np.sum(self.survived * np.log(p) + self.flipped * np.log1p(-p)))
+
+
+def _all_phase_log_likelihoods(obs: Observations, survival: np.ndarray) -> np.ndarray:
+    """
+    Log-likelihood of `survival` (batch, modulus, num_intervals), given for
+    runs starting at counter position 0..modulus-1 with sampling phase 0, for
+    every shift of the counter position. Result has shape (batch, modulus).
+    """
+    p = np.clip(survival, EPS, 1 - EPS)
+    n = obs.modulus
+    log_p = np.fft.rfft(np.log(p), axis=1)
+    log_q = np.fft.rfft(np.log1p(-p), axis=1)
+    survived = np.fft.rfft(obs.survived, axis=0)[None]
+    flipped = np.fft.rfft(obs.flipped, axis=0)[None]
+    spectrum = np.sum(np.conj(log_p) * survived + np.conj(log_q) * flipped, axis=2)
+    return np.fft.irfft(spectrum, n=n, axis=1)
+
+
+def _fit_emission(obs: Observations, q: np.ndarray, iterations: int = 100):
+    """EM estimate of (p_miss, p_false) given refresh probabilities q per cell."""
+    p_miss, p_false = SEARCH_P_MISS, SEARCH_P_FALSE
+    n1, n0 = obs.survived, obs.flipped
+    for _ in range(iterations):
+        s1 = q * (1 - p_miss) + (1 - q) * p_false
+        s0 = q * p_miss + (1 - q) * (1 - p_false)
+        # Posterior probability of "refreshed" for surviving and flipped victims
+        r1 = np.divide(q * (1 - p_miss), s1, out=np.zeros_like(q), where=s1 > 0)
+        r0 = np.divide(q * p_miss, s0, out=np.zeros_like(q), where=s0 > 0)
+        refreshed = np.sum(n1 * r1 + n0 * r0)
+        not_refreshed = np.sum(n1 * (1 - r1) + n0 * (1 - r0))
+        p_miss = float(np.sum(n0 * r0) / refreshed) if refreshed > 0 else 0.0
+        p_false = float(np.sum(n1 * (1 - r1)) / not_refreshed) if not_refreshed > 0 else 0.0
+    return p_miss, p_false
+
+
+def fit(
+    refresh_counter: np.ndarray,
+    indices: pa.Array,
+    num_intervals: int,
+    moduli: Sequence[int],
+    sampling_periods: Optional[Sequence[int]] = None,
+    table_sizes: Sequence[int] = range(1, 9),
+    replacements: Sequence[str] = REPLACEMENT_POLICIES,
+    top: int = 20,
+    phase_batch: int = 32,
+    verbose: bool = False,
+) -> List[TrrSamplerModel]:
+    """Returns the `top` models, best first. Sampling periods default to all powers of two."""
+    candidates = []
+    observations = {}
+    start = time.time()
+    idx = np.arange(num_intervals, dtype=np.int64)[None, None, :]
+
+    for modulus in moduli:
+        obs = observations[modulus] = Observations.from_runs(
+            refresh_counter, indices, modulus, num_intervals
+        )
+        c0 = np.arange(modulus, dtype=np.int64)[None, :, None]
+        periods = sampling_periods or [1 << i for i in range(modulus.bit_length())]
+
+        grid = itertools.product(periods, table_sizes, replacements)
+        for period, table_size, replacement in grid:
+            if modulus % period != 0:
+                continue
+            for first in range(0, period, phase_batch):
+                # TRR phase relative to the sampling phase; the counter shift
+                # covers all absolute sampling/TRR phase combinations
+                rel = np.arange(first, min(period, first + phase_batch), dtype=np.int64)
+                rel = rel[:, None, None]
+                q = _protection(c0, idx, modulus, period, rel, table_size, replacement)
+                survival = q * (1 - SEARCH_P_MISS) + (1 - q) * SEARCH_P_FALSE
+                ll = _all_phase_log_likelihoods(obs, survival)
+                best = np.unravel_index(np.argsort(ll, axis=None)[-top:], ll.shape)
+                for r, shift in zip(*best):
+                    candidates.append(
+                        (
+                            float(ll[r, shift]),
+                            TrrSamplerModel(
+                                modulus=modulus,
+                                sampling_period=period,
+                                sampling_phase=int(shift) % period,
+                                trr_phase=int(first + r + shift) % modulus,
+                                table_size=table_size,
+                                replacement=replacement,
+                            ),
+                        )
+                    )
+            candidates = sorted(candidates, key=lambda c: -c[0])[: 4 * top]
+        if verbose:
+            print(f"modulus {modulus}: searched in {time.time() - start:.1f} s")
+
+    # Refine the emission probabilities of the best structural candidates
+    refined = []
+    seen = set()
+    for _, model in candidates:
+        key = tuple(model.params().values())
+        if key in seen:
+            continue
+        seen.add(key)
+        obs = observations[model.modulus]
+        positions = np.arange(model.modulus)
+        model.p_miss, model.p_false = _fit_emission(obs, model.refreshed(positions, num_intervals))
+        model.fit = {"log_likelihood": obs.log_likelihood(model.survival(positions, num_intervals))}
+        refined.append(model)
+
+    refined.sort(key=lambda m: -m.fit["log_likelihood"])
+    return refined[:top]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fit a TRR sampler model to uTRR results.")
+    parser.add_argument("base_dirs", nargs="+", help="Experiment directories (with args.json)")
+    parser.add_argument(
+        "--moduli", type=int, nargs="+", required=True, help="Refresh-counter moduli to try"
+    )
+    parser.add_argument("--sampling-periods", type=int, nargs="+", help="Default: powers of two")
+    parser.add_argument("--table-sizes", type=int, nargs="+", default=list(range(1, 9)))
+    parser.add_argument(
+        "--replacement", nargs="+", default=list(REPLACEMENT_POLICIES), choices=REPLACEMENT_POLICIES
+    )
+    parser.add_argument("--num-intervals", type=int, help="Default: num_rows of the experiment")
+    parser.add_argument(
+        "--filter", nargs="+", default=[], metavar="KEY=VALUE",
+        help="Only use result directories with matching parameters (VALUE parsed as JSON)",
+    )
+    parser.add_argument("--top", type=int, default=10, help="Number of candidates to report")
+    parser.add_argument("--output", "-o", help="Write the best model config to this file")
+    args = parser.parse_args()
+
+    filters = {}
+    for item in args.filter:
+        key, value = item.split("=", 1)
+        try:
+            filters[key] = json.loads(value)
+        except json.JSONDecodeError:
+            filters[key] = value
+
+    columns = ["refresh_counter_before", "indices_not_bitflipped"]
+    tables = [load_results(d, columns=columns, **filters) for d in args.base_dirs]
+    tables = [
+        t.select(columns + (["num_rows"] if "num_rows" in t.column_names else []))
+        for t in tables
+        if t.num_rows
+    ]
+    if not tables:
+        parser.error("No results found")
+    runs = pa.concat_tables(tables, promote_options="default")
+
+    num_intervals = args.num_intervals
+    if num_intervals is None:
+        if "num_rows" in runs.column_names and runs.column("num_rows").null_count == 0:
+            num_intervals = int(pc.max(runs.column("num_rows")).as_py())
+        else:
+            flat = pc.list_flatten(runs.column("indices_not_bitflipped"))
+            num_intervals = int(pc.max(flat).as_py()) + 1
+
+    refresh_counter = runs.column("refresh_counter_before").to_numpy()
+    indices = runs.column("indices_not_bitflipped").combine_chunks()
+    print(f"{runs.num_rows} runs, {num_intervals} intervals per run")
+
+    start = time.time()
+    models = fit(
+        refresh_counter,
+        indices,
+        num_intervals,
+        moduli=args.moduli,
+        sampling_periods=args.sampling_periods,
+        table_sizes=args.table_sizes,
+        replacements=args.replacement,
+        top=args.top,
+        verbose=True,
+    )
+    print(f"Fitted in {time.time() - start:.1f} s")
+    for model in models:
+        print(f"  ll={model.fit['log_likelihood']:14.2f}  {model.describe()}")
+
+    if args.output:
+        best = models[0]
+        best.fit.update(
+            runs=runs.num_rows,
+            num_intervals=num_intervals,
+            sources=args.base_dirs,
+            filters=filters,
+            candidates=[dict(m.params(), **m.fit) for m in models[1:]],
+        )
+        best.save(args.output)
+        print(f"Written {args.output}")
+
+
+if __name__ == "__main__":
+    main()
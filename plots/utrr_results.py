@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+Loader for uTRR experiment results written by fpga-experiments/utrr/scripts/exec_utrr.py.
+
+Experiments recorded with `--result-format arrow` are read through their
+`results_index.json`, so only the result files matching the requested
+parameters are opened. Older experiments that only contain `results.jsonl`
+files are parsed instead, with their parameters taken from `args.json`.
+
+Example: how often each row survived per modulo value
+
+    df = load_results_df("experiment", columns=["indices_not_bitflipped"], modulus=128)
+    df = df.explode("indices_not_bitflipped")
+    survived = df.groupby(["modulo", "indices_not_bitflipped"]).size() / df["run"].nunique()
+"""
+import argparse
+import json
+import os
+from typing import Any, Dict, Iterable, List, Optional
+
+import pyarrow as pa
+import pyarrow.compute as pc
+
+INDEX_FILE_NAME = "results_index.json"
+
+
+def _matches(params: Dict[str, Any], filters: Dict[str, Any]) -> bool:
+    for key, wanted in filters.items():
+        value = params.get(key)
+        if isinstance(wanted, (list, tuple, set)):
+            if value not in wanted:
+                return False
+        elif value != wanted:
+            return False
+    return True
+
+
+def _legacy_entries(base_dir: str) -> List[Dict[str, Any]]:
+    """Index entries for experiments that only have results.jsonl files."""
+    entries = []
+    for root, _, files in os.walk(base_dir):
+        if "results.jsonl" not in files:
+            continue
+        params = {}
+        args_path = os.path.join(os.path.dirname(root), "args.json")
+        if os.path.isfile(args_path):
+            with open(args_path) as f:
+                args = json.load(f)
+            params = {key: value for key, value in args.items() if not isinstance(value, (list, dict))}
+            params["program"] = ",".join(args.get("program") or [])
+        subdir = os.path.basename(root)
+        params["modulo"] = int(subdir[len("modulo_"):]) if subdir.startswith("modulo_") else None
+        entries.append(
+            {"path": os.path.relpath(os.path.join(root, "results.jsonl"), base_dir), "params": params}
+        )
+    return sorted(entries, key=lambda e: e["path"])
+
+
+def load_index(base_dir: str) -> List[Dict[str, Any]]:
+    index_path = os.path.join(base_dir, INDEX_FILE_NAME)
+    if os.path.isfile(index_path):
+        with open(index_path) as f:
+            return json.load(f)["entries"]
+    return _legacy_entries(base_dir)
+
+
+def _read_arrow(path: str) -> pa.Table:
+    parts = sorted(f for f in os.listdir(path) if f.endswith(".arrow"))
+    tables = [pa.ipc.open_file(os.path.join(path, part)).read_all() for part in parts]
+    return pa.concat_tables(tables, promote_options="permissive") if tables else pa.table({})
+
+
+def _read_jsonl(path: str) -> pa.Table:
+    records = []
+    with open(path) as f:
+        for run, line in enumerate(f):
+            data = json.loads(line)["data"]
+            for key, value in data.items():
+                if isinstance(value, list) and value and isinstance(value[0], dict):
+                    data[key] = [{"bank": v["bank"], "row": v["row"]} for v in value]
+            records.append({"run": run, **data})
+    return pa.Table.from_pylist(records)
+
+
+def load_results(
+    base_dir: str, columns: Optional[Iterable[str]] = None, **filters: Any
+) -> pa.Table:
+    """
+    One row per run of every result directory under `base_dir` whose parameters
+    match `filters` (a value or a list of accepted values per parameter). The
+    parameters are appended as columns, e.g. `modulo`.
+    """
+    columns = list(columns) if columns is not None else None
+    tables = []
+    for entry in load_index(base_dir):
+        params = entry["params"]
+        if not _matches(params, filters):
+            continue
+
+        path = os.path.join(base_dir, entry["path"])
+        table = _read_jsonl(path) if path.endswith(".jsonl") else _read_arrow(path)
+        if columns is not None:
+            table = table.select(["run"] + [c for c in columns if c != "run"])
+        for key, value in params.items():
+            if key not in table.column_names:
+                table = table.append_column(key, pa.array([value] * table.num_rows))
+        table = table.append_column("source", pa.array([entry["path"]] * table.num_rows))
+        tables.append(table)
+
+    if not tables:
+        return pa.table({})
+    return pa.concat_tables(tables, promote_options="permissive")
+
+
+def load_results_df(base_dir: str, columns: Optional[Iterable[str]] = None, **filters: Any):
+    return load_results(base_dir, columns=columns, **filters).to_pandas()
+
+
+def export_jsonl(base_dir: str) -> List[str]:
+    """Writes a results.jsonl next to every Arrow result directory, in the exec_utrr format."""
+    written = []
+    for entry in load_index(base_dir):
+        if entry["path"].endswith(".jsonl"):
+            continue
+        path = os.path.join(base_dir, entry["path"])
+        table = _read_arrow(path)
+        out = os.path.join(os.path.dirname(path), "results.jsonl")
+        data_columns = [c for c in table.column_names if c != "run"]
+        with open(out, "w") as f:
+            for record in table.sort_by("run").select(data_columns).to_pylist():
+                f.write(json.dumps({"data": record}) + "\n")
+        written.append(out)
+    return written
+
+
+def sampled_positions(table: pa.Table, modulus: int) -> List[int]:
+    """(refresh_counter_before + index) % modulus for every non-flipped index of every run."""
+    positions = []
+    for rc_before, indices in zip(
+        table.column("refresh_counter_before").to_pylist(),
+        table.column("indices_not_bitflipped").to_pylist(),
+    ):
+        positions.extend((rc_before + idx) % modulus for idx in indices)
+    return positions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Query uTRR experiment results.")
+    parser.add_argument("base_dir", help="Experiment directory (the one containing args.json)")
+    parser.add_argument("--export-jsonl", action="store_true", help="Write results.jsonl files")
+    parser.add_argument(
+        "--filter",
+        nargs="+",
+        default=[],
+        metavar="KEY=VALUE",
+        help="Only show result directories with matching parameters (VALUE parsed as JSON)",
+    )
+    args = parser.parse_args()
+
+    if args.export_jsonl:
+        for path in export_jsonl(args.base_dir):
+            print(f"Written {path}")
+        return
+
+    filters = {}
+    for item in args.filter:
+        key, value = item.split("=", 1)
+        try:
+            filters[key] = json.loads(value)
+        except json.JSONDecodeError:
+            filters[key] = value
+
+    for entry in load_index(args.base_dir):
+        if _matches(entry["params"], filters):
+            print(entry["path"], json.dumps(entry["params"]))
+
+    table = load_results(args.base_dir, **filters)
+    print(f"{table.num_rows} runs, columns: {', '.join(table.column_names)}")
+    if "modulo" in table.column_names and table.num_rows:
+        counts = pc.value_counts(table.column("modulo"))
+        for item in counts.to_pylist():
+            print(f"  modulo={item['values']}: {item['counts']} runs")
+
+
+if __name__ == "__main__":
+    main()
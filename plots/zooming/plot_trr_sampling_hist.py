@@ -1,5 +1,4 @@
 #!/usr/bin/env python3
-import json
 import os
 from collections import Counter
 import matplotlib.pyplot as plt
@@ -7,6 +6,10 @@ import numpy as np
 import argparse
 
 import plot_settings
+from utrr_results import load_results, sampled_positions
+
+
+RESULT_COLUMNS = ["refresh_counter_before", "indices_not_bitflipped"]
 
 
 def main():
@@ -33,23 +36,14 @@ def main():
 
     # Process each folder
     for trefis, folder in trefis_folders.items():
-        filepath = os.path.join(folder, "no_modulo", "results.jsonl")
+        runs = load_results(folder, columns=RESULT_COLUMNS, modulo=None)
         
-        if not os.path.isfile(filepath):
-            print(f"Warning: File not found: {filepath}")
+        if runs.num_rows == 0:
+            print(f"Warning: No results found in: {folder}")
             continue
 
         # Count how often each row appears across repetitions
-        row_counter = Counter()
-
-        with open(filepath, "r") as file:
-            for line in file:
-                data = json.loads(line)
-                rc_before = data["data"]["refresh_counter_before"]
-                indices = data["data"]["indices_not_bitflipped"]
-                modulus = int(trefis)
-                for idx in indices:
-                    row_counter[(rc_before + idx) % modulus] += 1
+        row_counter = Counter(sampled_positions(runs, int(trefis)))
 
         # Count how many rows had each appearance count
         count_histogram = Counter(row_counter.values())
@@ -106,15 +100,9 @@ def main():
 
     # Compute normalization baseline from 256 tREFIS
     norm_total = 1
-    filepath_256 = os.path.join(trefis_folders["256"], "no_modulo", "results.jsonl")
-    if os.path.isfile(filepath_256):
-        values_256 = []
-        with open(filepath_256, "r") as file:
-            for line in file:
-                data = json.loads(line)
-                rc_before = data["data"]["refresh_counter_before"]
-                indices = data["data"]["indices_not_bitflipped"]
-                values_256.extend((rc_before + idx) % 256 for idx in indices)
+    runs_256 = load_results(trefis_folders["256"], columns=RESULT_COLUMNS, modulo=None)
+    if runs_256.num_rows:
+        values_256 = sampled_positions(runs_256, 256)
         norm_total = sum(Counter(values_256).values()) or 1
 
 
@@ -128,18 +116,12 @@ def main():
         "256": (0.0, 30),
     }
     for ax, trefis in zip(axs2, ["32", "64", "128", "256"]):
-        filepath = os.path.join(trefis_folders[trefis], "no_modulo", "results.jsonl")
-        if not os.path.isfile(filepath):
+        runs = load_results(trefis_folders[trefis], columns=RESULT_COLUMNS, modulo=None)
+        if runs.num_rows == 0:
             continue
 
-        values = []
         modulus = int(trefis)
-        with open(filepath, "r") as file:
-            for line in file:
-                data = json.loads(line)
-                rc_before = data["data"]["refresh_counter_before"]
-                indices = data["data"]["indices_not_bitflipped"]
-                values.extend((rc_before + idx) % modulus for idx in indices)
+        values = sampled_positions(runs, modulus)
 
         counter = Counter(values)
         bin_size = 2
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "pattern.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+/// Row activations a pattern issues, predicted from its schedule: one burst
+/// per tREFI, repeated cyclically, and an ACT for every access whose bank
+/// last had another row open in the same burst (REF closes all rows, so the
+/// first access to a bank in a burst always activates).
+///
+/// A victim row is refreshed once per refresh window; where that refresh
+/// falls relative to the pattern (the refresh counter phase) is unknown, so
+/// the counts are given as min and max over all phases.
+class activation_model {
+    public:
+    /// Activations of a victim's two physical neighbour rows (through
+    /// active_row_remap()) between two refreshes of the victim. `hc` is the
+    /// double-sided hammer count, the smaller of the two neighbours' counts
+    /// (comparable to hc_first of the FPGA experiments), or the single
+    /// neighbour's count if only one is an aggressor.
+    struct victim_acts {
+        uint64_t below_min{}, below_max{};
+        uint64_t above_min{}, above_max{};
+        uint64_t hc_min{}, hc_max{};
+        uint64_t max_per_trefi{}; // most ACTs of one neighbour within a tREFI
+    };
+
+    activation_model(const hammer_pattern_t& pattern, std::size_t refresh_window_trefis);
+
+    victim_acts for_victim(const dram_address& victim) const;
+
+    std::size_t aggressor_rows() const {
+        return rows_.size();
+    }
+
+    private:
+    using row_key = std::tuple<size_t, size_t, size_t, size_t, size_t>;
+
+    // ACTs of aggressor row @p row in the refresh window starting at burst @p phase.
+    uint64_t window_acts(std::size_t row, std::size_t phase) const;
+
+    std::size_t pattern_length_;
+    std::size_t window_;
+    std::map<row_key, std::size_t> rows_;
+    std::vector<std::vector<uint32_t>> per_burst_;  // [row][burst]
+    std::vector<std::vector<uint64_t>> prefix_;     // [row][0, 2 * pattern length]
+};
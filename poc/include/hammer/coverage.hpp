@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// One fuzz point of a coverage campaign: the aggressor base row of every
+/// concurrently hammered bank, in assemble_multi_bank_pattern() bank order.
+struct coverage_point {
+    std::vector<int> base_rows;
+};
+
+struct coverage_plan_params {
+    std::size_t num_banks{};  // banks hammered concurrently
+    int rows_per_bank{};      // rows reachable in the mapped window
+    int region_rows{};        // stratum size; placements never straddle regions
+    int footprint_lo{};       // lowest touched row, relative to the base row
+    int footprint_hi{};       // highest touched row, relative to the base row
+    int excluded_row_start{}; // rows [start, end) are off limits (sync rows)
+    int excluded_row_end{};
+    std::size_t max_points{}; // 0 = enumerate everything
+};
+
+/**
+ * Enumerate all aggressor placements that fit into the mapped rows and order
+ * them for whole-bank characterization.
+ *
+ *  • Rows are split into regions of @c region_rows; each region is tiled with
+ *    non-overlapping pattern footprints, so a bank only revisits rows once
+ *    every placement of a region has been tested.
+ *  • Regions are visited in bit-reversed order, so any prefix of the plan is
+ *    spread evenly over the bank.
+ *  • Concurrently hammered banks are offset by R / num_banks regions and thus
+ *    never share victim rows while there are at least as many regions as banks.
+ */
+std::vector<coverage_point> plan_coverage(const coverage_plan_params& params);
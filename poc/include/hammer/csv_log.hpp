@@ -0,0 +1,52 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/// results/x.csv -> results/x.old.csv, or x.old1.csv, ... if that is taken.
+inline std::filesystem::path rotated_csv_path(const std::filesystem::path& path) {
+    const std::filesystem::path stem = path.parent_path() / path.stem();
+    std::filesystem::path old        = stem.string() + ".old" + path.extension().string();
+    for(int i = 1; std::filesystem::exists(old); ++i) {
+        old = stem.string() + ".old" + std::to_string(i) + path.extension().string();
+    }
+    return old;
+}
+
+/// Open the CSV log @p path for appending, writing @p header (without newline)
+/// to new files. A file with another header was written with other columns,
+/// e.g. by an older version; appending would mix row layouts, so it is moved
+/// aside (rotated_csv_path) and a new file is started.
+inline std::ofstream open_csv_log(const std::filesystem::path& path, const std::string& header) {
+    if(path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+
+    bool needs_header = true;
+    if(std::filesystem::exists(path) && std::filesystem::file_size(path) > 0) {
+        std::string first_line;
+        {
+            std::ifstream probe(path);
+            std::getline(probe, first_line);
+        }
+        needs_header = first_line != header;
+        if(needs_header) {
+            const std::filesystem::path old = rotated_csv_path(path);
+            std::filesystem::rename(path, old);
+            std::cerr << "[!] " << path.string() << " has different columns, moved it to "
+                      << old.string() << '\n';
+        }
+    }
+
+    std::ofstream csv(path, std::ios::out | std::ios::app);
+    if(!csv) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    if(needs_header) {
+        csv << header << '\n';
+    }
+    return csv;
+}
@@ -8,7 +8,19 @@
 class dram_address {
     public:
     static void initialize(allocation alloc, int dimm_size_gib, int dimm_ranks);
+    /// Select the platform's address mapping without an allocation, e.g. to
+    /// compute rows in tests; initialize() does this too.
+    static void configure(int dimm_size_gib, int dimm_ranks);
     static allocation& alloc();
+    /// Number of rows per bank reachable through the mapped allocation.
+    [[nodiscard]] static size_t row_count();
+    /// Number of bank groups per rank.
+    [[nodiscard]] static size_t bank_group_count();
+    /// Translate through the runtime matrix and the selected SIMD kernels
+    /// instead of the compile-time mapping of the configured platform.
+    static void use_generic_mapping(bool generic);
+    /// Active translation, e.g. "zen4-1r-16g (fixed)" or "generic (avx512)".
+    [[nodiscard]] static std::string mapping_name();
 
     [[nodiscard]] static dram_address from_virt(const volatile char* virt);
 
@@ -36,6 +48,8 @@ class dram_address {
 
     [[nodiscard]] std::vector<volatile char*> get_vaddrs_whole_row() const;
     std::vector<dram_address> get_whole_row() const;
+    /// Base addresses of the cache lines that make up this row.
+    [[nodiscard]] std::vector<volatile char*> get_vaddrs_row_lines() const;
 
     [[nodiscard]] std::string to_string() const;
 
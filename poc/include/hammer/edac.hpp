@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Corrected error counters of the Linux EDAC driver
+/// (/sys/devices/system/edac/mc/mc*/...). sample() reads only the per-controller
+/// totals; the per-csrow, per-channel and per-DIMM counters are read only when
+/// a total changed, so polling costs one pread() per memory controller.
+class edac_counters {
+    public:
+    struct counter {
+        std::string name; // e.g. "mc0", "mc0/csrow2", "mc0/csrow2/ch1", "mc0/dimm3"
+        std::string label; // DIMM label, if the driver provides one
+        int fd{ -1 };
+        uint64_t value{};
+    };
+
+    /// Counters whose value changed since the previous sample().
+    struct delta {
+        const counter* source;
+        uint64_t count;
+    };
+
+    static bool available(const std::filesystem::path& root = "/sys/devices/system/edac/mc");
+
+    /// Throws std::runtime_error if no corrected error counter is found.
+    explicit edac_counters(const std::filesystem::path& root = "/sys/devices/system/edac/mc");
+    ~edac_counters();
+
+    edac_counters(const edac_counters&)            = delete;
+    edac_counters& operator=(const edac_counters&) = delete;
+
+    /// Corrected errors since the previous call (or construction), totals first.
+    std::vector<delta> sample();
+
+    std::size_t controllers() const {
+        return totals_.size();
+    }
+    std::size_t size() const {
+        return totals_.size() + details_.size();
+    }
+
+    private:
+    std::vector<counter> totals_;  // one per memory controller
+    std::vector<counter> details_; // csrow, channel and DIMM counters
+};
+
+/// One RAS mc_event trace record, i.e. one error report of the EDAC core.
+struct ras_event {
+    uint64_t count{};
+    std::string type; // Corrected, Uncorrected, Fatal, ...
+    std::string label;
+    int mc{ -1 };
+    int layer[3]{ -1, -1, -1 };
+    std::optional<uint64_t> phys_addr;
+    std::string line; // the raw trace line
+};
+
+/// Parses a ras:mc_event line from trace_pipe; nullopt for other lines.
+std::optional<ras_event> parse_mc_event(std::string_view line);
+
+/// ras:mc_event records from a private tracefs instance, so other tracing
+/// sessions are not disturbed. Needs root.
+class ras_trace {
+    public:
+    /// Throws std::runtime_error if tracefs or the ras events are unavailable.
+    explicit ras_trace(const std::filesystem::path& tracefs = "/sys/kernel/tracing",
+                       std::string instance = "phoenix");
+    ~ras_trace();
+
+    ras_trace(const ras_trace&)            = delete;
+    ras_trace& operator=(const ras_trace&) = delete;
+
+    /// Events recorded since the previous call; never blocks.
+    std::vector<ras_event> drain();
+
+    private:
+    std::filesystem::path instance_dir_;
+    int pipe_fd_{ -1 };
+    std::string partial_; // unterminated line of the previous read
+};
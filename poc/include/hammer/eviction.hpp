@@ -0,0 +1,92 @@
+#pragma once
+
+#include "dram_address.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using eviction_set_t = std::vector<volatile uint64_t*>;
+
+struct eviction_set_params {
+    /// Lines whose addresses are congruent modulo @p stride share the L3 set
+    /// index bits; candidates are taken from the mapped superpage at this stride.
+    std::size_t stride{ 1 << 18 };
+    /// Target eviction set size, i.e. the L3 associativity.
+    std::size_t ways{ 16 };
+    /// Repetitions of each eviction test; a test passes on a majority.
+    int rounds{ 5 };
+    /// Load latency (TSC cycles) above which a load is counted as served by
+    /// DRAM. 0 calibrates it on first use.
+    uint64_t miss_threshold{ 0 };
+};
+
+/// Builds and caches L3 eviction sets for aggressor lines, so they can be
+/// evicted by loads instead of clflush. Sets are found by timing within the
+/// mapped allocation: all congruent candidate lines are reduced by group
+/// testing until only about `ways` lines that still evict the target remain.
+class eviction_sets {
+    public:
+    explicit eviction_sets(eviction_set_params params = {});
+
+    /// Never use lines in the banks of @p addrs, so evicting an aggressor does
+    /// not activate rows in the hammered banks. Drops cached sets on change.
+    void exclude_banks(const std::vector<dram_address>& addrs);
+
+    /// Eviction set of the cache line containing @p line, built on first use.
+    /// The returned reference stays valid until exclude_banks() changes.
+    /// Throws std::runtime_error if no set can be found.
+    const eviction_set_t& for_line(volatile uint64_t* line);
+
+    uint64_t miss_threshold();
+
+    std::size_t built() const {
+        return built_;
+    }
+    double build_ms() const {
+        return build_ms_;
+    }
+
+    private:
+    const std::vector<volatile uint64_t*>& candidates(uintptr_t residue);
+    bool evicts(volatile uint64_t* target, const eviction_set_t& set);
+    eviction_set_t reduce(volatile uint64_t* target, eviction_set_t set);
+
+    eviction_set_params params_;
+    std::unordered_set<uint64_t> excluded_banks_;
+    std::unordered_map<uintptr_t, std::vector<volatile uint64_t*>> candidates_;
+    // Sets by line address, and by residue for reuse by congruent lines
+    std::list<eviction_set_t> sets_;
+    std::unordered_map<uintptr_t, const eviction_set_t*> by_line_;
+    std::unordered_map<uintptr_t, std::vector<const eviction_set_t*>> by_residue_;
+    std::size_t built_{ 0 };
+    double build_ms_{ 0 };
+};
+
+/// Load every line of @p set once.
+inline void evict(const eviction_set_t& set) {
+    for(volatile uint64_t* p : set) {
+        (void)*p;
+    }
+}
+
+/// Achievable activation rate of an access primitive, see measure_access_rate().
+struct access_rate {
+    std::string_view mode;
+    double cycles_per_access{}; // TSC cycles per aggressor load incl. flush/eviction
+    double dram_fraction{};     // share of aggressor loads slower than the miss threshold
+    double acts_per_trefi{};    // DRAM-served aggressor loads per tREFI
+};
+
+/// Hammer @p aggressors in a loop, flushing each line after its load with
+/// clflushopt (@p sets == nullptr) or by loading its eviction set, and report
+/// how many row activations fit into one tREFI of @p trefi_ns.
+access_rate measure_access_rate(const std::vector<volatile uint64_t*>& aggressors,
+                                eviction_sets* sets,
+                                uint64_t miss_threshold,
+                                double trefi_ns,
+                                int rounds = 200);
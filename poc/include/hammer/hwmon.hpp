@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// DIMM temperatures from the hwmon sensors of the SPD hubs (spd5118 on DDR5,
+/// jc42 on DDR4). The sensors sit behind SMBus and take milliseconds to read,
+/// so a background thread, off the hammer core and without real-time
+/// priority, samples them and the sweep loop only reads the latest values.
+class dimm_temperatures {
+    public:
+    struct sensor {
+        std::string name; // e.g. "spd5118 1-0051"
+        int fd{ -1 };     // temp1_input
+    };
+
+    /// Temperature of one sensor over a window, in degrees Celsius.
+    struct window {
+        double min_c{};
+        double mean_c{};
+        double max_c{};
+        std::size_t samples{};
+    };
+
+    static bool available(const std::filesystem::path& root = "/sys/class/hwmon");
+
+    /// Throws std::runtime_error if no DIMM sensor is found.
+    dimm_temperatures(int hammer_core,
+                      std::chrono::milliseconds period,
+                      const std::filesystem::path& root = "/sys/class/hwmon");
+    ~dimm_temperatures();
+
+    dimm_temperatures(const dimm_temperatures&)            = delete;
+    dimm_temperatures& operator=(const dimm_temperatures&) = delete;
+
+    const std::vector<sensor>& sensors() const {
+        return sensors_;
+    }
+
+    /// Per-sensor statistics since the previous call; starts a new window.
+    std::vector<window> take_window();
+
+    /// Blocks until the latest reading of every sensor lies within
+    /// [@p min_c, @p max_c]. Returns false if @p timeout passed or @p stop was
+    /// set first.
+    bool wait_for_band(double min_c,
+                       double max_c,
+                       std::chrono::seconds timeout,
+                       const std::atomic<bool>* stop = nullptr);
+
+    /// Latest reading of every sensor; empty before the first sample.
+    std::vector<double> latest() const;
+
+    private:
+    struct accumulator {
+        double min_c{};
+        double max_c{};
+        double sum_c{};
+        std::size_t samples{};
+    };
+
+    void sample_loop(int hammer_core);
+    bool in_band(double min_c, double max_c) const; // with mutex_ held
+
+    std::vector<sensor> sensors_;
+    std::chrono::milliseconds period_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable sampled_, quit_cv_;
+    std::vector<double> latest_;
+    std::vector<accumulator> windows_;
+    bool quit_{ false };
+    std::thread thread_;
+};
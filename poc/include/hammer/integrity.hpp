@@ -0,0 +1,62 @@
+#pragma once
+
+#include "bit_flips.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fills and verifies a whole memory region with a pool of worker threads,
+/// pinned to every online CPU except the hammer core. Used to find flips
+/// outside the pattern's victim rows (far victims, sync row neighbours,
+/// mapping mistakes).
+class integrity_checker {
+    public:
+    /// @p threads = 0 uses all online CPUs except @p hammer_core.
+    integrity_checker(volatile char* base, size_t size, int hammer_core, unsigned threads = 0);
+    ~integrity_checker();
+
+    integrity_checker(const integrity_checker&)            = delete;
+    integrity_checker& operator=(const integrity_checker&) = delete;
+
+    /// Write @p pattern to the whole region.
+    void fill(uint64_t pattern);
+
+    /// Compare the whole region against @p pattern, restore mismatching lines
+    /// and return their flipped bytes, ordered by address.
+    std::vector<bit_flip_t> verify(uint64_t pattern);
+
+    unsigned threads() const {
+        return static_cast<unsigned>(workers_.size());
+    }
+    /// Duration of the last fill() or verify().
+    double last_ms() const {
+        return last_ms_;
+    }
+
+    private:
+    using chunk_fn = std::function<void(volatile char* chunk, size_t bytes, std::vector<bit_flip_t>& out)>;
+
+    /// Run @p fn on all chunks of the region, spread over the workers.
+    void run(const chunk_fn& fn);
+    void worker_loop(std::size_t index, int cpu);
+
+    volatile char* base_;
+    size_t size_;
+    double last_ms_{};
+
+    std::vector<std::thread> workers_;
+    std::vector<std::vector<bit_flip_t>> results_; // per worker
+    std::mutex mutex_;
+    std::condition_variable start_, finished_;
+    const chunk_fn* job_{ nullptr };
+    uint64_t generation_{};
+    std::size_t busy_{};
+    bool quit_{ false };
+    std::atomic<size_t> next_chunk_{};
+};
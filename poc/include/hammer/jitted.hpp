@@ -1,6 +1,95 @@
 #pragma once
 
+#include "eviction.hpp"
 #include "pattern.hpp"
+#include "phase_profiler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Bursts [burst_start, burst_end) of a phase-sweep run, executed with the
+/// schedule @p phase_offset slots ahead of where it started.
+struct jit_phase_window {
+    uint64_t phase_offset{};
+    uint64_t burst_start{};
+    uint64_t burst_end{};
+    uint64_t tsc_start{}; // REF timestamp the window started on
+};
+
+/// Measurements of the most recent hammer_jitted_* call.
+struct jit_run_stats {
+    bool hugepage{};             // code was placed in 2 MiB hugepages
+    size_t code_size{};          // bytes of generated code and jump table
+    uint64_t bursts{};           // bursts executed
+    bool burst_timing{};         // desync_bursts, burst_cycles_* measured (jit_set_burst_timing)
+    uint64_t desync_bursts{};    // self-sync bursts that skipped missed REFs (seq_sync: 0)
+    double burst_cycles_mean{};  // TSC cycles from REF detection to burst end
+    double burst_cycles_var{};
+    int64_t itlb_misses{ -1 };   // user-space iTLB misses, -1 if unavailable
+    std::vector<jit_phase_window> phase_windows; // empty unless a phase sweep was active
+};
+
+/// REF-to-REF intervals seen by the sync probe, in TSC cycles. Intervals
+/// below half or above 1.5 times the median count as spurious or missed REFs
+/// and are left out of mean and stddev.
+struct ref_interval_stats {
+    unsigned probe_width{};
+    std::size_t intervals{};
+    double median_cycles{};
+    double mean_cycles{};
+    double stddev_cycles{};
+    std::size_t missed{};
+    std::size_t spurious{};
+};
+
+/// Place generated code in 2 MiB hugepages (default) or in AsmJit's
+/// regular 4 KiB page allocator. Falls back to the latter automatically.
+void jit_use_hugepage_code(bool enable);
+
+/// Time every burst with rdtscp and count self-sync bursts that skipped
+/// missed REFs (jit_run_stats::burst_cycles_*, desync_bursts). The extra
+/// instructions and stores run after every burst and perturb the timing they
+/// measure, so this is off by default.
+void jit_set_burst_timing(bool enable);
+
+/// Advance the schedule index by one extra slot every @p period_trefis bursts,
+/// so a single run walks through all phases of the pattern relative to the
+/// DIMM's refresh counter. 0 (default) disables the sweep.
+void jit_set_phase_sweep(uint64_t period_trefis);
+
+/// Evict aggressor and sync row lines by loading their eviction sets instead
+/// of clflushopt. Sets are built while generating code, outside the banks of
+/// the pattern. nullptr (default) selects clflushopt.
+void jit_use_eviction_sets(eviction_sets* sets);
+
+/// Account the execution of the generated code to sweep_phase::hammer of
+/// @p profiler; the rest of a hammer_jitted_* call is left to the caller's
+/// phase (jit_compile). nullptr (default) disables this.
+void jit_set_phase_profiler(phase_profiler* profiler);
+
+/// Probe @p width sync lines per iteration, one per bank group starting at
+/// each sync row's own, and detect REF when the whole group takes longer
+/// than the threshold. The loads are independent, so they overlap and the
+/// group costs about one DRAM access. 1 (default) is the serial probe: one
+/// sync row per iteration.
+void jit_set_ref_probe_width(unsigned width);
+
+const jit_run_stats& jit_last_run_stats();
+
+/// Detect @p samples + 1 REFs in a row with the configured probe and return
+/// the statistics of the intervals between them.
+ref_interval_stats jit_measure_ref_intervals(const hammer_pattern_t& pattern,
+                                             std::vector<dram_address>& sync_rows,
+                                             int ref_threshold,
+                                             std::size_t samples);
+
+/// Time @p samples iterations of the configured REF probe and return a REF
+/// threshold halfway between a typical iteration (median) and one blocked by
+/// REF (99.5th percentile, as REF stalls only a few percent of iterations).
+int jit_calibrate_ref_threshold(const hammer_pattern_t& pattern,
+                                std::vector<dram_address>& sync_rows,
+                                std::size_t samples);
 
 
 using hammer_fn_t = void (*)(const hammer_pattern_t& /* pattern   */,
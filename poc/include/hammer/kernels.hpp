@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#define CACHE_LINE_SIZE 64
+
+/// Instruction-set tier of the performance kernels. The binary is built for
+/// the x86-64 baseline; wider variants are compiled with per-function target
+/// attributes and picked once at startup based on CPUID.
+enum class kernel_variant { scalar, avx2, avx512 };
+
+struct kernel_table {
+    kernel_variant variant;
+
+    /// GF(2) matrix-vector product: bit i of the result is the parity of
+    /// (matrix[i] & addr). Used by dram_address for both translation directions.
+    size_t (*apply_matrix)(const size_t* matrix, size_t rows, size_t addr);
+
+    /// Write the 8-byte @p pattern to every word of a 64-byte line and flush it.
+    void (*fill_line)(volatile char* line, uint64_t pattern);
+
+    /// Compare a 64-byte line against the repeated 8-byte @p pattern.
+    /// Bit i of the result is set if byte i of the line differs.
+    uint64_t (*scan_line)(const volatile char* line, uint64_t pattern);
+
+    /// Write @p pattern to @p bytes (a multiple of 64) of line-aligned memory
+    /// with non-temporal stores, bypassing and evicting cached copies.
+    void (*stream_fill)(volatile char* dst, size_t bytes, uint64_t pattern);
+
+    /// Offset of the first 64-byte line in @p bytes of line-aligned memory that
+    /// differs from the repeated @p pattern, or @p bytes if all match. Lines are
+    /// read with non-temporal loads and flushed afterwards, so the next call
+    /// reads them from DRAM again.
+    size_t (*find_mismatch)(const volatile char* src, size_t bytes, uint64_t pattern);
+};
+
+/// Best variant supported by the executing CPU.
+kernel_variant detect_kernel_variant();
+
+/// Switch the active kernel table. Throws std::invalid_argument if the CPU
+/// does not support @p variant.
+void select_kernels(kernel_variant variant);
+
+/// Currently active kernel table (defaults to detect_kernel_variant()).
+const kernel_table& kernels();
+
+std::string_view to_string(kernel_variant variant);
+
+/// Parse "scalar", "avx2" or "avx512"; throws std::invalid_argument otherwise.
+kernel_variant parse_kernel_variant(std::string_view name);
@@ -2,20 +2,62 @@
 
 #include "bit_flips.hpp"
 #include "pattern.hpp"
+#include "phase_profiler.hpp"
 
+#include <string>
 #include <vector>
 
 struct FuzzPoint {
-    int pattern_idx;
+    /// Index of the sweep plan point, shared by all its reads/sync combinations.
+    int plan_point;
     int pattern_reads_per_trefi;
     const hammer_pattern_t& pattern;
     int self_sync_threshold;
+    /// Base row of the first target bank; see base_rows for the others.
     int agg_base_row;
+    /// Target banks (row and column 0) and their base rows, in pattern order.
+    const std::vector<dram_address>* banks{ nullptr };
+    const std::vector<int>* base_rows{ nullptr };
+    const std::vector<dram_address>* victims{ nullptr };
+    /// Phase timings of this point so far and histograms of all earlier points.
+    const phase_profiler* phases{ nullptr };
+    /// Flips outside the victim rows, if the whole allocation was checked
+    /// after this point (--integrity-every).
+    const std::vector<bit_flip_t>* integrity_flips{ nullptr };
+
+    /// Base row of the pattern in @p a's bank (agg_base_row outside the targets).
+    [[nodiscard]] int base_row_for(const dram_address& a) const {
+        if(banks && base_rows) {
+            for(std::size_t i = 0; i < banks->size() && i < base_rows->size(); ++i) {
+                const dram_address& b = (*banks)[i];
+                if(b.subchannel() == a.subchannel() && b.rank() == a.rank() &&
+                   b.bank_group() == a.bank_group() && b.bank() == a.bank()) {
+                    return (*base_rows)[i];
+                }
+            }
+        }
+        return agg_base_row;
+    }
+
+    /// All base rows, ';'-separated, for logs of the whole point.
+    [[nodiscard]] std::string base_rows_string() const {
+        if(!base_rows) {
+            return std::to_string(agg_base_row);
+        }
+        std::string s;
+        for(int row : *base_rows) {
+            s += (s.empty() ? "" : ";") + std::to_string(row);
+        }
+        return s;
+    }
 };
 
 
 struct IHammerObserver {
     virtual void on_pre_iteration(const FuzzPoint&) = 0;
     virtual void on_post_iteration(const FuzzPoint&, const std::vector<bit_flip_t>&) = 0;
+    /// Called once after the last fuzz point, e.g. to emit summaries.
+    virtual void on_campaign_end() {
+    }
     virtual ~IHammerObserver() = default;
-};
\ No newline at end of file
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "activations.hpp"
+#include "csv_log.hpp"
+#include "jitted.hpp"
+#include "observer.hpp"
+#include "time_utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Attaches to every bit flip the activations its neighbour rows received
+/// between two refreshes of the victim, predicted from the pattern schedule
+/// (activation_model). The prediction assumes every tREFI ran a burst; the
+/// fraction that actually did (from the JIT telemetry) is logged next to it
+/// and scales the effective hammer count in the summary.
+///
+/// The model is only built for points with flips, after the scan, so it adds
+/// nothing to the hammer phase.
+class ActivationObserver final : public IHammerObserver {
+    public:
+    ActivationObserver(std::filesystem::path csv_path,
+                       std::size_t refresh_window_trefis,
+                       double trefi_ns)
+    : csv_path_{ std::move(csv_path) }, window_{ refresh_window_trefis }, trefi_ns_{ trefi_ns } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offset,subch,rank,bg,bank,row,col,acts_below_min,"
+                            "acts_below_max,acts_above_min,acts_above_max,hc_min,hc_max,"
+                            "max_acts_per_trefi,burst_fraction");
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>& flips) override {
+        if(flips.empty() || fp.pattern.empty()) {
+            return;
+        }
+        const activation_model model(fp.pattern, window_);
+        const double fraction = burst_fraction(fp);
+
+        const std::string ts = iso_timestamp();
+        for(const auto& flip : flips) {
+            const auto& a = flip.address;
+            const auto v  = model.for_victim(a);
+            csv_ << ts << ',' << fp.pattern_reads_per_trefi << ',' << fp.self_sync_threshold << ','
+                 << fp.plan_point << ',' << fp.base_row_for(a) << ',' << a.subchannel() << ',' << a.rank() << ','
+                 << a.bank_group() << ',' << a.bank() << ',' << a.row() << ',' << a.column()
+                 << ',' << v.below_min << ',' << v.below_max << ',' << v.above_min << ','
+                 << v.above_max << ',' << v.hc_min << ',' << v.hc_max << ','
+                 << v.max_per_trefi << ',' << std::fixed << std::setprecision(4) << fraction
+                 << std::defaultfloat << '\n';
+
+            ++flips_;
+            if(v.hc_max == 0) {
+                ++unexplained_;
+                continue;
+            }
+            const auto effective = static_cast<uint64_t>(v.hc_min * fraction);
+            lowest_hc_           = flips_ - unexplained_ == 1 ? effective
+                                                              : std::min(lowest_hc_, effective);
+        }
+        csv_.flush();
+    }
+
+    void on_campaign_end() override {
+        if(flips_ == 0) {
+            return;
+        }
+        std::cout << "\n[+] Predicted activations: " << flips_ << " flips";
+        if(flips_ > unexplained_) {
+            std::cout << ", lowest hammer count " << lowest_hc_
+                      << " (min over refresh phases, scaled by bursts run)";
+        }
+        if(unexplained_ > 0) {
+            std::cout << ", " << unexplained_ << " without an adjacent aggressor row";
+        }
+        std::cout << "\n    log: " << csv_path_.string() << '\n';
+    }
+
+    private:
+    // Executed bursts over tREFIs the hammer phase spanned
+    double burst_fraction(const FuzzPoint& fp) const {
+        if(!fp.phases || trefi_ns_ <= 0) {
+            return 1.0;
+        }
+        const double hammer_ns =
+            fp.phases->current()[static_cast<int>(sweep_phase::hammer)] / tsc_cycles_per_ns();
+        const double trefis = hammer_ns / trefi_ns_;
+        if(trefis < 1) {
+            return 1.0;
+        }
+        return std::min(1.0, jit_last_run_stats().bursts / trefis);
+    }
+
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    std::size_t window_;
+    double trefi_ns_;
+    std::size_t flips_{};
+    std::size_t unexplained_{};
+    uint64_t lowest_hc_{};
+};
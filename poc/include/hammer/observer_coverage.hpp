@@ -0,0 +1,144 @@
+#pragma once
+
+#include "observer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/// Tracks which victim rows of each bank were scanned and which of them
+/// flipped, stratified by row region, and prints a coverage report at the end.
+class CoverageObserver final : public IHammerObserver {
+    public:
+    CoverageObserver(std::size_t rows_per_bank, std::size_t region_rows, std::filesystem::path report_path)
+    : rows_per_bank_{ rows_per_bank }, region_rows_{ region_rows },
+      report_path_{ std::move(report_path) } {
+        if(region_rows_ == 0) {
+            throw std::invalid_argument("CoverageObserver: region size must be > 0");
+        }
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+        if(!started_) {
+            start_   = std::chrono::steady_clock::now();
+            started_ = true;
+        }
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>& flips) override {
+        const auto victims = fp.victims ? *fp.victims : pattern_victims(fp.pattern);
+        for(const auto& v : victims) {
+            if(v.row() < rows_per_bank_) {
+                bank(v).tested[v.row()] = 1;
+            }
+        }
+        for(const auto& bf : flips) {
+            if(bf.address.row() < rows_per_bank_) {
+                bank(bf.address).flipped[bf.address.row()] = 1;
+            }
+        }
+        ++points_;
+    }
+
+    void on_campaign_end() override {
+        const double hours = std::chrono::duration<double, std::ratio<3600>>(
+                                 std::chrono::steady_clock::now() - start_)
+                                 .count();
+        const std::size_t num_regions = (rows_per_bank_ + region_rows_ - 1) / region_rows_;
+
+        std::ofstream csv;
+        if(!report_path_.empty()) {
+            if(report_path_.has_parent_path()) {
+                std::filesystem::create_directories(report_path_.parent_path());
+            }
+            csv.open(report_path_);
+            if(!csv) {
+                throw std::runtime_error("Cannot open " + report_path_.string());
+            }
+            csv << "subch,rank,bg,bank,region,first_row,rows,rows_tested,rows_flipped\n";
+        }
+
+        std::cout << "\n[+] Coverage report (" << points_ << " points, "
+                  << rows_per_bank_ << " rows/bank, " << region_rows_
+                  << " rows/region)\n";
+
+        std::size_t total_tested = 0;
+        for(const auto& [key, cov] : banks_) {
+            const auto [sc, rk, bg, bk] = key;
+            std::size_t bank_tested = 0, bank_flipped = 0;
+            std::ostringstream per_region;
+
+            for(std::size_t r = 0; r < num_regions; ++r) {
+                const std::size_t first = r * region_rows_;
+                const std::size_t last  = std::min(first + region_rows_, rows_per_bank_);
+                std::size_t tested = 0, flipped = 0;
+                for(std::size_t row = first; row < last; ++row) {
+                    tested += cov.tested[row];
+                    flipped += cov.flipped[row];
+                }
+                bank_tested += tested;
+                bank_flipped += flipped;
+                per_region << (r ? " " : "") << std::fixed << std::setprecision(0)
+                           << 100.0 * tested / (last - first) << '%';
+
+                if(csv) {
+                    csv << sc << ',' << rk << ',' << bg << ',' << bk << ',' << r
+                        << ',' << first << ',' << last - first << ',' << tested
+                        << ',' << flipped << '\n';
+                }
+            }
+            total_tested += bank_tested;
+
+            std::cout << "    bank (" << sc << ',' << rk << ',' << bg << ',' << bk
+                      << "): " << bank_tested << '/' << rows_per_bank_
+                      << " rows tested (" << std::fixed << std::setprecision(1)
+                      << 100.0 * bank_tested / rows_per_bank_ << "%), "
+                      << bank_flipped << " rows flipped | regions: "
+                      << per_region.str() << '\n';
+        }
+
+        std::cout << "    distinct rows tested: " << total_tested;
+        if(hours > 0) {
+            std::cout << " (" << std::fixed << std::setprecision(0)
+                      << total_tested / hours << " rows/h)";
+        }
+        std::cout << '\n';
+        if(csv) {
+            std::cout << "    written to " << report_path_.string() << '\n';
+        }
+    }
+
+    private:
+    struct bank_coverage {
+        std::vector<uint8_t> tested;
+        std::vector<uint8_t> flipped;
+    };
+
+    bank_coverage& bank(const dram_address& a) {
+        auto [it, inserted] = banks_.try_emplace(
+            std::make_tuple(a.subchannel(), a.rank(), a.bank_group(), a.bank()));
+        if(inserted) {
+            it->second.tested.assign(rows_per_bank_, 0);
+            it->second.flipped.assign(rows_per_bank_, 0);
+        }
+        return it->second;
+    }
+
+    std::size_t rows_per_bank_;
+    std::size_t region_rows_;
+    std::filesystem::path report_path_;
+
+    std::map<std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>, bank_coverage> banks_;
+    std::size_t points_{ 0 };
+    bool started_{ false };
+    std::chrono::steady_clock::time_point start_{};
+};
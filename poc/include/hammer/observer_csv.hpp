@@ -1,6 +1,7 @@
 #pragma once
 
 #include "bit_flips.hpp"
+#include "csv_log.hpp"
 #include "observer.hpp"
 #include "time_utils.hpp"
 
@@ -11,6 +12,7 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <utility>
@@ -20,33 +22,16 @@ namespace fs = std::filesystem;
 
 class CsvWriterObserver final : public IHammerObserver {
     public:
-    explicit CsvWriterObserver(fs::path file_path)
-    : csv_path_{ std::move(file_path) } {
+    /// @p kernels: SIMD kernel variant of the run, recorded with every flip.
+    CsvWriterObserver(fs::path file_path, std::string kernels)
+    : csv_path_{ std::move(file_path) }, kernels_{ std::move(kernels) } {
         if(csv_path_.empty()) {
             throw std::invalid_argument("CsvWriterObserver: empty file path");
         }
-        fs::create_directories(csv_path_.parent_path());
-
-        constexpr char kHeader[] =
-            "timestamp,reads_per_trefi,sync_cycles_threshold,row_base_offset,"
-            "virt_addr,subch,rank,bg,bank,row,col,expected_hex,actual_hex";
-
-        bool needs_header = true;
-        if(fs::exists(csv_path_) && fs::file_size(csv_path_) > 0) {
-            std::ifstream probe(csv_path_);
-            std::string first_line;
-            std::getline(probe, first_line);
-            needs_header = first_line.rfind(kHeader, 0) != 0; // header missing?
-        }
-
-        csv_.open(csv_path_, std::ios::out | std::ios::app);
-        if(!csv_) {
-            throw std::runtime_error("Cannot open " + csv_path_.string());
-        }
-
-        if(needs_header) {
-            csv_ << kHeader << '\n';
-        }
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offset,virt_addr,subch,rank,bg,bank,row,col,"
+                            "expected_hex,actual_hex,kernels");
 
         if(geteuid() == 0) {
             const char* sudo_uid = std::getenv("SUDO_UID");
@@ -89,14 +74,16 @@ class CsvWriterObserver final : public IHammerObserver {
             auto vaddr = reinterpret_cast<std::uintptr_t>(a.to_virt());
 
             csv_ << iso_timestamp() << ',' << fp.pattern_reads_per_trefi << ','
-                 << fp.self_sync_threshold << ',' << fp.agg_base_row << ','
+                 << fp.self_sync_threshold << ',' << fp.plan_point << ','
+                 << fp.base_row_for(a) << ','
                  << "0x" << std::uppercase << std::hex << vaddr << std::dec << ','
                  << a.subchannel() << ',' << a.rank() << ',' << a.bank_group()
                  << ',' << a.bank() << ',' << a.row() << ',' << a.column()
                  << ',' << "0x" << std::uppercase << std::hex << std::setw(2)
                  << std::setfill('0') << static_cast<unsigned>(bf.expected_value)
                  << ',' << "0x" << std::setw(2) << std::setfill('0')
-                 << static_cast<unsigned>(bf.actual_value) << std::dec << '\n';
+                 << static_cast<unsigned>(bf.actual_value) << std::dec << ','
+                 << kernels_ << '\n';
         }
         csv_.flush(); // make data visible immediately
     }
@@ -107,5 +94,6 @@ class CsvWriterObserver final : public IHammerObserver {
 
     private:
     fs::path csv_path_;
+    std::string kernels_;
     std::ofstream csv_;
 };
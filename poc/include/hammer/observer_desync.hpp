@@ -0,0 +1,74 @@
+#pragma once
+
+#include "csv_log.hpp"
+#include "jitted.hpp"
+#include "observer.hpp"
+#include "resctrl.hpp"
+#include "time_utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Logs how often the self-sync code lost track of REFs (bursts that skipped
+/// over missed REFs, see jit_run_stats::desync_bursts) per fuzz point, split by
+/// whether resctrl isolation was active, and prints both rates at the end.
+class DesyncObserver final : public IHammerObserver {
+    public:
+    DesyncObserver(std::filesystem::path csv_path, const resctrl_isolation* isolation)
+    : csv_path_{ std::move(csv_path) }, isolation_{ isolation } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offsets,isolated,bursts,desync_bursts,desync_rate");
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>&) override {
+        const auto& s       = jit_last_run_stats();
+        const bool isolated = isolation_ && isolation_->enabled();
+        const double rate = s.bursts ? static_cast<double>(s.desync_bursts) / s.bursts : 0.0;
+        csv_ << iso_timestamp() << ',' << fp.pattern_reads_per_trefi << ','
+             << fp.self_sync_threshold << ',' << fp.plan_point << ',' << fp.base_rows_string() << ',' << isolated << ','
+             << s.bursts << ',' << s.desync_bursts << ',' << rate << '\n';
+        csv_.flush();
+
+        auto& t = totals_[isolated];
+        t.points++;
+        t.bursts += s.bursts;
+        t.desync += s.desync_bursts;
+    }
+
+    void on_campaign_end() override {
+        std::cout << "\n[+] Self-sync desync rate (bursts skipping missed REFs):\n";
+        for(bool isolated : { true, false }) {
+            const auto& t = totals_[isolated];
+            if(t.points == 0) {
+                continue;
+            }
+            std::cout << "    " << (isolated ? "resctrl isolation" : "no isolation     ")
+                      << ": " << std::fixed << std::setprecision(4)
+                      << (t.bursts ? 100.0 * t.desync / t.bursts : 0.0) << "% over "
+                      << t.points << " fuzz points\n"
+                      << std::defaultfloat;
+        }
+        std::cout << "    per point: " << csv_path_.string() << '\n';
+    }
+
+    private:
+    struct totals {
+        std::size_t points{};
+        uint64_t bursts{};
+        uint64_t desync{};
+    };
+
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    const resctrl_isolation* isolation_;
+    totals totals_[2]{};
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "csv_log.hpp"
+#include "dram_address.hpp"
+#include "edac.hpp"
+#include "observer.hpp"
+#include "time_utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Attributes corrected ECC errors (EDAC counters) to fuzz points. Flips the
+/// ECC corrects never show up in collect_bit_flips(), so on ECC hosts this is
+/// the only sign that a point hammered successfully.
+///
+/// The counters are sampled right after each point's victim scan, which is
+/// what reads the flipped words. Errors the kernel reports later (CMCI
+/// deferral, polling) are picked up by the next point's pre-iteration sample
+/// and charged to the previous point with late=1. With a ras_trace, each error
+/// report is also decoded into a physical and, within the allocation, a DRAM
+/// address.
+class EdacObserver final : public IHammerObserver {
+    public:
+    EdacObserver(edac_counters& counters, ras_trace* trace, std::filesystem::path csv_path)
+    : counters_{ counters }, trace_{ trace }, csv_path_{ std::move(csv_path) } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offsets,late,source,label,ce_count,phys_addr,subch,rank,bg,"
+                            "bank,row,col,victim");
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+        record(last_, nullptr, true);
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>& flips) override {
+        last_ = { fp.pattern_reads_per_trefi, fp.self_sync_threshold, fp.plan_point,
+                  fp.base_rows_string(), true };
+        const uint64_t errors = record(last_, fp.victims, false);
+        if(errors > 0) {
+            ++points_with_errors_;
+            points_without_flips_ += flips.empty();
+        }
+    }
+
+    void on_campaign_end() override {
+        record(last_, nullptr, true);
+        if(total_ == 0) {
+            std::cout << "\n[+] No corrected ECC errors (" << counters_.controllers()
+                      << " memory controllers)\n";
+            return;
+        }
+        std::cout << "\n[+] Corrected ECC errors: " << total_ << " in " << points_with_errors_
+                  << " fuzz points, " << points_without_flips_
+                  << " of them without visible bit flips\n";
+        for(const auto& [name, count] : by_source_) {
+            std::cout << "    " << name << ": " << count << '\n';
+        }
+        std::cout << "    per point: " << csv_path_.string() << '\n';
+    }
+
+    private:
+    struct point {
+        int reads{}, sync_cycles{}, plan_point{};
+        std::string base_rows;
+        bool valid{ false };
+    };
+
+    // Returns the corrected errors counted by the memory controller totals.
+    uint64_t record(const point& p, const std::vector<dram_address>* victims, bool late) {
+        const auto deltas = counters_.sample();
+        // Drained in any case, so that no event is charged to a later point
+        const auto events = trace_ ? trace_->drain() : std::vector<ras_event>{};
+        if((deltas.empty() && events.empty()) || !p.valid) {
+            return 0;
+        }
+        const std::string ts = iso_timestamp();
+        auto prefix = [&] {
+            csv_ << ts << ',' << p.reads << ',' << p.sync_cycles << ',' << p.plan_point << ','
+                 << p.base_rows << ',' << late << ',';
+        };
+
+        uint64_t errors = 0;
+        for(const auto& d : deltas) {
+            prefix();
+            csv_ << d.source->name << ',' << d.source->label << ',' << d.count << ",,,,,,,,\n";
+            by_source_[d.source->name] += d.count;
+            if(d.source->name.find('/') == std::string::npos) {
+                errors += d.count;
+            }
+        }
+        for(const auto& e : events) {
+            if(e.type == "Corrected") {
+                prefix();
+                csv_ << "ras:mc" << e.mc << ',' << e.label << ',' << e.count << ',';
+                if(e.phys_addr) {
+                    csv_ << "0x" << std::hex << *e.phys_addr << std::dec;
+                }
+                csv_ << ',';
+                write_dram_address(e, victims);
+                csv_ << '\n';
+            }
+        }
+        csv_.flush();
+        total_ += errors;
+        return errors;
+    }
+
+    void write_dram_address(const ras_event& e, const std::vector<dram_address>* victims) {
+        volatile char* virt =
+            e.phys_addr ? dram_address::alloc().phys_to_virt(*e.phys_addr) : nullptr;
+        if(!virt) {
+            csv_ << ",,,,,,"; // outside the hammered allocation
+            return;
+        }
+        const auto a = dram_address::from_virt(virt);
+        csv_ << a.subchannel() << ',' << a.rank() << ',' << a.bank_group() << ',' << a.bank()
+             << ',' << a.row() << ',' << a.column() << ',';
+        if(victims) {
+            bool victim = false;
+            for(const auto& v : *victims) {
+                victim |= v.subchannel() == a.subchannel() && v.rank() == a.rank() &&
+                    v.bank_group() == a.bank_group() && v.bank() == a.bank() && v.row() == a.row();
+            }
+            csv_ << victim;
+        }
+    }
+
+    edac_counters& counters_;
+    ras_trace* trace_;
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    point last_;
+    uint64_t total_{};
+    std::size_t points_with_errors_{};
+    std::size_t points_without_flips_{};
+    std::map<std::string, uint64_t> by_source_;
+};
@@ -32,6 +32,14 @@ class FanOutObserver final : public IHammerObserver {
         }
     }
 
+    void on_campaign_end() override {
+        for(IHammerObserver* s : sinks_) {
+            if(s != nullptr) {
+                s->on_campaign_end();
+            }
+        }
+    }
+
     private:
     std::vector<IHammerObserver*> sinks_;
 };
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "csv_log.hpp"
+#include "integrity.hpp"
+#include "observer.hpp"
+#include "pattern.hpp"
+#include "time_utils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/// Logs the flips found by full-allocation integrity checks, classified by
+/// their row distance to the point's aggressors and to the sync rows.
+class IntegrityObserver final : public IHammerObserver {
+    public:
+    IntegrityObserver(std::filesystem::path csv_path,
+                      std::vector<dram_address> sync_rows,
+                      const integrity_checker& checker)
+    : csv_path_{ std::move(csv_path) }, sync_rows_{ std::move(sync_rows) }, checker_{ checker } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offset,subch,rank,bg,bank,row,col,expected_hex,actual_hex,"
+                            "kind,aggressor_distance,sync_distance");
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>&) override {
+        if(!fp.integrity_flips) {
+            return;
+        }
+        ++checks_;
+        total_ms_ += checker_.last_ms();
+        max_ms_ = std::max(max_ms_, checker_.last_ms());
+        if(fp.integrity_flips->empty()) {
+            return;
+        }
+
+        const auto aggressors = pattern_aggressors(fp.pattern);
+        const std::string ts  = iso_timestamp();
+        for(const auto& bf : *fp.integrity_flips) {
+            const dram_address& a = bf.address;
+            const long agg_dist   = row_distance(a, aggressors);
+            const long sync_dist  = row_distance(a, sync_rows_);
+            const char* kind      = agg_dist == 1 ? "victim"
+                     : agg_dist >= 0 && agg_dist <= kFarVictimRows ? "far_victim"
+                     : sync_dist >= 0 && sync_dist <= kSyncNeighbourRows ? "sync_neighbour"
+                                                                         : "unexplained";
+            ++by_kind_[kind];
+
+            csv_ << ts << ',' << fp.pattern_reads_per_trefi << ',' << fp.self_sync_threshold
+                 << ',' << fp.plan_point << ',' << fp.base_row_for(a) << ',' << a.subchannel() << ',' << a.rank() << ','
+                 << a.bank_group() << ',' << a.bank() << ',' << a.row() << ',' << a.column()
+                 << ",0x" << std::uppercase << std::hex << std::setw(2) << std::setfill('0')
+                 << static_cast<unsigned>(bf.expected_value) << ",0x" << std::setw(2)
+                 << static_cast<unsigned>(bf.actual_value) << std::dec << std::setfill(' ')
+                 << ',' << kind << ',';
+            if(agg_dist >= 0) {
+                csv_ << agg_dist;
+            }
+            csv_ << ',';
+            if(sync_dist >= 0) {
+                csv_ << sync_dist;
+            }
+            csv_ << '\n';
+        }
+        csv_.flush();
+    }
+
+    void on_campaign_end() override {
+        if(checks_ == 0) {
+            return;
+        }
+        std::cout << "\n[+] Integrity checks: " << checks_ << " of the whole allocation ("
+                  << checker_.threads() << " threads, " << std::fixed << std::setprecision(1)
+                  << total_ms_ / checks_ << " ms mean, " << max_ms_ << " ms max)\n"
+                  << std::defaultfloat;
+        if(by_kind_.empty()) {
+            std::cout << "    no flips outside the victim rows\n";
+            return;
+        }
+        for(const auto& [kind, count] : by_kind_) {
+            std::cout << "    " << kind << ": " << count << '\n';
+        }
+        std::cout << "    flips: " << csv_path_.string() << '\n';
+    }
+
+    private:
+    static constexpr long kFarVictimRows     = 8;
+    static constexpr long kSyncNeighbourRows = 2;
+
+    // Smallest row distance to a row in the same bank, -1 if there is none.
+    static long row_distance(const dram_address& a, const std::vector<dram_address>& rows) {
+        long best = -1;
+        for(const auto& r : rows) {
+            if(std::make_tuple(r.subchannel(), r.rank(), r.bank_group(), r.bank()) ==
+               std::make_tuple(a.subchannel(), a.rank(), a.bank_group(), a.bank())) {
+                const long d = std::labs(static_cast<long>(r.row()) - static_cast<long>(a.row()));
+                best         = best < 0 ? d : std::min(best, d);
+            }
+        }
+        return best;
+    }
+
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    std::vector<dram_address> sync_rows_;
+    const integrity_checker& checker_;
+    std::size_t checks_{};
+    double total_ms_{};
+    double max_ms_{};
+    std::map<std::string, uint64_t> by_kind_;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "jitted.hpp"
+#include "observer.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/// Collects jit_last_run_stats() after every fuzz point and prints code
+/// placement and iTLB misses at the end of the campaign, plus the burst timing
+/// jitter of each placement when it was measured (jit_set_burst_timing).
+class JitStatsObserver final : public IHammerObserver {
+    public:
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint&, const std::vector<bit_flip_t>&) override {
+        const auto& s = jit_last_run_stats();
+        ++runs_;
+        hugepage_runs_ += s.hugepage;
+        code_size_ += s.code_size;
+        bursts_ += s.bursts;
+        if(s.burst_timing) {
+            auto& t = timing_[s.hugepage];
+            t.runs++;
+            t.mean_sum += s.burst_cycles_mean;
+            t.var_sum += s.burst_cycles_var;
+        }
+        if(s.itlb_misses >= 0) {
+            itlb_misses_ += s.itlb_misses;
+            itlb_runs_++;
+        }
+    }
+
+    void on_campaign_end() override {
+        if(runs_ == 0) {
+            return;
+        }
+        std::cout << "\n[+] JIT code placement: " << hugepage_runs_ << '/' << runs_
+                  << " runs in 2 MiB hugepages, avg. code size "
+                  << code_size_ / runs_ / 1024 << " KiB\n"
+                  << std::fixed << std::setprecision(1);
+        if(timing_[true].runs == 0 && timing_[false].runs == 0) {
+            std::cout << "    burst cycles: not measured (--burst-timing)\n";
+        }
+        for(bool hugepage : { true, false }) {
+            const auto& t = timing_[hugepage];
+            if(t.runs == 0) {
+                continue;
+            }
+            std::cout << "    burst cycles (REF detection -> burst end), "
+                      << (hugepage ? "2 MiB pages" : "4 KiB pages") << ": mean "
+                      << t.mean_sum / t.runs << ", variance " << t.var_sum / t.runs
+                      << ", stddev " << std::sqrt(t.var_sum / t.runs) << " over " << t.runs
+                      << " runs\n";
+        }
+        if(itlb_runs_ > 0) {
+            std::cout << "    iTLB misses: " << itlb_misses_ / itlb_runs_ << " per run, "
+                      << (bursts_ ? 1e6 * itlb_misses_ / bursts_ : 0.0)
+                      << " per million bursts\n";
+        } else {
+            std::cout << "    iTLB misses: unavailable (perf_event_open failed)\n";
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    private:
+    struct burst_timing {
+        std::size_t runs{};
+        double mean_sum{};
+        double var_sum{};
+    };
+
+    std::size_t runs_{ 0 };
+    std::size_t hugepage_runs_{ 0 };
+    std::size_t code_size_{ 0 };
+    std::uint64_t bursts_{ 0 };
+    burst_timing timing_[2]{}; // by code placement: [hugepage]
+    double itlb_misses_{ 0 };
+    std::size_t itlb_runs_{ 0 };
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "csv_log.hpp"
+#include "jitted.hpp"
+#include "observer.hpp"
+#include "time_utils.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Logs the phase windows of every phase-sweep run (jit_set_phase_sweep) to a
+/// CSV file, together with the number of bit flips of the run. Flips are only
+/// collected after a run, so runs with flips list the phase offsets to repeat
+/// with --pattern-phase-offset to find the one that caused them.
+class PhaseSweepObserver final : public IHammerObserver {
+    public:
+    explicit PhaseSweepObserver(std::filesystem::path csv_path)
+    : csv_path_{ std::move(csv_path) } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,run,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offsets,phase_offset,burst_start,burst_end,tsc_start,"
+                            "run_bit_flips");
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>& flips) override {
+        const auto& windows = jit_last_run_stats().phase_windows;
+        const std::string ts = iso_timestamp();
+        for(const auto& w : windows) {
+            csv_ << ts << ',' << run_ << ',' << fp.pattern_reads_per_trefi << ','
+                 << fp.self_sync_threshold << ',' << fp.plan_point << ',' << fp.base_rows_string() << ',' << w.phase_offset
+                 << ',' << w.burst_start << ',' << w.burst_end << ',' << w.tsc_start << ','
+                 << flips.size() << '\n';
+        }
+        csv_.flush();
+
+        if(!flips.empty() && !windows.empty()) {
+            ++runs_with_flips_;
+            phases_covered_ = std::max(phases_covered_, windows.size());
+        }
+        ++run_;
+    }
+
+    void on_campaign_end() override {
+        if(runs_with_flips_ == 0) {
+            return;
+        }
+        std::cout << "\n[+] Phase sweep: " << runs_with_flips_ << " run(s) with bit flips over "
+                  << phases_covered_ << " phase windows, see " << csv_path_.string()
+                  << "\n    confirm single phases with --pattern-phase-offset <phase_offset>\n";
+    }
+
+    private:
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    std::size_t run_{ 0 };
+    std::size_t runs_with_flips_{ 0 };
+    std::size_t phases_covered_{ 0 };
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "observer.hpp"
+#include "profile.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+/// Records which (reads per tREFI, self-sync cycles) combinations produced bit
+/// flips and stores the winners in the calibration profile at the end of the run.
+class ProfileObserver final : public IHammerObserver {
+    public:
+    /// @p base carries the fingerprint and the fixed campaign parameters.
+    ProfileObserver(const profile_store& store, calibration_profile base)
+    : store_{ store }, base_{ std::move(base) } {
+    }
+
+    /// Store @p cycles, the REF threshold measured on this host, instead of
+    /// the one the campaign was configured with.
+    void set_ref_threshold(int cycles) {
+        base_.ref_threshold = cycles;
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>& flips) override {
+        flips_[{ fp.pattern_reads_per_trefi, fp.self_sync_threshold }] += flips.size();
+    }
+
+    void on_campaign_end() override {
+        calibration_profile p = base_;
+        bool any             = false;
+
+        for(const auto& [key, count] : flips_) {
+            if(count == 0) {
+                continue;
+            }
+            const auto [reads, sync] = key;
+            if(!any) {
+                p.reads_per_trefi_min = p.reads_per_trefi_max = reads;
+                p.self_sync_cycles_min = p.self_sync_cycles_max = sync;
+                any = true;
+            }
+            p.reads_per_trefi_min  = std::min(p.reads_per_trefi_min, reads);
+            p.reads_per_trefi_max  = std::max(p.reads_per_trefi_max, reads);
+            p.self_sync_cycles_min = std::min(p.self_sync_cycles_min, sync);
+            p.self_sync_cycles_max = std::max(p.self_sync_cycles_max, sync);
+            if(count > p.best_flips) {
+                p.best_flips            = count;
+                p.best_reads_per_trefi  = reads;
+                p.best_self_sync_cycles = sync;
+            }
+        }
+
+        if(!any) {
+            std::cout << "[+] No bit flips, calibration profile left unchanged\n";
+            return;
+        }
+
+        store_.save(p);
+        std::cout << "[+] Calibration profile updated: " << store_.path_for(p.fingerprint).string()
+                  << " (best reads/tREFI=" << p.best_reads_per_trefi
+                  << ", sync=" << p.best_self_sync_cycles << ", " << p.best_flips << " flips)\n";
+    }
+
+    private:
+    const profile_store& store_;
+    calibration_profile base_;
+    std::map<std::pair<int, int>, std::size_t> flips_;
+};
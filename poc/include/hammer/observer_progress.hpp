@@ -42,7 +42,7 @@ class ProgressBarObserver final : public IHammerObserver {
     void update_postfix(const FuzzPoint& fp) {
         std::ostringstream s;
         s << "it=" << iterations_done_ << "/" << total_iterations_
-          << " | len=" << fp.pattern.size() << " | agg_base_row=" << fp.agg_base_row
+          << " | len=" << fp.pattern.size() << " | base_rows=" << fp.base_rows_string()
           << " | sync=" << fp.self_sync_threshold << " | r/tREFI=" << fp.pattern_reads_per_trefi
           << " | BF+ " << last_flips_ << " | BFΣ " << total_flips_ << " ";
         bar_.set_option(indicators::option::PostfixText{ s.str() });
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "observer.hpp"
+#include "pattern.hpp"
+#include "row_mapping.hpp"
+
+#include <iostream>
+#include <optional>
+#include <vector>
+
+/// Learns the DIMM's row remapping from the flips of the first fuzz points
+/// (row_adjacency_inference). Victims of these points are scanned under every
+/// known scheme; once one scheme explains enough more flipped rows than the
+/// others, it becomes the active remapping, so later points place aggressor
+/// pairs around true physical victims and only scan those.
+class RowRemapObserver final : public IHammerObserver {
+    public:
+    /// Expects set_row_remap_learning(true) before the first pattern is assembled.
+    explicit RowRemapObserver(std::size_t min_lead) : min_lead_{ min_lead } {
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>& flips) override {
+        if(decided_ || flips.empty()) {
+            return;
+        }
+        inference_.record(pattern_aggressors(fp.pattern), flips);
+        if(const auto remap = inference_.decide(min_lead_)) {
+            set_row_remap(*remap);
+            set_row_remap_learning(false);
+            decided_ = remap;
+            std::cout << "\n[+] Row remapping inferred: " << to_string(*remap) << " (";
+            print_scores();
+            std::cout << ")\n";
+        }
+    }
+
+    void on_campaign_end() override {
+        if(!decided_) {
+            set_row_remap_learning(false);
+        }
+        std::cout << "\n[+] Row remapping: ";
+        if(decided_) {
+            std::cout << to_string(*decided_);
+        } else {
+            std::cout << "undecided, kept " << to_string(active_row_remap());
+        }
+        std::cout << " (";
+        print_scores();
+        std::cout << ")\n";
+    }
+
+    private:
+    void print_scores() const {
+        const auto scores = inference_.scores();
+        for(std::size_t i = 0; i < scores.size(); ++i) {
+            std::cout << (i ? ", " : "") << to_string(scores[i].remap) << ' '
+                      << scores[i].explained;
+        }
+        std::cout << " of " << inference_.rows() << " flipped rows adjacent to an aggressor";
+    }
+
+    std::size_t min_lead_;
+    row_adjacency_inference inference_;
+    std::optional<row_remap> decided_;
+};
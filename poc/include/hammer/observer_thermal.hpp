@@ -0,0 +1,95 @@
+#pragma once
+
+#include "csv_log.hpp"
+#include "hwmon.hpp"
+#include "observer.hpp"
+#include "time_utils.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Logs the DIMM temperatures seen while each fuzz point ran, together with
+/// the time the sweep was held before it for the temperature to settle
+/// (sweep_phase::thermal_hold).
+class ThermalObserver final : public IHammerObserver {
+    public:
+    ThermalObserver(std::filesystem::path csv_path, dimm_temperatures& temps)
+    : csv_path_{ std::move(csv_path) }, temps_{ temps } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offsets,sensor,min_c,mean_c,max_c,samples,hold_ms");
+        campaign_.resize(temps_.sensors().size());
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+        temps_.take_window(); // drop what was sampled between points
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>&) override {
+        const auto windows = temps_.take_window();
+        double hold_ms     = 0;
+        if(fp.phases) {
+            hold_ms = fp.phases->current()[static_cast<int>(sweep_phase::thermal_hold)] /
+                tsc_cycles_per_ns() / 1e6;
+        }
+        if(hold_ms > 0) {
+            ++held_points_;
+            hold_ms_ += hold_ms;
+        }
+
+        const std::string ts        = iso_timestamp();
+        const std::string base_rows = fp.base_rows_string();
+        csv_ << std::fixed << std::setprecision(2);
+        for(std::size_t i = 0; i < windows.size(); ++i) {
+            const auto& w = windows[i];
+            csv_ << ts << ',' << fp.pattern_reads_per_trefi << ',' << fp.self_sync_threshold << ','
+                 << fp.plan_point << ',' << base_rows << ',' << temps_.sensors()[i].name << ',';
+            // A point shorter than the sampling period may see no sample
+            if(w.samples > 0) {
+                csv_ << w.min_c << ',' << w.mean_c << ',' << w.max_c;
+                auto& c = campaign_[i];
+                c.min_c = c.samples == 0 ? w.min_c : std::min(c.min_c, w.min_c);
+                c.max_c = c.samples == 0 ? w.max_c : std::max(c.max_c, w.max_c);
+                c.samples += w.samples;
+            } else {
+                csv_ << ",,";
+            }
+            csv_ << ',' << w.samples << ',' << hold_ms << '\n';
+        }
+        csv_ << std::defaultfloat;
+        csv_.flush();
+    }
+
+    void on_campaign_end() override {
+        std::cout << "\n[+] DIMM temperatures during fuzz points:\n" << std::fixed
+                  << std::setprecision(1);
+        for(std::size_t i = 0; i < campaign_.size(); ++i) {
+            std::cout << "    " << temps_.sensors()[i].name << ": ";
+            if(campaign_[i].samples == 0) {
+                std::cout << "no samples\n";
+            } else {
+                std::cout << campaign_[i].min_c << " - " << campaign_[i].max_c << " C ("
+                          << campaign_[i].samples << " samples)\n";
+            }
+        }
+        if(held_points_ > 0) {
+            std::cout << "    held " << held_points_ << " points for " << hold_ms_ / 1000
+                      << " s in total\n";
+        }
+        std::cout << "    log: " << csv_path_.string() << '\n' << std::defaultfloat;
+    }
+
+    private:
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    dimm_temperatures& temps_;
+    std::vector<dimm_temperatures::window> campaign_; // min/max and samples only
+    std::size_t held_points_{};
+    double hold_ms_{};
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "csv_log.hpp"
+#include "jitted.hpp"
+#include "observer.hpp"
+#include "time_utils.hpp"
+#include "traffic.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Logs the bandwidth the background traffic workers reached while each fuzz
+/// point ran, next to the point's burst and self-sync desync counts, so sync
+/// quality can be compared across load levels.
+class TrafficObserver final : public IHammerObserver {
+    public:
+    TrafficObserver(std::filesystem::path csv_path, background_traffic& traffic)
+    : csv_path_{ std::move(csv_path) }, traffic_{ traffic } {
+        csv_ = open_csv_log(csv_path_,
+                            "timestamp,reads_per_trefi,sync_cycles_threshold,plan_point,"
+                            "row_base_offsets,kind,threads,target_mbps,measured_mbps,bursts,"
+                            "desync_bursts");
+    }
+
+    void on_pre_iteration(const FuzzPoint&) override {
+        traffic_.take_window(); // drop the time between points
+    }
+
+    void on_post_iteration(const FuzzPoint& fp, const std::vector<bit_flip_t>&) override {
+        const auto w  = traffic_.take_window();
+        const auto& s = jit_last_run_stats();
+        const auto& c = traffic_.cfg();
+        csv_ << iso_timestamp() << ',' << fp.pattern_reads_per_trefi << ','
+             << fp.self_sync_threshold << ',' << fp.plan_point << ',' << fp.base_rows_string() << ',' << to_string(c.kind)
+             << ',' << c.cores.size() << ',' << c.target_mbps * c.cores.size() << ','
+             << std::fixed << std::setprecision(1) << w.mbps << std::defaultfloat << ','
+             << s.bursts << ',';
+        if(s.burst_timing) { // left empty unless measured
+            csv_ << s.desync_bursts;
+        }
+        csv_ << '\n';
+        csv_.flush();
+
+        ++points_;
+        mbps_sum_ += w.mbps;
+        if(s.burst_timing) {
+            bursts_ += s.bursts;
+            desync_ += s.desync_bursts;
+        }
+    }
+
+    void on_campaign_end() override {
+        if(points_ == 0) {
+            return;
+        }
+        std::cout << "\n[+] Background traffic (" << to_string(traffic_.cfg().kind) << ", "
+                  << traffic_.cfg().cores.size() << " threads): " << std::fixed
+                  << std::setprecision(1) << mbps_sum_ / points_ << " MB/s on average";
+        if(bursts_ > 0) {
+            std::cout << ", " << std::setprecision(4) << 100.0 * desync_ / bursts_
+                      << "% desync bursts";
+        }
+        std::cout << '\n'
+                  << std::defaultfloat << "    per point: " << csv_path_.string() << '\n';
+    }
+
+    private:
+    std::filesystem::path csv_path_;
+    std::ofstream csv_;
+    background_traffic& traffic_;
+    std::size_t points_{};
+    double mbps_sum_{};
+    uint64_t bursts_{};
+    uint64_t desync_{};
+};
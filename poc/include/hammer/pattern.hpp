@@ -1,6 +1,7 @@
 #pragma once
 #include "dram_address.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <ostream>
 #include <sstream>
@@ -48,6 +49,19 @@ hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
                                              std::size_t burst_rotation,
                                              int offset_increment);
 
+/// Same as above, but with an individual aggressor base row per bank, given in
+/// the (subchannel, rank, bank group, bank) iteration order.
+hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
+                                             const std::vector<int>& subchannels,
+                                             const std::vector<int>& ranks,
+                                             const std::vector<int>& bank_groups,
+                                             const std::vector<int>& banks,
+                                             const std::vector<int>& row_base_offsets,
+                                             int reads_per_trefi,
+                                             int column_stride,
+                                             std::size_t burst_rotation,
+                                             int offset_increment);
+
 std::vector<dram_address> pattern_aggressors(const hammer_pattern_t& pat);
 std::vector<dram_address> pattern_victims(const hammer_pattern_t& pat);
 
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// USDT probes at phase boundaries, e.g.
+//   bpftrace -e 'usdt:./phoenix:phoenix:phase_end { @[str(arg1)] = hist(arg2); }'
+// Compiled in when <sys/sdt.h> (systemtap-sdt-dev) is available; a probe
+// that is not traced costs a single nop.
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define HAMMER_PROBE1(name, a1) DTRACE_PROBE1(phoenix, name, a1)
+#define HAMMER_PROBE2(name, a1, a2) DTRACE_PROBE2(phoenix, name, a1, a2)
+#define HAMMER_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(phoenix, name, a1, a2, a3)
+#else
+#define HAMMER_PROBE1(name, a1) ((void)0)
+#define HAMMER_PROBE2(name, a1, a2) ((void)0)
+#define HAMMER_PROBE3(name, a1, a2, a3) ((void)0)
+#endif
+
+/// Phases of one fuzz point in the sweep loop.
+enum class sweep_phase : int {
+    assemble,     // pattern assembly
+    victims,      // aggressor/victim derivation
+    data_init,    // row initialization
+    jit_compile,  // code generation and placement
+    hammer,       // executing the generated code
+    scan,         // victim scan for bit flips
+    observers,    // observer callbacks
+    integrity,    // full-allocation integrity check
+    thermal_hold, // waiting for the DIMM temperature band
+};
+
+inline constexpr std::size_t kNumSweepPhases = 9;
+
+std::string_view to_string(sweep_phase phase);
+
+/// Log2 histogram of phase durations in nanoseconds.
+struct phase_histogram {
+    static constexpr std::size_t kBuckets = 40; // bucket i: [2^i, 2^(i+1)) ns
+
+    uint64_t count{};
+    double sum_ns{};
+    double min_ns{};
+    double max_ns{};
+    std::array<uint64_t, kBuckets> buckets{};
+
+    void add(double ns);
+    /// Upper bound of the bucket containing quantile @p q.
+    double quantile_ns(double q) const;
+};
+
+/// Per-phase TSC cycles of a single fuzz point.
+using phase_timings = std::array<uint64_t, kNumSweepPhases>;
+
+/// Accounts TSC cycles to the innermost active phase, so nested phases (e.g.
+/// hammer inside jit_compile) are counted exclusively, and aggregates the
+/// per-point timings into one histogram per phase.
+class phase_profiler {
+    public:
+    phase_profiler();
+
+    void push(sweep_phase phase);
+    void pop();
+
+    /// Timings of the current fuzz point so far.
+    const phase_timings& current() const {
+        return current_;
+    }
+    /// Adds the current point to the histograms and starts the next one.
+    void end_point();
+
+    const phase_histogram& histogram(sweep_phase phase) const {
+        return histograms_[static_cast<int>(phase)];
+    }
+    uint64_t points() const {
+        return points_;
+    }
+
+    /// Per-phase totals, shares of the wall time and percentiles.
+    void print_summary(std::ostream& os) const;
+
+    private:
+    void account(uint64_t now);
+
+    std::vector<sweep_phase> stack_;
+    uint64_t last_{};
+    uint64_t start_{};
+    phase_timings current_{};
+    std::array<phase_histogram, kNumSweepPhases> histograms_{};
+    uint64_t points_{};
+};
+
+/// Times the enclosing scope as @p phase; no-op if @p profiler is nullptr.
+class scoped_phase {
+    public:
+    scoped_phase(phase_profiler* profiler, sweep_phase phase)
+    : profiler_{ profiler } {
+        if(profiler_) {
+            profiler_->push(phase);
+        }
+    }
+    ~scoped_phase() {
+        if(profiler_) {
+            profiler_->pop();
+        }
+    }
+
+    scoped_phase(const scoped_phase&)            = delete;
+    scoped_phase& operator=(const scoped_phase&) = delete;
+
+    private:
+    phase_profiler* profiler_;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Host/DIMM properties a calibration is valid for, e.g. "cpu_model",
+/// "microcode", "dimm_serial", "bios_version".
+using host_fingerprint = std::map<std::string, std::string>;
+
+/// Fingerprint fields that identify *which* host/DIMM a profile belongs to.
+/// All other fields only decide whether the stored calibration is still valid.
+inline const std::vector<std::string> kProfileIdentityFields{ "cpu_model", "dimm_part", "dimm_serial" };
+
+/// Calibrated and winning parameters of previous campaigns on one host/DIMM.
+struct calibration_profile {
+    host_fingerprint fingerprint;
+
+    std::string pattern_id;
+    int ref_threshold{};
+    int column_stride{};
+
+    // Fuzz point with the most bit flips.
+    int best_reads_per_trefi{};
+    int best_self_sync_cycles{};
+    std::size_t best_flips{};
+
+    // Range of values that produced at least one bit flip.
+    int reads_per_trefi_min{};
+    int reads_per_trefi_max{};
+    int self_sync_cycles_min{};
+    int self_sync_cycles_max{};
+
+    std::string updated;
+};
+
+class profile_store {
+    public:
+    explicit profile_store(std::filesystem::path dir)
+    : dir_{ std::move(dir) } {
+    }
+
+    /// Load the profile for @p fp. A profile whose non-identity fields differ
+    /// from @p fp is invalidated (renamed to *.stale) and the differing field
+    /// names are reported through @p changed.
+    std::optional<calibration_profile> load(const host_fingerprint& fp,
+                                            std::vector<std::string>* changed = nullptr) const;
+
+    void save(const calibration_profile& profile) const;
+
+    /// Drop the profile for @p fp; returns false if there was none.
+    bool invalidate(const host_fingerprint& fp) const;
+
+    [[nodiscard]] std::filesystem::path path_for(const host_fingerprint& fp) const;
+
+    private:
+    std::filesystem::path dir_;
+};
+
+/// Values of @p full within [lo - step, hi + step], i.e. the previously
+/// working range plus one step of margin on either side; @p full itself if
+/// none of its values fall into that range.
+std::vector<int> narrow_range(const std::vector<int>& full, int lo, int hi);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <csignal>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+
+struct resctrl_params {
+    /// L3 ways reserved for the hammer thread and removed from the default group.
+    unsigned l3_ways{ 4 };
+    /// MB schemata value of the default group while hammering (percent on
+    /// Intel, 1/8 GB/s units on AMD); negative leaves bandwidth alone.
+    int mba{ -1 };
+    std::string group{ "phoenix" };
+    std::filesystem::path root{ "/sys/fs/resctrl" };
+};
+
+/// Isolates the hammer thread from the rest of the host through resctrl:
+/// a dedicated resctrl group with its own L3 ways (L3 CAT), and optionally a
+/// memory bandwidth cap (MBA) on the default group during hammer windows.
+/// Everything is restored on destruction, and on SIGINT/SIGTERM by a watcher
+/// thread the signal handler wakes through a self-pipe.
+class resctrl_isolation {
+    public:
+    /// True if resctrl is mounted and supports L3 allocation.
+    static bool available(const std::filesystem::path& root = "/sys/fs/resctrl");
+
+    /// Creates the group and partitions the L3 ways; throws std::runtime_error
+    /// if resctrl is unavailable or rejects the configuration.
+    resctrl_isolation(resctrl_params params, pid_t tid);
+    ~resctrl_isolation();
+
+    resctrl_isolation(const resctrl_isolation&)            = delete;
+    resctrl_isolation& operator=(const resctrl_isolation&) = delete;
+
+    /// Move the thread into (true) or out of (false) the isolated group and
+    /// apply or undo the L3 partitioning, e.g. to compare both conditions.
+    void set_enabled(bool enabled);
+    bool enabled() const {
+        return enabled_;
+    }
+
+    /// Cap the default group's bandwidth until end_hammer(), if configured.
+    void begin_hammer();
+    void end_hammer();
+
+    std::string describe() const;
+
+    /// Undo all changes; safe to call more than once and from any thread.
+    void restore() noexcept;
+
+    private:
+    void write_schemata(const std::filesystem::path& group_dir, const std::string& line);
+    void write_task(const std::filesystem::path& group_dir);
+    void unthrottle();
+    void start_signal_watcher();
+    void stop_signal_watcher();
+
+    resctrl_params params_;
+    pid_t tid_;
+    std::filesystem::path group_dir_;
+    // Original default group schemata lines by resource ("L3", "MB")
+    std::map<std::string, std::string> root_schemata_;
+    std::string group_l3_, root_l3_, root_mb_;
+    bool enabled_{ false };
+    bool throttled_{ false };
+    bool restored_{ false };
+    // Serializes restore() from the signal watcher with the calling thread
+    std::mutex mutex_;
+    int signal_pipe_[2]{ -1, -1 };
+    std::thread signal_watcher_;
+    struct sigaction old_sigint_ {};
+    struct sigaction old_sigterm_ {};
+};
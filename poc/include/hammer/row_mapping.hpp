@@ -0,0 +1,70 @@
+#pragma once
+
+#include "bit_flips.hpp"
+#include "dram_address.hpp"
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/// DIMM-internal row remapping: logical rows, as addressed by the memory
+/// controller, to physical rows, as laid out in the cell array. Same schemes
+/// as DramRowMapping of the FPGA experiments.
+enum class row_remap {
+    direct,  // physical = logical
+    samsung, // bit 3 flips bits 1 and 2 (Samsung and Micron)
+};
+
+inline constexpr std::array<row_remap, 2> kRowRemaps{ row_remap::direct, row_remap::samsung };
+/// Every scheme maps blocks of this many rows onto themselves.
+inline constexpr std::size_t kRowRemapPeriod = 16;
+
+std::string_view to_string(row_remap remap);
+/// Accepts "micron" as an alias of samsung; throws std::invalid_argument otherwise.
+row_remap parse_row_remap(std::string_view name);
+
+size_t to_physical_row(row_remap remap, size_t logical);
+size_t to_logical_row(row_remap remap, size_t physical);
+
+/// Logical row at physical distance @p distance from @p logical, if it exists.
+std::optional<size_t> physical_neighbour(row_remap remap, size_t logical, long distance);
+
+/// Remapping through which aggressor pairs and victim rows are chosen
+/// (default: direct).
+void set_row_remap(row_remap remap);
+row_remap active_row_remap();
+
+/// While the remapping is unknown, victims are the physical neighbours of the
+/// aggressors under every known scheme, so flips show which one is right.
+void set_row_remap_learning(bool enable);
+bool row_remap_learning();
+
+/// Learns the remapping from flips: a flipped row counts for every scheme
+/// under which it is physically adjacent to one of the rows hammered.
+class row_adjacency_inference {
+    public:
+    struct score {
+        row_remap remap;
+        std::size_t explained; // flipped rows adjacent to an aggressor
+    };
+
+    void record(const std::vector<dram_address>& aggressors, const std::vector<bit_flip_t>& flips);
+
+    /// Schemes ordered by flipped rows explained, best first.
+    std::vector<score> scores() const;
+
+    /// Flipped rows recorded (each row once per fuzz point).
+    std::size_t rows() const {
+        return rows_;
+    }
+
+    /// The best scheme, once it explains at least @p min_lead flipped rows more
+    /// than the runner-up.
+    std::optional<row_remap> decide(std::size_t min_lead) const;
+
+    private:
+    std::size_t rows_{};
+    std::array<std::size_t, kRowRemaps.size()> explained_{};
+};
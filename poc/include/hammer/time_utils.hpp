@@ -1,8 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <string>
+#include <x86intrin.h>
 
 /// ISO‑8601 timestamp (local time) – "YYYY-MM-DDTHH:MM:SS"
 inline std::string iso_timestamp() {
@@ -31,3 +33,23 @@ inline std::string ymd_hms_timestamp() {
     std::strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", &tm);
     return buf;
 }
+
+/// TSC read that waits for all earlier loads to complete.
+inline uint64_t tsc_now() {
+    unsigned aux;
+    return __rdtscp(&aux);
+}
+
+/// TSC frequency, measured once against steady_clock over 50 ms.
+inline double tsc_cycles_per_ns() {
+    static const double cycles_per_ns = [] {
+        const auto t0     = std::chrono::steady_clock::now();
+        const uint64_t c0 = tsc_now();
+        while(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(50)) {
+        }
+        const uint64_t c1 = tsc_now();
+        const std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - t0;
+        return (c1 - c0) / ns.count();
+    }();
+    return cycles_per_ns;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class traffic_kind {
+    stream, // sequential reads
+    chase,  // dependent loads along a random cycle through the buffer
+    write,  // sequential non-temporal full-line stores
+};
+
+std::string_view to_string(traffic_kind kind);
+/// Throws std::invalid_argument for an unknown name.
+traffic_kind parse_traffic_kind(std::string_view name);
+
+/// Memory traffic from worker threads on other cores than the hammer core,
+/// each on its own buffer outside the test allocation, to see how
+/// synchronization holds up on a loaded host. Workers run from construction
+/// to destruction, throttled to a target bandwidth if one is given.
+class background_traffic {
+    public:
+    struct config {
+        traffic_kind kind{ traffic_kind::stream };
+        std::vector<int> cores;        // one worker per core
+        std::size_t buffer_bytes{};    // per worker, should exceed the LLC
+        double target_mbps{};          // per worker, 0 = as fast as possible
+    };
+
+    /// Bandwidth of all workers together over a window.
+    struct window {
+        double seconds{};
+        double mbps{};
+    };
+
+    /// Throws std::invalid_argument if a core is @p hammer_core and
+    /// std::runtime_error if a buffer cannot be mapped.
+    background_traffic(config cfg, int hammer_core);
+    ~background_traffic();
+
+    background_traffic(const background_traffic&)            = delete;
+    background_traffic& operator=(const background_traffic&) = delete;
+
+    const config& cfg() const {
+        return cfg_;
+    }
+
+    /// Bandwidth since the previous call; starts a new window.
+    window take_window();
+
+    private:
+    struct worker {
+        void* buffer{ nullptr };
+        alignas(64) std::atomic<uint64_t> bytes{};
+    };
+
+    void run(worker& w, int cpu);
+
+    config cfg_;
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> quit_{ false };
+    std::chrono::steady_clock::time_point window_start_;
+    uint64_t window_bytes_{};
+};
@@ -0,0 +1,90 @@
+#include <hammer/activations.hpp>
+#include <hammer/row_mapping.hpp>
+
+#include <algorithm>
+#include <limits>
+
+activation_model::activation_model(const hammer_pattern_t& pattern,
+                                   std::size_t refresh_window_trefis)
+: pattern_length_{ pattern.size() }, window_{ refresh_window_trefis } {
+    using bank_key = std::tuple<size_t, size_t, size_t, size_t>;
+    for(std::size_t b = 0; b < pattern.size(); ++b) {
+        std::map<bank_key, size_t> open_row; // reset by the REF before every burst
+        for(const auto& a : pattern[b]) {
+            const bank_key bank{ a.subchannel(), a.rank(), a.bank_group(), a.bank() };
+            const auto open = open_row.find(bank);
+            if(open != open_row.end() && open->second == a.row()) {
+                continue; // row hit, no ACT
+            }
+            open_row[bank] = a.row();
+
+            const row_key key{ a.subchannel(), a.rank(), a.bank_group(), a.bank(), a.row() };
+            const auto [it, inserted] = rows_.try_emplace(key, per_burst_.size());
+            if(inserted) {
+                per_burst_.emplace_back(pattern.size(), 0);
+            }
+            ++per_burst_[it->second][b];
+        }
+    }
+
+    // Prefix sums over two pattern periods, so any window remainder starting
+    // at phase p is prefix[p + r] - prefix[p]
+    prefix_.resize(per_burst_.size());
+    for(std::size_t r = 0; r < per_burst_.size(); ++r) {
+        prefix_[r].assign(2 * pattern_length_ + 1, 0);
+        for(std::size_t i = 0; i < 2 * pattern_length_; ++i) {
+            prefix_[r][i + 1] = prefix_[r][i] + per_burst_[r][i % pattern_length_];
+        }
+    }
+}
+
+uint64_t activation_model::window_acts(std::size_t row, std::size_t phase) const {
+    const auto& prefix    = prefix_[row];
+    const uint64_t period = prefix[pattern_length_];
+    const std::size_t rem = window_ % pattern_length_;
+    return (window_ / pattern_length_) * period + prefix[phase + rem] - prefix[phase];
+}
+
+activation_model::victim_acts activation_model::for_victim(const dram_address& victim) const {
+    victim_acts out;
+    if(pattern_length_ == 0) {
+        return out;
+    }
+    // Physical neighbours under the DIMM's row remapping
+    auto find_row = [&](long distance) -> long {
+        const auto row = physical_neighbour(active_row_remap(), victim.row(), distance);
+        if(!row) {
+            return -1;
+        }
+        const auto it = rows_.find(
+            { victim.subchannel(), victim.rank(), victim.bank_group(), victim.bank(), *row });
+        return it == rows_.end() ? -1 : static_cast<long>(it->second);
+    };
+    const long below = find_row(-1);
+    const long above = find_row(1);
+    if(below < 0 && above < 0) {
+        return out;
+    }
+
+    constexpr uint64_t kNone = std::numeric_limits<uint64_t>::max();
+    out.below_min = out.above_min = out.hc_min = kNone;
+    for(std::size_t phase = 0; phase < pattern_length_; ++phase) {
+        const uint64_t lo = below >= 0 ? window_acts(below, phase) : 0;
+        const uint64_t hi = above >= 0 ? window_acts(above, phase) : 0;
+        const uint64_t hc = below < 0 ? hi : above < 0 ? lo : std::min(lo, hi);
+        out.below_min     = std::min(out.below_min, lo);
+        out.below_max     = std::max(out.below_max, lo);
+        out.above_min     = std::min(out.above_min, hi);
+        out.above_max     = std::max(out.above_max, hi);
+        out.hc_min        = std::min(out.hc_min, hc);
+        out.hc_max        = std::max(out.hc_max, hc);
+    }
+    for(long row : { below, above }) {
+        if(row >= 0) {
+            const auto& bursts = per_burst_[row];
+            out.max_per_trefi  = std::max<uint64_t>(out.max_per_trefi,
+                                                   *std::max_element(bursts.begin(), bursts.end()));
+        }
+    }
+    return out;
+}
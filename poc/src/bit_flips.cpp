@@ -1,55 +1,61 @@
 #include <hammer/bit_flips.hpp>
 #include <hammer/dram_address.hpp>
+#include <hammer/kernels.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <emmintrin.h>
 #include <immintrin.h>
-#include <unordered_set>
+#include <tuple>
 #include <vector>
 
+// Patterns reference the same row at many columns; reduce to one address per row.
+static std::vector<dram_address> unique_rows(const std::vector<dram_address>& addrs) {
+    std::vector<dram_address> rows;
+    rows.reserve(addrs.size());
+    for(const auto& da : addrs) {
+        rows.emplace_back(da.subchannel(), da.rank(), da.bank_group(), da.bank(), da.row(), 0);
+    }
+
+    auto key = [](const dram_address& a) {
+        return std::make_tuple(a.subchannel(), a.rank(), a.bank_group(), a.bank(), a.row());
+    };
+    std::sort(rows.begin(), rows.end(),
+              [&](const dram_address& a, const dram_address& b) { return key(a) < key(b); });
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
 std::vector<bit_flip_t> collect_bit_flips(const std::vector<dram_address>& dram_addresses_victims,
                                           const uint64_t data_pattern_victim) {
     // Interpret the 8-byte data pattern as individual bytes.
     const auto* pattern_bytes = reinterpret_cast<const uint8_t*>(&data_pattern_victim);
+    const auto& k             = kernels();
 
     std::vector<bit_flip_t> found_bitflips;
 
-    // Remove all duplicates
-    std::unordered_set<uintptr_t> all_victim_vaddrs;
-    for(auto da : dram_addresses_victims) {
-        for(auto vaddr : da.get_vaddrs_whole_row()) {
-            // reinterpret the value as an integer we can mask
-            auto addr = reinterpret_cast<uint64_t>(vaddr);
+    for(const auto& row : unique_rows(dram_addresses_victims)) {
+        for(auto line : row.get_vaddrs_row_lines()) {
+            // Make sure we do not read a cached value, but actually from DRAM.
+            _mm_clflushopt(const_cast<char*>(line));
+            _mm_mfence();
 
-            // insert only if 8-byte aligned (i.e. the lower 3 bits are zero)
-            if((addr & (alignof(uint64_t) - 1)) == 0) { // alignof(uint64_t) == 8
-                all_victim_vaddrs.insert(addr);
+            uint64_t mismatches = k.scan_line(line, data_pattern_victim);
+            if(mismatches == 0) {
+                _mm_clflushopt(const_cast<char*>(line));
+                continue;
             }
-        }
-    }
 
-    // Go through all the victim addresses in steps of 8 bytes.
-    for(auto vaddr : all_victim_vaddrs) {
-        // Make sure we do not read a cached value, but actually from DRAM.
-        _mm_clflushopt((void*)vaddr);
-        _mm_mfence();
-
-        // Iterate over each byte in the 8-byte data pattern.
-        const auto value_ptr = reinterpret_cast<volatile uint8_t*>(vaddr);
-        for(int i = 0; i < 8; ++i) {
-            uint8_t actual_byte   = value_ptr[i];
-            uint8_t expected_byte = pattern_bytes[i];
-            if(actual_byte != expected_byte) {
-                auto addr = dram_address::from_virt(
-                    reinterpret_cast<const volatile char*>(vaddr + i));
-                found_bitflips.push_back({ addr, expected_byte, actual_byte });
+            for(; mismatches != 0; mismatches &= mismatches - 1) {
+                auto i    = static_cast<size_t>(__builtin_ctzll(mismatches));
+                auto addr = dram_address::from_virt(line + i);
+                found_bitflips.push_back({ addr, pattern_bytes[i % sizeof(uint64_t)],
+                                           static_cast<uint8_t>(line[i]) });
             }
-        }
 
-        // Restore the original value of the entire 8-byte pattern.
-        volatile auto* addr = reinterpret_cast<volatile uint64_t*>(vaddr);
-        *addr               = data_pattern_victim;
-        _mm_clflushopt((void*)value_ptr);
+            // Restore the original content of the line (flushes it as well).
+            k.fill_line(line, data_pattern_victim);
+        }
     }
 
     return found_bitflips;
@@ -57,15 +63,10 @@ std::vector<bit_flip_t> collect_bit_flips(const std::vector<dram_address>& dram_
 
 void initialize_data_pattern(const std::vector<dram_address>& dram_addresses_aggs,
                              uint64_t data_pattern) {
-    for(const auto& da : dram_addresses_aggs) {
-        auto row = da.get_whole_row();
-
-        for(size_t i = 0; i < row.size(); i += 8) {
-            if(row[i].column() % 8 == 0) {
-                auto vaddr                                   = row[i].to_virt();
-                *reinterpret_cast<volatile uint64_t*>(vaddr) = data_pattern;
-                _mm_clflushopt(const_cast<void*>(static_cast<const volatile void*>(vaddr)));
-            }
+    const auto& k = kernels();
+    for(const auto& row : unique_rows(dram_addresses_aggs)) {
+        for(auto line : row.get_vaddrs_row_lines()) {
+            k.fill_line(line, data_pattern);
         }
     }
     _mm_mfence();
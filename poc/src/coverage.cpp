@@ -0,0 +1,89 @@
+#include <hammer/coverage.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+// Visit order 0, R/2, R/4, 3R/4, ... (van der Corput) restricted to [0, n).
+static std::vector<int> spread_order(int n) {
+    int bits = 0;
+    while((1 << bits) < n) {
+        bits++;
+    }
+
+    std::vector<int> order;
+    order.reserve(n);
+    for(int i = 0; i < (1 << bits); i++) {
+        int rev = 0;
+        for(int b = 0; b < bits; b++) {
+            if(i & (1 << b)) {
+                rev |= 1 << (bits - 1 - b);
+            }
+        }
+        if(rev < n) {
+            order.push_back(rev);
+        }
+    }
+    return order;
+}
+
+std::vector<coverage_point> plan_coverage(const coverage_plan_params& p) {
+    const int span = p.footprint_hi - p.footprint_lo + 1;
+    if(p.num_banks == 0 || p.rows_per_bank <= 0 || p.region_rows <= 0 || span <= 0) {
+        throw std::invalid_argument("coverage plan: invalid geometry");
+    }
+    if(span > p.region_rows) {
+        throw std::invalid_argument(
+            "coverage plan: pattern footprint exceeds region size");
+    }
+
+    // STEP 1: Tile each region with non-overlapping footprints.
+    std::vector<std::vector<int>> placements;
+    for(int start = 0; start < p.rows_per_bank; start += p.region_rows) {
+        const int end = std::min(start + p.region_rows, p.rows_per_bank);
+
+        std::vector<int> bases;
+        for(int lo = start; lo + span <= end; lo += span) {
+            const int hi = lo + span;
+            if(lo < p.excluded_row_end && p.excluded_row_start < hi) {
+                continue;
+            }
+            bases.push_back(lo - p.footprint_lo);
+        }
+        if(!bases.empty()) {
+            placements.push_back(std::move(bases));
+        }
+    }
+    if(placements.empty()) {
+        throw std::invalid_argument("coverage plan: no placement fits");
+    }
+
+    // STEP 2: Interleave regions and stagger the banks across them.
+    const int num_regions = static_cast<int>(placements.size());
+    const auto order      = spread_order(num_regions);
+    const int bank_shift =
+        std::max(1, num_regions / static_cast<int>(p.num_banks));
+
+    std::size_t rounds = 0;
+    for(const auto& bases : placements) {
+        rounds = std::max(rounds, bases.size());
+    }
+
+    std::vector<coverage_point> plan;
+    for(std::size_t round = 0; round < rounds; round++) {
+        for(int step = 0; step < num_regions; step++) {
+            coverage_point point;
+            point.base_rows.reserve(p.num_banks);
+            for(std::size_t bank = 0; bank < p.num_banks; bank++) {
+                const int slot = (step + static_cast<int>(bank) * bank_shift) % num_regions;
+                const auto& bases = placements[order[slot]];
+                point.base_rows.push_back(bases[round % bases.size()]);
+            }
+            plan.push_back(std::move(point));
+
+            if(p.max_points != 0 && plan.size() == p.max_points) {
+                return plan;
+            }
+        }
+    }
+    return plan;
+}
@@ -1,11 +1,14 @@
 #include <hammer/dram_address.hpp>
+#include <hammer/kernels.hpp>
 
 #include <array>
 #include <bit>
 #include <cassert>
 #include <cmath>
+#include <initializer_list>
 #include <iostream>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #define MATRIX_SIZE 30
@@ -16,9 +19,37 @@
 
 using matrix_t = std::array<size_t, MATRIX_SIZE>;
 
+/// Address functions of one platform as reverse engineered: XOR functions for
+/// the subchannel, rank, bank group and bank bits, plain masks for row and column.
+struct mapping_spec {
+    struct func_list {
+        std::array<size_t, 4> funcs{};
+        size_t count{};
 
-static allocation* s_alloc;
-static struct {
+        constexpr func_list(std::initializer_list<size_t> list) {
+            for(auto func : list) {
+                funcs[count++] = func;
+            }
+        }
+        constexpr const size_t* begin() const {
+            return funcs.data();
+        }
+        constexpr const size_t* end() const {
+            return funcs.data() + count;
+        }
+    };
+
+    const char* name;
+    size_t phys_linear_offset;
+    func_list subchannel_funcs;
+    func_list rank_funcs;
+    func_list bank_group_funcs;
+    func_list bank_funcs;
+    size_t row_mask;
+    size_t column_mask;
+};
+
+struct mapping_config {
     size_t phys_linear_offset{};
 
     size_t subchannel_shift{};
@@ -36,24 +67,61 @@ static struct {
 
     matrix_t linear_to_dram_matrix{};
     matrix_t dram_to_linear_matrix{};
-} s_config;
+};
+
+// The AMD Zen 4 mappings known at build time.
+static constexpr mapping_spec kZen4OneRank16GiB{
+    "zen4-1r-16g", MB(2048),
+    /* subchannel */ { 0x3fffc0040 },
+    /* rank */ {},
+    /* bank group */ { 0x042100100, 0x084200200, 0x108401000 },
+    /* bank */ { 0x210840400, 0x021080800 },
+    /* row */ 0x3fffc0000,
+    /* column */ 0x00003e0bf,
+};
+
+static constexpr mapping_spec kZen4OneRank8GiB{
+    "zen4-1r-8g", MB(2048),
+    /* subchannel */ { 0x3ffe0040 },
+    /* rank */ {},
+    /* bank group */ { 0x08880100, 0x11100200 },
+    /* bank */ { 0x22220400, 0x4440800 },
+    /* row */ 0x3ffe0000,
+    /* column */ 0x0001f0bf,
+};
+
+static constexpr mapping_spec kZen4TwoRanks{
+    "zen4-2r", MB(2048),
+    /* subchannel */ { 0x7fff80040 },
+    /* rank */ { 0x40000 },
+    /* bank group */ { 0x84200100, 0x108400200, 0x210801000 },
+    /* bank */ { 0x421080400, 0x42100800 },
+    /* row */ 0x07fff80000,
+    /* column */ 0x00003e0bf,
+};
+
+/// Translation between a linear offset within the 2^30 bytes covered by the
+/// matrix and a DRAM address.
+struct mapping_fns {
+    const char* name;
+    dram_address (*from_linear)(size_t linear);
+    size_t (*to_linear)(const dram_address& addr);
+};
+
+static allocation* s_alloc;
+static mapping_config s_config;
+static const mapping_fns* s_fixed;    // compile-time translation of the platform, if any
+static const mapping_fns* s_translate; // active translation
 
 int parity(unsigned long long x) {
     return __builtin_popcountll(x) % 2;
 }
 
 static size_t apply_matrix(matrix_t const& matrix, size_t addr) {
-    size_t result = 0;
-    for(size_t i = 0; i < MATRIX_SIZE; i++) {
-        auto bit = parity(matrix[i] & addr);
-        if(bit) {
-            result |= BIT_SET(i);
-        }
-    }
-    return result;
+    return kernels().apply_matrix(matrix.data(), MATRIX_SIZE, addr);
 }
 
-static matrix_t compute_inverse(matrix_t input) {
+static constexpr matrix_t compute_inverse(matrix_t input) {
     // Set result to the identity matrix.
     matrix_t result{};
     for(size_t i = 0; i < MATRIX_SIZE; i++) {
@@ -108,79 +176,22 @@ static matrix_t compute_inverse(matrix_t input) {
     return result;
 }
 
-static auto initialize_config(int dimm_size_gib, int dimm_ranks) {
-    size_t phys_linear_offset = 0;
-    std::vector<size_t> subchannel_funcs;
-    std::vector<size_t> rank_funcs;
-    std::vector<size_t> bank_group_funcs;
-    std::vector<size_t> bank_funcs;
-    size_t row_mask    = 0;
-    size_t column_mask = 0;
-    printf("[+] Initializing config for AMD Zen 4, %d rank(s).\n", dimm_ranks);
-
-    if(dimm_ranks == 1) {                        // NOLINT
-        bool use_16_gib = (dimm_size_gib >= 12); // nearer 16 GiB than 8 GiB?
-        if(use_16_gib) { /* 8 bankgroups, 16 GiB DIMM size */
-            phys_linear_offset = MB(2048);
-            subchannel_funcs.push_back(0x3fffc0040);
-            bank_group_funcs.push_back(0x042100100);
-            bank_group_funcs.push_back(0x084200200);
-            bank_group_funcs.push_back(0x108401000);
-            bank_funcs.push_back(0x210840400);
-            bank_funcs.push_back(0x021080800);
-            row_mask    = 0x3fffc0000;
-            column_mask = 0x00003e0bf;
-        } else { /* 4 bankgroups, 8 GiB DIMM size */
-            phys_linear_offset = MB(2048);
-            subchannel_funcs.push_back(0x3ffe0040);
-            bank_group_funcs.push_back(0x08880100);
-            bank_group_funcs.push_back(0x11100200);
-            bank_funcs.push_back(0x22220400);
-            bank_funcs.push_back(0x4440800);
-            row_mask    = 0x3ffe0000;
-            column_mask = 0x0001f0bf;
-        }
-    } else if(dimm_ranks == 2) { // NOLINT
-        phys_linear_offset = MB(2048);
-        rank_funcs.push_back(0x40000);
-        subchannel_funcs.push_back(0x7fff80040);
-        bank_group_funcs.push_back(0x84200100);
-        bank_group_funcs.push_back(0x108400200);
-        bank_group_funcs.push_back(0x210801000);
-        bank_funcs.push_back(0x421080400);
-        bank_funcs.push_back(0x42100800);
-        row_mask    = 0x07fff80000;
-        column_mask = 0x00003e0bf;
-    } else {
-        exit(EXIT_FAILURE);
-    }
+static constexpr mapping_config build_config(const mapping_spec& spec) {
+    mapping_config config{};
 
     // STEP 1: Check that the offset is divisible by the mapping covered by the matrix, ensuring the MSBs stay the same.
-    assert(phys_linear_offset % (1ULL << MATRIX_SIZE) == 0);
-    s_config.phys_linear_offset = phys_linear_offset;
+    assert(spec.phys_linear_offset % (1ULL << MATRIX_SIZE) == 0);
+    config.phys_linear_offset = spec.phys_linear_offset;
 
     // STEP 2: Mask all functions to the 30 bits we have available.
-    constexpr size_t MASK = BIT_SET(MATRIX_SIZE) - 1;
-    for(auto& func : subchannel_funcs) {
-        func &= MASK;
-    }
-    for(auto& func : rank_funcs) {
-        func &= MASK;
-    }
-    for(auto& func : bank_group_funcs) {
-        func &= MASK;
-    }
-    for(auto& func : bank_funcs) {
-        func &= MASK;
-    }
-    row_mask &= MASK;
-    column_mask &= MASK;
+    const size_t row_mask    = spec.row_mask & MATRIX_MASK;
+    const size_t column_mask = spec.column_mask & MATRIX_MASK;
 
     // STEP 3: Check we have the correct number of functions.
-    auto row_bits    = __builtin_popcountll(row_mask);
-    auto column_bits = __builtin_popcountll(column_mask);
-    auto total_bits  = subchannel_funcs.size() + rank_funcs.size() +
-        bank_group_funcs.size() + bank_funcs.size() + row_bits + column_bits;
+    const size_t row_bits    = std::popcount(row_mask);
+    const size_t column_bits = std::popcount(column_mask);
+    const size_t total_bits  = spec.subchannel_funcs.count + spec.rank_funcs.count +
+        spec.bank_group_funcs.count + spec.bank_funcs.count + row_bits + column_bits;
     if(total_bits != MATRIX_SIZE) {
         printf("Configuration yields %zu address functions, not %d (as "
                "required).",
@@ -196,18 +207,18 @@ static auto initialize_config(int dimm_size_gib, int dimm_ranks) {
         return mask;
     };
 
-    s_config.column_shift     = bits_used;
-    s_config.column_mask      = create_mask_with_bit_count(column_bits);
-    s_config.row_shift        = bits_used;
-    s_config.row_mask         = create_mask_with_bit_count(row_bits);
-    s_config.bank_shift       = bits_used;
-    s_config.bank_mask        = create_mask_with_bit_count(bank_funcs.size());
-    s_config.bank_group_shift = bits_used;
-    s_config.bank_group_mask = create_mask_with_bit_count(bank_group_funcs.size());
-    s_config.rank_shift      = bits_used;
-    s_config.rank_mask       = create_mask_with_bit_count(rank_funcs.size());
-    s_config.subchannel_shift = bits_used;
-    s_config.subchannel_mask = create_mask_with_bit_count(subchannel_funcs.size());
+    config.column_shift     = bits_used;
+    config.column_mask      = create_mask_with_bit_count(column_bits);
+    config.row_shift        = bits_used;
+    config.row_mask         = create_mask_with_bit_count(row_bits);
+    config.bank_shift       = bits_used;
+    config.bank_mask        = create_mask_with_bit_count(spec.bank_funcs.count);
+    config.bank_group_shift = bits_used;
+    config.bank_group_mask  = create_mask_with_bit_count(spec.bank_group_funcs.count);
+    config.rank_shift       = bits_used;
+    config.rank_mask        = create_mask_with_bit_count(spec.rank_funcs.count);
+    config.subchannel_shift = bits_used;
+    config.subchannel_mask  = create_mask_with_bit_count(spec.subchannel_funcs.count);
 
     // Sanity check.
     assert(bits_used == MATRIX_SIZE);
@@ -216,31 +227,165 @@ static auto initialize_config(int dimm_size_gib, int dimm_ranks) {
     size_t i = 0;
     for(size_t bit = 0; bit < MATRIX_SIZE; bit++) {
         if(BIT_SET(bit) & column_mask) {
-            s_config.linear_to_dram_matrix[i++] = BIT_SET(bit);
+            config.linear_to_dram_matrix[i++] = BIT_SET(bit);
         }
     }
     for(size_t bit = 0; bit < MATRIX_SIZE; bit++) {
         if(BIT_SET(bit) & row_mask) {
-            s_config.linear_to_dram_matrix[i++] = BIT_SET(bit);
+            config.linear_to_dram_matrix[i++] = BIT_SET(bit);
         }
     }
-    for(auto func : bank_funcs) {
-        s_config.linear_to_dram_matrix[i++] = func;
-    }
-    for(auto func : bank_group_funcs) {
-        s_config.linear_to_dram_matrix[i++] = func;
-    }
-    for(auto func : rank_funcs) {
-        s_config.linear_to_dram_matrix[i++] = func;
-    }
-    for(auto func : subchannel_funcs) {
-        s_config.linear_to_dram_matrix[i++] = func;
+    for(const auto* funcs : { &spec.bank_funcs, &spec.bank_group_funcs, &spec.rank_funcs,
+                              &spec.subchannel_funcs }) {
+        for(auto func : *funcs) {
+            config.linear_to_dram_matrix[i++] = func & MATRIX_MASK;
+        }
     }
     // Sanity check.
     assert(i == MATRIX_SIZE);
 
     // STEP 6: Make dram_to_linear_matrix the inverse of linear_to_dram_matrix.
-    s_config.dram_to_linear_matrix = compute_inverse(s_config.linear_to_dram_matrix);
+    config.dram_to_linear_matrix = compute_inverse(config.linear_to_dram_matrix);
+
+    return config;
+}
+
+/*──────────────────── compile-time translation ───────────────────*/
+
+/// A matrix split into output bits that copy a single input bit, grouped by
+/// shift distance so each group is one shift and one AND, and output bits
+/// that are the parity of several input bits.
+struct matrix_plan {
+    struct move {
+        int shift; // output bit = input bit + shift
+        size_t mask;
+    };
+    std::array<move, MATRIX_SIZE> moves{};
+    size_t move_count{};
+    std::array<size_t, MATRIX_SIZE> parity_funcs{};
+    std::array<size_t, MATRIX_SIZE> parity_bits{};
+    size_t parity_count{};
+};
+
+static constexpr matrix_plan make_plan(const matrix_t& matrix) {
+    matrix_plan plan{};
+    for(size_t out = 0; out < MATRIX_SIZE; out++) {
+        if(std::popcount(matrix[out]) != 1) {
+            plan.parity_funcs[plan.parity_count] = matrix[out];
+            plan.parity_bits[plan.parity_count++] = out;
+            continue;
+        }
+        const int shift = (int)out - std::countr_zero(matrix[out]);
+        size_t m        = 0;
+        while(m < plan.move_count && plan.moves[m].shift != shift) {
+            m++;
+        }
+        if(m == plan.move_count) {
+            plan.moves[plan.move_count++] = { shift, 0 };
+        }
+        plan.moves[m].mask |= BIT_SET(out);
+    }
+    return plan;
+}
+
+template <const matrix_plan& Plan, size_t... I>
+static inline size_t apply_plan(size_t in, std::index_sequence<I...>) {
+    size_t out = 0;
+    // All plan entries are constants, so the unused slots fold away.
+    ((out |= I < Plan.move_count ? (Plan.moves[I].shift >= 0 ? in << Plan.moves[I].shift
+                                                              : in >> -Plan.moves[I].shift) &
+                 Plan.moves[I].mask
+                                 : 0),
+     ...);
+    ((out |= I < Plan.parity_count
+          ? (size_t)__builtin_parityll(in & Plan.parity_funcs[I]) << Plan.parity_bits[I]
+          : 0),
+     ...);
+    return out;
+}
+
+template <const mapping_spec& Spec>
+struct fixed_mapping {
+    static constexpr mapping_config config     = build_config(Spec);
+    static constexpr matrix_plan to_dram_plan   = make_plan(config.linear_to_dram_matrix);
+    static constexpr matrix_plan to_linear_plan = make_plan(config.dram_to_linear_matrix);
+
+    static dram_address from_linear(size_t linear) {
+        const auto intermediate =
+            apply_plan<to_dram_plan>(linear, std::make_index_sequence<MATRIX_SIZE>{});
+        return { (intermediate >> config.subchannel_shift) & config.subchannel_mask,
+                 (intermediate >> config.rank_shift) & config.rank_mask,
+                 (intermediate >> config.bank_group_shift) & config.bank_group_mask,
+                 (intermediate >> config.bank_shift) & config.bank_mask,
+                 (intermediate >> config.row_shift) & config.row_mask,
+                 (intermediate >> config.column_shift) & config.column_mask };
+    }
+
+    static size_t to_linear(const dram_address& a) {
+        size_t intermediate = 0;
+        intermediate |= (a.m_subchannel & config.subchannel_mask) << config.subchannel_shift;
+        intermediate |= (a.m_rank & config.rank_mask) << config.rank_shift;
+        intermediate |= (a.m_bank_group & config.bank_group_mask) << config.bank_group_shift;
+        intermediate |= (a.m_bank & config.bank_mask) << config.bank_shift;
+        intermediate |= (a.m_row & config.row_mask) << config.row_shift;
+        intermediate |= (a.m_column & config.column_mask) << config.column_shift;
+        return apply_plan<to_linear_plan>(intermediate, std::make_index_sequence<MATRIX_SIZE>{});
+    }
+
+    static constexpr mapping_fns fns{ Spec.name, &from_linear, &to_linear };
+};
+
+/*───────────────────── runtime translation ───────────────────────*/
+
+static dram_address from_linear_generic(size_t linear) {
+    auto intermediate = apply_matrix(s_config.linear_to_dram_matrix, linear);
+
+    auto subchannel = (intermediate >> s_config.subchannel_shift) & s_config.subchannel_mask;
+    auto rank = (intermediate >> s_config.rank_shift) & s_config.rank_mask;
+    auto bank_group = (intermediate >> s_config.bank_group_shift) & s_config.bank_group_mask;
+    auto bank   = (intermediate >> s_config.bank_shift) & s_config.bank_mask;
+    auto row    = (intermediate >> s_config.row_shift) & s_config.row_mask;
+    auto column = (intermediate >> s_config.column_shift) & s_config.column_mask;
+
+    return { subchannel, rank, bank_group, bank, row, column };
+}
+
+static size_t to_linear_generic(const dram_address& a) {
+    size_t intermediate = 0;
+    intermediate |= (a.m_subchannel & s_config.subchannel_mask) << s_config.subchannel_shift;
+    intermediate |= (a.m_rank & s_config.rank_mask) << s_config.rank_shift;
+    intermediate |= (a.m_bank_group & s_config.bank_group_mask) << s_config.bank_group_shift;
+    intermediate |= (a.m_bank & s_config.bank_mask) << s_config.bank_shift;
+    intermediate |= (a.m_row & s_config.row_mask) << s_config.row_shift;
+    intermediate |= (a.m_column & s_config.column_mask) << s_config.column_shift;
+
+    return apply_matrix(s_config.dram_to_linear_matrix, intermediate);
+}
+
+static constexpr mapping_fns kGenericMapping{ "generic", &from_linear_generic, &to_linear_generic };
+
+void dram_address::configure(int dimm_size_gib, int dimm_ranks) {
+    printf("[+] Initializing config for AMD Zen 4, %d rank(s).\n", dimm_ranks);
+
+    const mapping_spec* spec = nullptr;
+    if(dimm_ranks == 1) {                        // NOLINT
+        bool use_16_gib = (dimm_size_gib >= 12); // nearer 16 GiB than 8 GiB?
+        if(use_16_gib) { /* 8 bankgroups, 16 GiB DIMM size */
+            spec    = &kZen4OneRank16GiB;
+            s_fixed = &fixed_mapping<kZen4OneRank16GiB>::fns;
+        } else { /* 4 bankgroups, 8 GiB DIMM size */
+            spec    = &kZen4OneRank8GiB;
+            s_fixed = &fixed_mapping<kZen4OneRank8GiB>::fns;
+        }
+    } else if(dimm_ranks == 2) { // NOLINT
+        spec    = &kZen4TwoRanks;
+        s_fixed = &fixed_mapping<kZen4TwoRanks>::fns;
+    } else {
+        exit(EXIT_FAILURE);
+    }
+
+    s_config    = build_config(*spec);
+    s_translate = s_fixed ? s_fixed : &kGenericMapping;
 
     printf("[+] Finished DRAM configuration.\n");
 }
@@ -249,7 +394,7 @@ void dram_address::initialize(allocation alloc, int dimm_size_gib, int dimm_rank
     assert(!s_alloc);
     assert(alloc.size() == GB(1) && "Need a mapping of exactly one 1 GB superpage.");
     s_alloc = new allocation(std::move(alloc));
-    initialize_config(dimm_size_gib, dimm_ranks);
+    configure(dimm_size_gib, dimm_ranks);
 }
 
 allocation& dram_address::alloc() {
@@ -257,33 +402,36 @@ allocation& dram_address::alloc() {
     return *s_alloc;
 }
 
-dram_address dram_address::from_virt(const volatile char* virt) {
-    assert(s_alloc);
-    auto intermediate =
-        apply_matrix(s_config.linear_to_dram_matrix, (size_t)virt & MATRIX_MASK);
+size_t dram_address::row_count() {
+    return s_config.row_mask + 1;
+}
 
-    auto subchannel = (intermediate >> s_config.subchannel_shift) & s_config.subchannel_mask;
-    auto rank = (intermediate >> s_config.rank_shift) & s_config.rank_mask;
-    auto bank_group = (intermediate >> s_config.bank_group_shift) & s_config.bank_group_mask;
-    auto bank   = (intermediate >> s_config.bank_shift) & s_config.bank_mask;
-    auto row    = (intermediate >> s_config.row_shift) & s_config.row_mask;
-    auto column = (intermediate >> s_config.column_shift) & s_config.column_mask;
+size_t dram_address::bank_group_count() {
+    return s_config.bank_group_mask + 1;
+}
 
-    return { subchannel, rank, bank_group, bank, row, column };
+void dram_address::use_generic_mapping(bool generic) {
+    assert(s_alloc && "[-] Class dram_address is not initialized.");
+    s_translate = generic || !s_fixed ? &kGenericMapping : s_fixed;
+}
+
+std::string dram_address::mapping_name() {
+    assert(s_translate && "[-] Class dram_address is not initialized.");
+    if(s_translate == s_fixed) {
+        return std::string(s_fixed->name) + " (fixed)";
+    }
+    return std::string(kGenericMapping.name) + " (" + std::string(::to_string(kernels().variant)) + ")";
+}
+
+dram_address dram_address::from_virt(const volatile char* virt) {
+    assert(s_alloc);
+    return s_translate->from_linear((size_t)virt & MATRIX_MASK);
 }
 
 volatile char* dram_address::to_virt() const {
     assert(s_alloc && "[-] Class dram_address is not initialized.");
 
-    size_t intermediate = 0;
-    intermediate |= (m_subchannel & s_config.subchannel_mask) << s_config.subchannel_shift;
-    intermediate |= (m_rank & s_config.rank_mask) << s_config.rank_shift;
-    intermediate |= (m_bank_group & s_config.bank_group_mask) << s_config.bank_group_shift;
-    intermediate |= (m_bank & s_config.bank_mask) << s_config.bank_shift;
-    intermediate |= (m_row & s_config.row_mask) << s_config.row_shift;
-    intermediate |= (m_column & s_config.column_mask) << s_config.column_shift;
-
-    auto linear = apply_matrix(s_config.dram_to_linear_matrix, intermediate);
+    auto linear = s_translate->to_linear(*this);
     assert(((size_t)s_alloc->ptr() & MATRIX_MASK) == 0 &&
            "[-] Allocation is not aligned to 2^30 bytes.");
 
@@ -400,3 +548,23 @@ std::vector<volatile char*> dram_address::get_vaddrs_whole_row() const {
     }
     return vaddrs;
 }
+
+std::vector<volatile char*> dram_address::get_vaddrs_row_lines() const {
+    // The lowest column bits map 1:1 onto the cache-line offset, so stepping
+    // the column index by a line yields every line of the row exactly once.
+    for(size_t bit = 0; BIT_SET(bit) < CACHE_LINE_SIZE; bit++) {
+        assert(s_config.linear_to_dram_matrix[bit] == BIT_SET(bit));
+    }
+
+    const std::size_t max_col_idx = 1ULL << std::popcount(s_config.column_mask);
+
+    std::vector<volatile char*> lines;
+    lines.reserve(max_col_idx / CACHE_LINE_SIZE);
+
+    dram_address da(subchannel(), rank(), bank_group(), bank(), row(), 0);
+    for(size_t col_idx = 0; col_idx < max_col_idx; col_idx += CACHE_LINE_SIZE) {
+        da.m_column = col_idx;
+        lines.push_back(da.to_virt());
+    }
+    return lines;
+}
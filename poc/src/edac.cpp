@@ -0,0 +1,211 @@
+#include <hammer/edac.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <regex>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static std::string read_line(const fs::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+static bool write_value(const fs::path& path, const std::string& value) {
+    std::ofstream out(path);
+    out << value << '\n';
+    out.close();
+    return static_cast<bool>(out);
+}
+
+// sysfs attributes are regenerated on every read at offset 0
+static uint64_t read_counter(int fd) {
+    char buf[32];
+    const ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if(n <= 0) {
+        return 0;
+    }
+    buf[n] = '\0';
+    return std::strtoull(buf, nullptr, 10);
+}
+
+static std::vector<fs::path> sorted_entries(const fs::path& dir, const std::string& prefix) {
+    std::vector<fs::path> entries;
+    std::error_code ec;
+    for(const auto& e : fs::directory_iterator(dir, ec)) {
+        if(e.path().filename().string().rfind(prefix, 0) == 0) {
+            entries.push_back(e.path());
+        }
+    }
+    // mc2 before mc10
+    std::sort(entries.begin(), entries.end(), [&](const fs::path& a, const fs::path& b) {
+        const auto na = a.filename().string(), nb = b.filename().string();
+        return std::make_pair(na.size(), na) < std::make_pair(nb.size(), nb);
+    });
+    return entries;
+}
+
+static bool open_counter(std::vector<edac_counters::counter>& out,
+                         const fs::path& path,
+                         std::string name,
+                         std::string label = {}) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+    out.push_back({ std::move(name), std::move(label), fd, read_counter(fd) });
+    return true;
+}
+
+bool edac_counters::available(const fs::path& root) {
+    std::error_code ec;
+    return fs::exists(root / "mc0" / "ce_count", ec);
+}
+
+edac_counters::edac_counters(const fs::path& root) {
+    for(const auto& mc : sorted_entries(root, "mc")) {
+        const std::string mc_name = mc.filename().string();
+        if(!open_counter(totals_, mc / "ce_count", mc_name)) {
+            continue;
+        }
+        // Legacy layout: csrow (chip select) and channel counters
+        for(const auto& csrow : sorted_entries(mc, "csrow")) {
+            const std::string csrow_name = mc_name + '/' + csrow.filename().string();
+            open_counter(details_, csrow / "ce_count", csrow_name);
+            for(int ch = 0; fs::exists(csrow / ("ch" + std::to_string(ch) + "_ce_count")); ++ch) {
+                const std::string prefix = "ch" + std::to_string(ch);
+                open_counter(details_, csrow / (prefix + "_ce_count"), csrow_name + '/' + prefix,
+                             read_line(csrow / (prefix + "_dimm_label")));
+            }
+        }
+        // Current layout: one directory per DIMM (or rank)
+        for(const char* kind : { "dimm", "rank" }) {
+            for(const auto& dimm : sorted_entries(mc, kind)) {
+                open_counter(details_, dimm / "dimm_ce_count",
+                             mc_name + '/' + dimm.filename().string(),
+                             read_line(dimm / "dimm_label"));
+            }
+        }
+    }
+    if(totals_.empty()) {
+        throw std::runtime_error("no EDAC corrected error counters in " + root.string());
+    }
+}
+
+edac_counters::~edac_counters() {
+    for(auto* counters : { &totals_, &details_ }) {
+        for(auto& c : *counters) {
+            close(c.fd);
+        }
+    }
+}
+
+std::vector<edac_counters::delta> edac_counters::sample() {
+    std::vector<delta> deltas;
+    for(auto& c : totals_) {
+        const uint64_t v = read_counter(c.fd);
+        if(v > c.value) {
+            deltas.push_back({ &c, v - c.value });
+        }
+        c.value = v; // counters reset by the admin count as zero
+    }
+    if(deltas.empty()) {
+        return deltas;
+    }
+    for(auto& c : details_) {
+        const uint64_t v = read_counter(c.fd);
+        if(v > c.value) {
+            deltas.push_back({ &c, v - c.value });
+        }
+        c.value = v;
+    }
+    return deltas;
+}
+
+// Format of the ras:mc_event tracepoint (include/ras/ras_event.h), e.g.
+// "1 Corrected error: read error on CPU_SrcID#0_MC#0_Chan#1_DIMM#0 (mc:0
+//  location:0:1:0 address:0x12345680 grain:32 syndrome:0x0 - err_code:...)"
+std::optional<ras_event> parse_mc_event(std::string_view line) {
+    static const std::regex head(R"(mc_event:\s+(\d+) (\w+) errors?:.* on (.*) \(mc:(\d+) location:(-?\d+):(-?\d+):(-?\d+))");
+    static const std::regex address(R"(address:0x([0-9a-fA-F]+))");
+
+    std::cmatch m;
+    if(!std::regex_search(line.begin(), line.end(), m, head)) {
+        return std::nullopt;
+    }
+    ras_event e;
+    e.count = std::stoull(m[1]);
+    e.type  = m[2];
+    e.label = m[3];
+    e.mc    = std::stoi(m[4]);
+    for(int i = 0; i < 3; ++i) {
+        e.layer[i] = std::stoi(m[5 + i]);
+    }
+    // address:0x0 means the driver could not decode it
+    if(std::regex_search(line.begin(), line.end(), m, address)) {
+        if(const uint64_t addr = std::stoull(m[1], nullptr, 16); addr != 0) {
+            e.phys_addr = addr;
+        }
+    }
+    e.line = line;
+    return e;
+}
+
+ras_trace::ras_trace(const fs::path& tracefs, std::string instance) {
+    fs::path root = tracefs;
+    std::error_code ec;
+    if(!fs::exists(root / "instances", ec)) {
+        root = "/sys/kernel/debug/tracing";
+    }
+    if(!fs::exists(root / "events" / "ras" / "mc_event", ec)) {
+        throw std::runtime_error("no ras:mc_event tracepoint in " + root.string());
+    }
+    instance_dir_ = root / "instances" / instance;
+    fs::create_directory(instance_dir_, ec);
+    if(ec) {
+        throw std::runtime_error("cannot create trace instance " + instance_dir_.string() +
+                                 ": " + ec.message());
+    }
+    if(!write_value(instance_dir_ / "events" / "ras" / "mc_event" / "enable", "1")) {
+        fs::remove(instance_dir_, ec);
+        throw std::runtime_error("cannot enable ras:mc_event in " + instance_dir_.string());
+    }
+    pipe_fd_ = open((instance_dir_ / "trace_pipe").c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if(pipe_fd_ < 0) {
+        write_value(instance_dir_ / "events" / "ras" / "mc_event" / "enable", "0");
+        fs::remove(instance_dir_, ec);
+        throw std::runtime_error("cannot open " + (instance_dir_ / "trace_pipe").string());
+    }
+}
+
+ras_trace::~ras_trace() {
+    close(pipe_fd_);
+    write_value(instance_dir_ / "events" / "ras" / "mc_event" / "enable", "0");
+    std::error_code ec;
+    fs::remove(instance_dir_, ec);
+}
+
+std::vector<ras_event> ras_trace::drain() {
+    std::vector<ras_event> events;
+    char buf[4096];
+    ssize_t n;
+    while((n = read(pipe_fd_, buf, sizeof(buf))) > 0) {
+        partial_.append(buf, n);
+        std::size_t start = 0, end;
+        while((end = partial_.find('\n', start)) != std::string::npos) {
+            if(auto e = parse_mc_event(std::string_view(partial_).substr(start, end - start))) {
+                events.push_back(std::move(*e));
+            }
+            start = end + 1;
+        }
+        partial_.erase(0, start);
+    }
+    return events;
+}
@@ -0,0 +1,234 @@
+#include <hammer/dram_address.hpp>
+#include <hammer/eviction.hpp>
+#include <hammer/kernels.hpp>
+#include <hammer/time_utils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <immintrin.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <x86intrin.h>
+
+// Attempts at reducing a candidate set before giving up on a line
+#define EVSET_ATTEMPTS 3
+// Reductions that end up larger than this many times `ways` count as failed
+#define EVSET_MAX_OVERSIZE 2
+
+static uint64_t timed_load(volatile uint64_t* p) {
+    unsigned aux;
+    _mm_lfence();
+    const uint64_t start = __rdtscp(&aux);
+    (void)*p;
+    const uint64_t end = __rdtscp(&aux);
+    _mm_lfence();
+    return end - start;
+}
+
+static uint64_t bank_key(const dram_address& da) {
+    return (((da.subchannel() << 8 | da.rank()) << 8 | da.bank_group()) << 8) | da.bank();
+}
+
+eviction_sets::eviction_sets(eviction_set_params params)
+: params_{ params } {
+    if(params_.stride < CACHE_LINE_SIZE || (params_.stride & (params_.stride - 1)) != 0) {
+        throw std::invalid_argument("eviction set stride must be a power of two >= 64");
+    }
+    if(params_.ways == 0 || params_.rounds <= 0) {
+        throw std::invalid_argument("eviction set ways and rounds must be positive");
+    }
+}
+
+void eviction_sets::exclude_banks(const std::vector<dram_address>& addrs) {
+    std::unordered_set<uint64_t> banks;
+    for(const auto& da : addrs) {
+        banks.insert(bank_key(da));
+    }
+    if(banks == excluded_banks_) {
+        return;
+    }
+    excluded_banks_ = std::move(banks);
+    candidates_.clear();
+    by_line_.clear();
+    by_residue_.clear();
+    sets_.clear();
+}
+
+// The median of hits and of clflush'ed loads, split in the middle. clflush is
+// only used here, once, not while hammering.
+uint64_t eviction_sets::miss_threshold() {
+    if(params_.miss_threshold != 0) {
+        return params_.miss_threshold;
+    }
+    auto& alloc = dram_address::alloc();
+    auto* base  = static_cast<volatile char*>(alloc.ptr());
+    std::mt19937_64 rng{ 1 };
+    std::vector<uint64_t> hits, misses;
+    for(int i = 0; i < 1000; ++i) {
+        auto* p = reinterpret_cast<volatile uint64_t*>(
+            base + (rng() % (alloc.size() / CACHE_LINE_SIZE)) * CACHE_LINE_SIZE);
+        (void)*p;
+        hits.push_back(timed_load(p));
+        _mm_clflush(const_cast<uint64_t*>(p));
+        _mm_mfence();
+        misses.push_back(timed_load(p));
+    }
+    std::nth_element(hits.begin(), hits.begin() + hits.size() / 2, hits.end());
+    std::nth_element(misses.begin(), misses.begin() + misses.size() / 2, misses.end());
+    const uint64_t hit = hits[hits.size() / 2], miss = misses[misses.size() / 2];
+    if(miss <= hit) {
+        throw std::runtime_error("cannot distinguish cache hits from DRAM accesses by timing");
+    }
+    params_.miss_threshold = (hit + miss) / 2;
+    return params_.miss_threshold;
+}
+
+const std::vector<volatile uint64_t*>& eviction_sets::candidates(uintptr_t residue) {
+    auto it = candidates_.find(residue);
+    if(it != candidates_.end()) {
+        return it->second;
+    }
+    auto& alloc = dram_address::alloc();
+    auto* base  = static_cast<volatile char*>(alloc.ptr());
+    std::vector<volatile uint64_t*> lines;
+    for(std::size_t off = residue; off < alloc.size(); off += params_.stride) {
+        if(!excluded_banks_.count(bank_key(dram_address::from_virt(base + off)))) {
+            lines.push_back(reinterpret_cast<volatile uint64_t*>(base + off));
+        }
+    }
+    std::shuffle(lines.begin(), lines.end(), std::mt19937_64{ residue });
+    return candidates_.emplace(residue, std::move(lines)).first->second;
+}
+
+bool eviction_sets::evicts(volatile uint64_t* target, const eviction_set_t& set) {
+    const uint64_t threshold = miss_threshold();
+    int evicted = 0;
+    for(int r = 0; r < params_.rounds; ++r) {
+        (void)*target;
+        evict(set);
+        evict(set);
+        evicted += timed_load(target) > threshold;
+    }
+    return 2 * evicted > params_.rounds;
+}
+
+// Group testing: split the set into ways + 1 groups and drop a group whose
+// removal keeps the target evicted, until about `ways` lines are left.
+eviction_set_t eviction_sets::reduce(volatile uint64_t* target, eviction_set_t set) {
+    const std::size_t ways = params_.ways;
+    while(set.size() > ways) {
+        const std::size_t groups = std::min(ways + 1, set.size());
+        bool reduced             = false;
+        for(std::size_t g = 0; g < groups && !reduced; ++g) {
+            const std::size_t lo = set.size() * g / groups, hi = set.size() * (g + 1) / groups;
+            eviction_set_t rest;
+            rest.reserve(set.size() - (hi - lo));
+            rest.insert(rest.end(), set.begin(), set.begin() + lo);
+            rest.insert(rest.end(), set.begin() + hi, set.end());
+            if(evicts(target, rest)) {
+                set     = std::move(rest);
+                reduced = true;
+            }
+        }
+        if(!reduced) {
+            break;
+        }
+    }
+    return set;
+}
+
+const eviction_set_t& eviction_sets::for_line(volatile uint64_t* line) {
+    const auto addr = reinterpret_cast<uintptr_t>(line) & ~uintptr_t(CACHE_LINE_SIZE - 1);
+    if(auto it = by_line_.find(addr); it != by_line_.end()) {
+        return *it->second;
+    }
+    auto* target = reinterpret_cast<volatile uint64_t*>(addr);
+    const auto residue =
+        (addr - reinterpret_cast<uintptr_t>(dram_address::alloc().ptr())) % params_.stride;
+
+    // Congruent lines in the same slice share a set
+    auto& congruent = by_residue_[residue];
+    for(const eviction_set_t* set : congruent) {
+        if(evicts(target, *set)) {
+            return *(by_line_[addr] = set);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    eviction_set_t pool;
+    for(auto* p : candidates(residue)) {
+        if(reinterpret_cast<uintptr_t>(p) != addr) {
+            pool.push_back(p);
+        }
+    }
+    if(!evicts(target, pool)) {
+        throw std::runtime_error("eviction set candidates do not evict the target line, "
+                                 "try a smaller stride");
+    }
+    for(int attempt = 0; attempt < EVSET_ATTEMPTS; ++attempt) {
+        eviction_set_t set = reduce(target, pool);
+        if(set.size() <= EVSET_MAX_OVERSIZE * params_.ways && evicts(target, set)) {
+            build_ms_ += std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+            ++built_;
+            const eviction_set_t* stored = &sets_.emplace_back(std::move(set));
+            congruent.push_back(stored);
+            return *(by_line_[addr] = stored);
+        }
+        std::shuffle(pool.begin(), pool.end(), std::mt19937_64{ addr + attempt });
+    }
+    throw std::runtime_error("no eviction set found for line");
+}
+
+access_rate measure_access_rate(const std::vector<volatile uint64_t*>& aggressors,
+                                eviction_sets* sets,
+                                uint64_t miss_threshold,
+                                double trefi_ns,
+                                int rounds) {
+    access_rate r;
+    r.mode = sets ? "evict" : "clflush";
+    if(aggressors.empty() || rounds <= 0) {
+        return r;
+    }
+
+    std::vector<const eviction_set_t*> evsets;
+    for(auto* p : aggressors) {
+        evsets.push_back(sets ? &sets->for_line(p) : nullptr);
+    }
+    auto release = [&](std::size_t i) {
+        if(sets) {
+            evict(*evsets[i]);
+        } else {
+            _mm_clflushopt(const_cast<uint64_t*>(aggressors[i]));
+        }
+    };
+
+    // Latency of each aggressor load, as in the hammer loop
+    uint64_t slow = 0;
+    for(int round = 0; round < rounds; ++round) {
+        for(std::size_t i = 0; i < aggressors.size(); ++i) {
+            slow += timed_load(aggressors[i]) > miss_threshold;
+            release(i);
+        }
+    }
+
+    // Throughput, without timing each load
+    const uint64_t start = tsc_now();
+    for(int round = 0; round < rounds; ++round) {
+        for(std::size_t i = 0; i < aggressors.size(); ++i) {
+            (void)*aggressors[i];
+            release(i);
+        }
+        _mm_lfence();
+    }
+    const uint64_t cycles = tsc_now() - start;
+
+    const double accesses = static_cast<double>(rounds) * aggressors.size();
+    r.cycles_per_access   = cycles / accesses;
+    r.dram_fraction       = slow / accesses;
+    r.acts_per_trefi = r.dram_fraction * trefi_ns * tsc_cycles_per_ns() / r.cycles_per_access;
+    return r;
+}
@@ -0,0 +1,176 @@
+#include <hammer/hwmon.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <unistd.h>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+// hwmon drivers of SPD hub temperature sensors
+static constexpr const char* kDimmSensorDrivers[] = { "spd5118", "jc42" };
+
+static std::string read_line(const fs::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+static bool is_dimm_sensor(const fs::path& hwmon) {
+    const std::string name = read_line(hwmon / "name");
+    return std::find(std::begin(kDimmSensorDrivers), std::end(kDimmSensorDrivers), name) !=
+        std::end(kDimmSensorDrivers);
+}
+
+// Millidegrees Celsius; sysfs attributes are regenerated on every read at offset 0
+static bool read_millidegrees(int fd, long& value) {
+    char buf[32];
+    const ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if(n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+    value  = std::strtol(buf, nullptr, 10);
+    return true;
+}
+
+bool dimm_temperatures::available(const fs::path& root) {
+    std::error_code ec;
+    for(const auto& e : fs::directory_iterator(root, ec)) {
+        if(is_dimm_sensor(e.path()) && fs::exists(e.path() / "temp1_input", ec)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+dimm_temperatures::dimm_temperatures(int hammer_core,
+                                     std::chrono::milliseconds period,
+                                     const fs::path& root)
+: period_{ period } {
+    std::vector<fs::path> hwmons;
+    std::error_code ec;
+    for(const auto& e : fs::directory_iterator(root, ec)) {
+        if(is_dimm_sensor(e.path())) {
+            hwmons.push_back(e.path());
+        }
+    }
+    // Order by the SMBus address of the SPD hub, i.e. by DIMM slot
+    std::vector<std::pair<std::string, fs::path>> named;
+    for(const auto& hwmon : hwmons) {
+        std::string device = fs::read_symlink(hwmon / "device", ec).filename().string();
+        if(device.empty()) {
+            device = hwmon.filename().string();
+        }
+        named.emplace_back(read_line(hwmon / "name") + ' ' + device, hwmon / "temp1_input");
+    }
+    std::sort(named.begin(), named.end());
+
+    for(auto& [name, input] : named) {
+        const int fd = open(input.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd >= 0) {
+            sensors_.push_back({ std::move(name), fd });
+        }
+    }
+    if(sensors_.empty()) {
+        throw std::runtime_error("no DIMM temperature sensor in " + root.string() +
+                                 " (load the spd5118 or jc42 driver)");
+    }
+    windows_.resize(sensors_.size());
+    thread_ = std::thread(&dimm_temperatures::sample_loop, this, hammer_core);
+}
+
+dimm_temperatures::~dimm_temperatures() {
+    {
+        std::lock_guard lock(mutex_);
+        quit_ = true;
+    }
+    quit_cv_.notify_all();
+    thread_.join();
+    for(const auto& s : sensors_) {
+        close(s.fd);
+    }
+}
+
+void dimm_temperatures::sample_loop(int hammer_core) {
+    sched_param normal{};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for(long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); ++cpu) {
+        if(cpu != hammer_core) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    std::vector<double> readings(sensors_.size());
+    for(;;) {
+        // Read outside the lock, SMBus transfers are slow
+        bool complete = true;
+        for(std::size_t i = 0; i < sensors_.size(); ++i) {
+            long milli = 0;
+            complete &= read_millidegrees(sensors_[i].fd, milli);
+            readings[i] = milli / 1000.0;
+        }
+
+        std::unique_lock lock(mutex_);
+        if(complete) {
+            latest_ = readings;
+            for(std::size_t i = 0; i < readings.size(); ++i) {
+                accumulator& w = windows_[i];
+                w.min_c        = w.samples == 0 ? readings[i] : std::min(w.min_c, readings[i]);
+                w.max_c        = w.samples == 0 ? readings[i] : std::max(w.max_c, readings[i]);
+                w.sum_c += readings[i];
+                ++w.samples;
+            }
+            sampled_.notify_all();
+        }
+        if(quit_cv_.wait_for(lock, period_, [&] { return quit_; })) {
+            return;
+        }
+    }
+}
+
+std::vector<dimm_temperatures::window> dimm_temperatures::take_window() {
+    std::lock_guard lock(mutex_);
+    std::vector<window> out;
+    out.reserve(windows_.size());
+    for(auto& w : windows_) {
+        out.push_back({ w.min_c, w.samples ? w.sum_c / w.samples : 0.0, w.max_c, w.samples });
+        w = {};
+    }
+    return out;
+}
+
+bool dimm_temperatures::in_band(double min_c, double max_c) const {
+    return !latest_.empty() && std::all_of(latest_.begin(), latest_.end(), [&](double t) {
+        return t >= min_c && t <= max_c;
+    });
+}
+
+bool dimm_temperatures::wait_for_band(double min_c,
+                                      double max_c,
+                                      std::chrono::seconds timeout,
+                                      const std::atomic<bool>* stop) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock lock(mutex_);
+    while(!in_band(min_c, max_c)) {
+        if((stop && stop->load()) || std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        sampled_.wait_until(lock, std::min(deadline, std::chrono::steady_clock::now() + period_));
+    }
+    return true;
+}
+
+std::vector<double> dimm_temperatures::latest() const {
+    std::lock_guard lock(mutex_);
+    return latest_;
+}
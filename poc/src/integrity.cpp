@@ -0,0 +1,149 @@
+#include <hammer/dram_address.hpp>
+#include <hammer/integrity.hpp>
+#include <hammer/kernels.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <unistd.h>
+
+// Unit of work handed to a worker; small enough to balance the load, large
+// enough that the shared counter is not contended.
+#define INTEGRITY_CHUNK_SIZE (2UL << 20)
+
+integrity_checker::integrity_checker(volatile char* base,
+                                     size_t size,
+                                     int hammer_core,
+                                     unsigned threads)
+: base_{ base }, size_{ size } {
+    if(reinterpret_cast<uintptr_t>(base) % CACHE_LINE_SIZE != 0 || size % CACHE_LINE_SIZE != 0) {
+        throw std::invalid_argument("integrity_checker: region must be line aligned");
+    }
+    std::vector<int> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    for(long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); ++cpu) {
+        // The process may already be pinned to the hammer core, so consider all
+        // online CPUs unless the affinity mask allows more than one
+        if(cpu != hammer_core && (CPU_COUNT(&allowed) <= 1 || CPU_ISSET(cpu, &allowed))) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    if(cpus.empty()) {
+        cpus.push_back(-1); // single CPU: share it with the hammer thread
+    }
+    if(threads > 0 && threads < cpus.size()) {
+        cpus.resize(threads);
+    }
+
+    results_.resize(cpus.size());
+    workers_.reserve(cpus.size());
+    for(std::size_t i = 0; i < cpus.size(); ++i) {
+        workers_.emplace_back(&integrity_checker::worker_loop, this, i, cpus[i]);
+    }
+}
+
+integrity_checker::~integrity_checker() {
+    {
+        std::lock_guard lock(mutex_);
+        quit_ = true;
+    }
+    start_.notify_all();
+    for(auto& t : workers_) {
+        t.join();
+    }
+}
+
+void integrity_checker::worker_loop(std::size_t index, int cpu) {
+    // Plain time sharing instead of the hammer thread's real-time priority
+    sched_param normal{};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+    if(cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    uint64_t seen = 0;
+    for(;;) {
+        const chunk_fn* job;
+        {
+            std::unique_lock lock(mutex_);
+            start_.wait(lock, [&] { return quit_ || generation_ != seen; });
+            if(quit_) {
+                return;
+            }
+            seen = generation_;
+            job  = job_;
+        }
+
+        for(size_t chunk; (chunk = next_chunk_.fetch_add(1)) * INTEGRITY_CHUNK_SIZE < size_;) {
+            const size_t offset = chunk * INTEGRITY_CHUNK_SIZE;
+            (*job)(base_ + offset, std::min(INTEGRITY_CHUNK_SIZE, size_ - offset), results_[index]);
+        }
+
+        std::lock_guard lock(mutex_);
+        if(--busy_ == 0) {
+            finished_.notify_one();
+        }
+    }
+}
+
+void integrity_checker::run(const chunk_fn& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::unique_lock lock(mutex_);
+        job_ = &fn;
+        next_chunk_.store(0);
+        busy_ = workers_.size();
+        ++generation_;
+        start_.notify_all();
+        finished_.wait(lock, [&] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+    last_ms_ =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void integrity_checker::fill(uint64_t pattern) {
+    const auto& k = kernels();
+    run([&](volatile char* chunk, size_t bytes, std::vector<bit_flip_t>&) {
+        k.stream_fill(chunk, bytes, pattern);
+    });
+}
+
+std::vector<bit_flip_t> integrity_checker::verify(uint64_t pattern) {
+    const auto* pattern_bytes = reinterpret_cast<const uint8_t*>(&pattern);
+    const auto& k             = kernels();
+    for(auto& r : results_) {
+        r.clear();
+    }
+
+    run([&](volatile char* chunk, size_t bytes, std::vector<bit_flip_t>& out) {
+        for(size_t off = 0; (off += k.find_mismatch(chunk + off, bytes - off, pattern)) < bytes;
+            off += CACHE_LINE_SIZE) {
+            volatile char* line = chunk + off;
+            for(uint64_t mismatches = k.scan_line(line, pattern); mismatches != 0;
+                mismatches &= mismatches - 1) {
+                const auto i = static_cast<size_t>(__builtin_ctzll(mismatches));
+                out.push_back({ dram_address::from_virt(line + i),
+                                pattern_bytes[i % sizeof(uint64_t)],
+                                static_cast<uint8_t>(line[i]) });
+            }
+            k.fill_line(line, pattern);
+        }
+    });
+
+    std::vector<bit_flip_t> flips;
+    for(auto& r : results_) {
+        flips.insert(flips.end(), r.begin(), r.end());
+    }
+    std::sort(flips.begin(), flips.end(), [](const bit_flip_t& a, const bit_flip_t& b) {
+        return a.address.to_virt() < b.address.to_virt();
+    });
+    return flips;
+}
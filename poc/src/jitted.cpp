@@ -3,19 +3,44 @@
 #include <asmjit/core/logger.h>
 #include <asmjit/x86/x86assembler.h>
 
+#include <hammer/eviction.hpp>
+#include <hammer/jitted.hpp>
 #include <hammer/pattern.hpp>
+#include <hammer/phase_profiler.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <immintrin.h>
+#include <linux/perf_event.h>
 #include <memory>
 #include <stdexcept>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
 #include <vector>
 
 using namespace asmjit;
 
+#define HUGEPAGE_2MB (1ULL << 21)
+#define CODE_ALIGN 64
+
 std::vector<volatile uint64_t*> g_sync_rows_storage;
 volatile uint64_t** g_sync_rows;
 int g_num_sync_rows;
 size_t g_ref_threshold;
+std::vector<const eviction_set_t*> g_sync_evsets;
+
+// Parallel probe: group i (sync row i) is g_probe_lines[i * width, (i + 1) * width)
+static unsigned g_ref_probe_width = 1;
+static std::vector<volatile uint64_t*> g_probe_lines;
+static std::vector<const eviction_set_t*> g_probe_evsets;
+
+static eviction_sets* g_eviction_sets = nullptr;
+static phase_profiler* g_phase_profiler = nullptr;
 
 static uint64_t rdtscp() {
     uint64_t lo, hi;
@@ -23,6 +48,352 @@ static uint64_t rdtscp() {
     return (hi << 32) | lo;
 }
 
+// Filled by the JIT code after every burst if g_burst_timing_enabled: cycles
+// from REF detection to burst end, and (self-sync only) bursts whose REF came
+// more than one interval late.
+static bool g_burst_timing_enabled = false;
+static struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t sum_sq;
+    uint64_t desync;
+} g_burst_timing;
+
+// Phase sweep state used by the JIT code: every `period` bursts it shifts the
+// schedule index and appends (remaining repetitions, REF timestamp) to the log.
+static struct {
+    uint64_t period;
+    uint64_t countdown;
+    uint64_t* log_pos;
+    uint64_t* log_end;
+} g_phase_sweep;
+
+static std::vector<uint64_t> g_phase_sweep_log;
+static uint64_t g_phase_sweep_repetitions;
+static uint64_t g_phase_sweep_pattern_length;
+
+static bool g_use_hugepage_code = true;
+static jit_run_stats g_last_run_stats;
+
+void jit_use_hugepage_code(bool enable) {
+    g_use_hugepage_code = enable;
+}
+
+void jit_use_eviction_sets(eviction_sets* sets) {
+    g_eviction_sets = sets;
+}
+
+void jit_set_phase_profiler(phase_profiler* profiler) {
+    g_phase_profiler = profiler;
+}
+
+void jit_set_ref_probe_width(unsigned width) {
+    g_ref_probe_width = std::max(width, 1U);
+}
+
+void jit_set_burst_timing(bool enable) {
+    g_burst_timing_enabled = enable;
+}
+
+void jit_set_phase_sweep(uint64_t period_trefis) {
+    g_phase_sweep.period = period_trefis;
+}
+
+const jit_run_stats& jit_last_run_stats() {
+    return g_last_run_stats;
+}
+
+/// Code buffer backed by 2 MiB hugepages, so a whole hammer program is covered
+/// by a handful of iTLB entries. Kept across runs and only grown when needed.
+class hugepage_code_buffer {
+    public:
+    ~hugepage_code_buffer() {
+        release();
+    }
+
+    /// Returns a writable buffer of at least @p size bytes at a 2 MiB aligned
+    /// address, or nullptr if no hugepages are available.
+    uint8_t* acquire(size_t size) {
+        size = (size + HUGEPAGE_2MB - 1) & ~(HUGEPAGE_2MB - 1);
+        if(size > size_) {
+            release();
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT),
+                           -1, 0);
+            if(p == MAP_FAILED) {
+                return nullptr;
+            }
+            base_ = static_cast<uint8_t*>(p);
+            size_ = size;
+        } else if(mprotect(base_, size_, PROT_READ | PROT_WRITE) != 0) {
+            return nullptr;
+        }
+        return base_;
+    }
+
+    bool make_executable() {
+        return mprotect(base_, size_, PROT_READ | PROT_EXEC) == 0;
+    }
+
+    private:
+    void release() {
+        if(base_) {
+            munmap(base_, size_);
+        }
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    uint8_t* base_{ nullptr };
+    size_t size_{ 0 };
+};
+
+static hugepage_code_buffer g_code_buffer;
+
+static int open_itlb_miss_counter() {
+    perf_event_attr attr{};
+    attr.type   = PERF_TYPE_HW_CACHE;
+    attr.size   = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_ITLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// Time each burst: RAX = rdtscp - R13 (the REF timestamp the burst was started on).
+static void emit_burst_timing(x86::Assembler& a) {
+    if(!g_burst_timing_enabled) {
+        return;
+    }
+    a.rdtscp();
+    a.shl(x86::rdx, 32);
+    a.or_(x86::rax, x86::rdx);
+    a.sub(x86::rax, x86::r13);
+    a.mov(x86::r8, imm((uint64_t)&g_burst_timing));
+    a.inc(x86::qword_ptr(x86::r8, offsetof(decltype(g_burst_timing), count)));
+    a.add(x86::qword_ptr(x86::r8, offsetof(decltype(g_burst_timing), sum)), x86::rax);
+    a.imul(x86::rax, x86::rax);
+    a.add(x86::qword_ptr(x86::r8, offsetof(decltype(g_burst_timing), sum_sq)), x86::rax);
+}
+
+// Count a desynchronized self-sync burst: RAX = q, REFs skipped since the last burst.
+static void emit_desync_count(x86::Assembler& a) {
+    if(!g_burst_timing_enabled) {
+        return;
+    }
+    a.test(x86::rax, x86::rax);
+    a.setnz(x86::dl);
+    a.movzx(x86::edx, x86::dl);
+    a.mov(x86::r8, imm((uint64_t)&g_burst_timing));
+    a.add(x86::qword_ptr(x86::r8, offsetof(decltype(g_burst_timing), desync)), x86::rdx);
+}
+
+// Every g_phase_sweep.period bursts: idx (R12) += 1 and log RBX/R13. The
+// extra slot is wrapped by the modulo of the next index update.
+static void emit_phase_sweep(x86::Assembler& a) {
+    if(g_phase_sweep.period == 0) {
+        return;
+    }
+    Label skip = a.newLabel();
+    a.mov(x86::r8, imm((uint64_t)&g_phase_sweep));
+    a.dec(x86::qword_ptr(x86::r8, offsetof(decltype(g_phase_sweep), countdown)));
+    a.jnz(skip);
+    a.mov(x86::rax, x86::qword_ptr(x86::r8, offsetof(decltype(g_phase_sweep), period)));
+    a.mov(x86::qword_ptr(x86::r8, offsetof(decltype(g_phase_sweep), countdown)), x86::rax);
+    a.add(x86::r12, 1);
+    a.mov(x86::rax, x86::qword_ptr(x86::r8, offsetof(decltype(g_phase_sweep), log_pos)));
+    a.cmp(x86::rax, x86::qword_ptr(x86::r8, offsetof(decltype(g_phase_sweep), log_end)));
+    a.jae(skip);
+    a.mov(x86::qword_ptr(x86::rax), x86::rbx);
+    a.mov(x86::qword_ptr(x86::rax, 8), x86::r13);
+    a.add(x86::rax, 16);
+    a.mov(x86::qword_ptr(x86::r8, offsetof(decltype(g_phase_sweep), log_pos)), x86::rax);
+    a.bind(skip);
+}
+
+static void begin_phase_sweep(uint64_t pattern_repetitions, uint64_t pattern_length) {
+    g_phase_sweep_repetitions    = pattern_repetitions;
+    g_phase_sweep_pattern_length = pattern_length;
+    if(g_phase_sweep.period == 0) {
+        return;
+    }
+    g_phase_sweep_log.assign(2 * (pattern_repetitions / g_phase_sweep.period), 0);
+    g_phase_sweep.countdown = g_phase_sweep.period;
+    g_phase_sweep.log_pos   = g_phase_sweep_log.data();
+    g_phase_sweep.log_end   = g_phase_sweep_log.data() + g_phase_sweep_log.size();
+}
+
+// Turn the shift log into windows; `bursts` is the total number of bursts run.
+static std::vector<jit_phase_window> collect_phase_windows(uint64_t start_tsc, uint64_t bursts) {
+    std::vector<jit_phase_window> windows;
+    if(g_phase_sweep.period == 0) {
+        return windows;
+    }
+    jit_phase_window w{ 0, 0, 0, start_tsc };
+    for(const uint64_t* e = g_phase_sweep_log.data(); e < g_phase_sweep.log_pos; e += 2) {
+        // RBX is decremented after the shift, so e[0] still counts the current burst
+        w.burst_end = g_phase_sweep_repetitions - e[0] + 1;
+        windows.push_back(w);
+        w = { (w.phase_offset + 1) % g_phase_sweep_pattern_length, w.burst_end, 0, e[1] };
+    }
+    w.burst_end = bursts;
+    windows.push_back(w);
+    return windows;
+}
+
+// Load an aggressor and release its line again: clflushopt, or a loop over
+// its eviction set (R9 = next line, ECX = lines left).
+static void emit_aggressor_access(x86::Assembler& a, volatile uint64_t* p) {
+    a.mov(x86::r10, imm((uint64_t)p));
+    a.mov(x86::rax, x86::ptr(x86::r10));
+    if(g_eviction_sets == nullptr) {
+        a.clflushopt(x86::ptr(x86::r10));
+        return;
+    }
+    const eviction_set_t& set = g_eviction_sets->for_line(p);
+    Label next                = a.newLabel();
+    a.mov(x86::r9, imm((uint64_t)set.data()));
+    a.mov(x86::ecx, imm(set.size()));
+    a.bind(next);
+    a.mov(x86::r10, x86::qword_ptr(x86::r9));
+    a.mov(x86::rax, x86::ptr(x86::r10));
+    a.add(x86::r9, 8);
+    a.dec(x86::ecx);
+    a.jnz(next);
+}
+
+uint64_t global_ref_sync();
+uint64_t global_ref_sync_evict();
+uint64_t global_ref_sync_parallel();
+uint64_t global_ref_sync_parallel_evict();
+
+// Point the sync globals at @p sync_rows and, with eviction sets, keep the
+// pattern's banks out of all sets and build those of the sync rows.
+static void setup_sync(const hammer_pattern_t& pattern, std::vector<dram_address>& sync_rows) {
+    g_sync_rows_storage = convert_addresses_to_virtual(sync_rows);
+    g_num_sync_rows     = static_cast<int>(g_sync_rows_storage.size());
+    g_sync_rows         = g_sync_rows_storage.data();
+    g_sync_evsets.clear();
+    g_probe_lines.clear();
+    g_probe_evsets.clear();
+    if(g_ref_probe_width > 1) {
+        const size_t bank_groups = dram_address::bank_group_count();
+        for(const auto& row : sync_rows) {
+            for(unsigned k = 0; k < g_ref_probe_width; ++k) {
+                const dram_address line(row.subchannel(), row.rank(),
+                                        (row.bank_group() + k) % bank_groups, row.bank(),
+                                        row.row(), row.column());
+                g_probe_lines.push_back(reinterpret_cast<volatile uint64_t*>(line.to_virt()));
+            }
+        }
+    }
+    if(g_eviction_sets != nullptr) {
+        g_eviction_sets->exclude_banks(pattern_aggressors(pattern));
+        for(auto* p : g_sync_rows_storage) {
+            g_sync_evsets.push_back(&g_eviction_sets->for_line(p));
+        }
+        for(auto* p : g_probe_lines) {
+            g_probe_evsets.push_back(&g_eviction_sets->for_line(p));
+        }
+    }
+}
+
+static uint64_t ref_sync_fn() {
+    if(g_ref_probe_width > 1) {
+        return g_eviction_sets ? (uint64_t)&global_ref_sync_parallel_evict
+                               : (uint64_t)&global_ref_sync_parallel;
+    }
+    return g_eviction_sets ? (uint64_t)&global_ref_sync_evict : (uint64_t)&global_ref_sync;
+}
+
+using jitted_fn_t = void (*)();
+
+/// Place @p code (hugepage buffer or AsmJit's runtime), run it once and
+/// record jit_last_run_stats().
+static void run_jitted(CodeHolder& code) {
+    jit_run_stats stats{};
+    // Kept for the process lifetime, so its code memory is reused across runs
+    static std::unique_ptr<JitRuntime> fallback_runtime;
+    JitRuntime* jit_runtime = nullptr;
+    jitted_fn_t fn = nullptr;
+
+    if(g_use_hugepage_code) {
+        if(code.flatten() != kErrorOk || code.resolveUnresolvedLinks() != kErrorOk) {
+            throw std::runtime_error("failed to finalize JIT code");
+        }
+        const size_t size = code.codeSize();
+        uint8_t* buf      = g_code_buffer.acquire(size);
+        if(buf != nullptr && code.relocateToBase((uint64_t)buf) == kErrorOk) {
+            code.copyFlattenedData(buf, size, CopySectionFlags::kPadTargetBuffer);
+            if(g_code_buffer.make_executable()) {
+                fn             = reinterpret_cast<jitted_fn_t>(buf);
+                stats.hugepage = true;
+            }
+        }
+        if(fn == nullptr) {
+            std::fprintf(stderr, "[!] No 2 MiB hugepage for JIT code, falling back to 4 KiB pages\n");
+            g_use_hugepage_code = false;
+        }
+    }
+    if(fn == nullptr) {
+        if(!fallback_runtime) {
+            fallback_runtime = std::make_unique<JitRuntime>();
+        }
+        jit_runtime = fallback_runtime.get();
+        if(jit_runtime->add(reinterpret_cast<void**>(&fn), &code) != kErrorOk) {
+            throw std::runtime_error("failed to place JIT code");
+        }
+    }
+    stats.code_size = code.codeSize();
+
+    std::memset(&g_burst_timing, 0, sizeof(g_burst_timing));
+    int itlb_fd = open_itlb_miss_counter();
+    uint64_t itlb_misses = 0;
+
+    sched_yield();
+    sched_yield();
+    sched_yield();
+    sched_yield();
+    uint64_t start_tsc;
+    {
+        scoped_phase hammering(g_phase_profiler, sweep_phase::hammer);
+        if(itlb_fd >= 0) {
+            ioctl(itlb_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(itlb_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        start_tsc = rdtscp();
+        fn();
+    }
+    if(itlb_fd >= 0) {
+        ioctl(itlb_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(itlb_fd, &itlb_misses, sizeof(itlb_misses)) != sizeof(itlb_misses)) {
+            itlb_fd = -1;
+        }
+        close(itlb_fd);
+    }
+
+    if(jit_runtime) {
+        jit_runtime->release(fn);
+    }
+
+    stats.itlb_misses = itlb_fd >= 0 ? static_cast<int64_t>(itlb_misses) : -1;
+    // The loop runs every repetition, so the count needs no instrumentation
+    stats.bursts       = g_phase_sweep_repetitions;
+    stats.burst_timing = g_burst_timing_enabled;
+    // prev_ts starts at 0, so the first self-sync burst always looks late
+    stats.desync_bursts = g_burst_timing.desync > 0 ? g_burst_timing.desync - 1 : 0;
+    if(g_burst_timing.count > 0) {
+        const double n    = static_cast<double>(g_burst_timing.count);
+        const double mean = g_burst_timing.sum / n;
+        stats.burst_cycles_mean = mean;
+        stats.burst_cycles_var = std::max(0.0, g_burst_timing.sum_sq / n - mean * mean);
+    }
+    stats.phase_windows = collect_phase_windows(start_tsc, stats.bursts);
+    g_last_run_stats    = std::move(stats);
+}
+
 uint64_t global_ref_sync() {
     uint64_t prev = rdtscp();
     int i         = 0;
@@ -38,6 +409,155 @@ uint64_t global_ref_sync() {
     }
 }
 
+uint64_t global_ref_sync_evict() {
+    uint64_t prev = rdtscp();
+    int i         = 0;
+    while(true) {
+        *(g_sync_rows[i]);
+        evict(*g_sync_evsets[i]);
+        uint64_t curr = rdtscp();
+        if((curr - prev) > g_ref_threshold) {
+            return curr;
+        }
+        prev = curr;
+        i    = (i + 1) % g_num_sync_rows;
+    }
+}
+
+// All loads of a group are issued before the first flush; RDTSCP waits for
+// them, so one iteration takes about as long as the slowest line.
+uint64_t global_ref_sync_parallel() {
+    const unsigned width             = g_ref_probe_width;
+    volatile uint64_t* const* lines  = g_probe_lines.data();
+    uint64_t prev                    = rdtscp();
+    int i                            = 0;
+    while(true) {
+        volatile uint64_t* const* group = lines + i * width;
+        for(unsigned k = 0; k < width; ++k) {
+            *(group[k]);
+        }
+        for(unsigned k = 0; k < width; ++k) {
+            _mm_clflushopt((void*)group[k]);
+        }
+        uint64_t curr = rdtscp();
+        if((curr - prev) > g_ref_threshold) {
+            return curr;
+        }
+        prev = curr;
+        i    = (i + 1) % g_num_sync_rows;
+    }
+}
+
+uint64_t global_ref_sync_parallel_evict() {
+    const unsigned width             = g_ref_probe_width;
+    volatile uint64_t* const* lines  = g_probe_lines.data();
+    uint64_t prev                    = rdtscp();
+    int i                            = 0;
+    while(true) {
+        volatile uint64_t* const* group = lines + i * width;
+        for(unsigned k = 0; k < width; ++k) {
+            *(group[k]);
+        }
+        for(unsigned k = 0; k < width; ++k) {
+            evict(*g_probe_evsets[i * width + k]);
+        }
+        uint64_t curr = rdtscp();
+        if((curr - prev) > g_ref_threshold) {
+            return curr;
+        }
+        prev = curr;
+        i    = (i + 1) % g_num_sync_rows;
+    }
+}
+
+ref_interval_stats jit_measure_ref_intervals(const hammer_pattern_t& pattern,
+                                             std::vector<dram_address>& sync_rows,
+                                             int ref_threshold,
+                                             std::size_t samples) {
+    setup_sync(pattern, sync_rows);
+    g_ref_threshold = ref_threshold;
+    const auto sync = reinterpret_cast<uint64_t (*)()>(ref_sync_fn());
+
+    std::vector<uint64_t> intervals(samples);
+    uint64_t prev = sync();
+    for(auto& d : intervals) {
+        const uint64_t curr = sync();
+        d                   = curr - prev;
+        prev                = curr;
+    }
+
+    ref_interval_stats stats{};
+    stats.probe_width = g_ref_probe_width;
+    stats.intervals   = intervals.size();
+    if(intervals.empty()) {
+        return stats;
+    }
+    std::vector<uint64_t> sorted = intervals;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    stats.median_cycles = static_cast<double>(sorted[sorted.size() / 2]);
+
+    double sum = 0, sum_sq = 0;
+    std::size_t clean = 0;
+    for(uint64_t d : intervals) {
+        if(d < stats.median_cycles / 2) {
+            ++stats.spurious;
+        } else if(d > stats.median_cycles * 1.5) {
+            ++stats.missed;
+        } else {
+            sum += static_cast<double>(d);
+            sum_sq += static_cast<double>(d) * static_cast<double>(d);
+            ++clean;
+        }
+    }
+    if(clean > 0) {
+        stats.mean_cycles   = sum / clean;
+        stats.stddev_cycles =
+            std::sqrt(std::max(0.0, sum_sq / clean - stats.mean_cycles * stats.mean_cycles));
+    }
+    return stats;
+}
+
+int jit_calibrate_ref_threshold(const hammer_pattern_t& pattern,
+                                std::vector<dram_address>& sync_rows,
+                                std::size_t samples) {
+    setup_sync(pattern, sync_rows);
+    const unsigned width = g_probe_lines.empty() ? 1 : g_ref_probe_width;
+    auto line            = [&](int i, unsigned k) {
+        return width > 1 ? g_probe_lines[i * width + k] : g_sync_rows[i];
+    };
+    auto evset = [&](int i, unsigned k) {
+        return width > 1 ? g_probe_evsets[i * width + k] : g_sync_evsets[i];
+    };
+
+    // One iteration of the probe loops above, timed the same way
+    std::vector<uint64_t> iterations(samples);
+    uint64_t prev = rdtscp();
+    int i         = 0;
+    for(auto& d : iterations) {
+        for(unsigned k = 0; k < width; ++k) {
+            *(line(i, k));
+        }
+        for(unsigned k = 0; k < width; ++k) {
+            if(g_eviction_sets) {
+                evict(*evset(i, k));
+            } else {
+                _mm_clflushopt((void*)line(i, k));
+            }
+        }
+        const uint64_t curr = rdtscp();
+        d                   = curr - prev;
+        prev                = curr;
+        i                   = (i + 1) % g_num_sync_rows;
+    }
+    if(iterations.empty()) {
+        return 0;
+    }
+
+    std::sort(iterations.begin(), iterations.end());
+    const uint64_t typical = iterations[iterations.size() / 2];
+    const uint64_t blocked = iterations[iterations.size() * 995 / 1000];
+    return static_cast<int>((typical + blocked) / 2);
+}
 
 void hammer_jitted_self_sync(const hammer_pattern_t& pattern,
                              std::vector<dram_address>& sync_rows,
@@ -50,16 +570,13 @@ void hammer_jitted_self_sync(const hammer_pattern_t& pattern,
         throw std::runtime_error("pattern must contain at least one burst");
     }
 
-    g_sync_rows_storage = convert_addresses_to_virtual(sync_rows);
-    g_num_sync_rows     = static_cast<int>(g_sync_rows_storage.size());
-    g_sync_rows         = g_sync_rows_storage.data();
-    g_ref_threshold     = ref_threshold;
+    setup_sync(pattern, sync_rows);
+    g_ref_threshold = ref_threshold;
 
 
     // ── 1. Assemble to a fresh CodeHolder ───────────────────────────────
-    JitRuntime jit_runtime;
     CodeHolder code;
-    code.init(jit_runtime.environment());
+    code.init(Environment::host());
     x86::Assembler a{ &code };
 
     // ── 2. Prologue – callee-saved regs used as loop state ──────────────
@@ -84,13 +601,14 @@ void hammer_jitted_self_sync(const hammer_pattern_t& pattern,
     Label done       = a.newLabel();
 
     a.mov(x86::rbx, imm(pattern_repetitions));
+    a.align(AlignMode::kCode, CODE_ALIGN);
     a.bind(loopTop);
     a.test(x86::rbx, x86::rbx);
     a.jle(done);
 
     // ── 4. Timestamp from global_ref_sync(&thread_data, idx) ────────────
     a.xor_(x86::eax, x86::eax);
-    a.mov(x86::rax, imm((uint64_t)&global_ref_sync));
+    a.mov(x86::rax, imm(ref_sync_fn()));
     a.call(x86::rax); // RAX = timestamp
 
     // ── 5. diff / threshold; update R13(prev_ts) & R12(idx) ─────────────
@@ -102,6 +620,9 @@ void hammer_jitted_self_sync(const hammer_pattern_t& pattern,
     a.add(x86::r12, x86::rax);  // idx += q
     a.add(x86::r12, 1);         // idx += 1
 
+    // ---- count desynchronized bursts (q != 0) ---------------------------
+    emit_desync_count(a);
+
     // ---- idx %= burstCount --------------------------------------------
     a.mov(x86::rax, x86::r12);
     a.xor_(x86::rdx, x86::rdx);
@@ -113,23 +634,25 @@ void hammer_jitted_self_sync(const hammer_pattern_t& pattern,
     a.lfence();
     a.jmp(x86::r11); // → burst[idx]
 
-    // ── 7. One code block per burst ─────────────────────────────────────
+    // ── 7. One code block per burst, each starting on its own line ──────
     std::vector<Label> burstLabel(pattern_length);
     for(uint64_t i = 0; i < pattern_length; ++i) {
         burstLabel[i] = a.newLabel();
+        a.align(AlignMode::kCode, CODE_ALIGN);
         a.bind(burstLabel[i]);
 
         for(auto p : convert_addresses_to_virtual(pattern[i])) {
-            a.mov(x86::r10, imm((uint64_t)p));
-            a.mov(x86::rax, x86::ptr(x86::r10));
-            a.clflushopt(x86::ptr(x86::r10));
+            emit_aggressor_access(a, p);
         }
         a.lfence();
         a.jmp(afterBurst);
     }
 
     // ── 8. After-burst housekeeping ─────────────────────────────────────
+    a.align(AlignMode::kCode, CODE_ALIGN);
     a.bind(afterBurst);
+    emit_burst_timing(a);
+    emit_phase_sweep(a);
     a.dec(x86::rbx);
     a.jmp(loopTop);
 
@@ -143,21 +666,15 @@ void hammer_jitted_self_sync(const hammer_pattern_t& pattern,
     a.pop(x86::rbx);
     a.ret();
 
-    // ── 10. Jump-table data ─────────────────────────────────────────────
+    // ── 10. Jump-table data (never shares a line with code) ─────────────
+    a.align(AlignMode::kData, CODE_ALIGN);
     a.bind(jumpTable);
     for(auto& lbl : burstLabel)
         a.embedLabel(lbl);
 
     // ── 11. Make it callable & run once ─────────────────────────────────
-    using hammer_fn_t = void (*)();
-    hammer_fn_t fn    = nullptr;
-    jit_runtime.add(reinterpret_cast<void**>(&fn), &code);
-    sched_yield();
-    sched_yield();
-    sched_yield();
-    sched_yield();
-    fn();
-    jit_runtime.release(fn);
+    begin_phase_sweep(static_cast<uint64_t>(std::max(pattern_repetitions, 0)), pattern_length);
+    run_jitted(code);
 }
 
 void hammer_jitted_seq_sync(const hammer_pattern_t& pattern,
@@ -170,21 +687,18 @@ void hammer_jitted_seq_sync(const hammer_pattern_t& pattern,
         throw std::runtime_error("pattern must contain at least one burst");
     }
 
-    g_sync_rows_storage = convert_addresses_to_virtual(sync_rows);
-    g_num_sync_rows     = static_cast<int>(g_sync_rows_storage.size());
-    g_sync_rows         = g_sync_rows_storage.data();
-    g_ref_threshold     = ref_threshold;
+    setup_sync(pattern, sync_rows);
+    g_ref_threshold = ref_threshold;
 
-    JitRuntime jit_runtime;
     CodeHolder code;
-    code.init(jit_runtime.environment());
+    code.init(Environment::host());
     x86::Assembler a{ &code };
 
     // ── 1. Prologue ────────────────────────────────────────────────────
     a.push(x86::rbx);
     a.push(x86::rbp);
     a.push(x86::r12);
-    a.push(x86::r13); // (still callee-saved, but now unused)
+    a.push(x86::r13); // (REF timestamp, only used for burst timing)
     a.push(x86::r14); // (unused, kept for stack balance)
     a.push(x86::r15);
 
@@ -200,14 +714,16 @@ void hammer_jitted_seq_sync(const hammer_pattern_t& pattern,
     Label done       = a.newLabel();
 
     a.mov(x86::rbx, imm(pattern_repetitions));
+    a.align(AlignMode::kCode, CODE_ALIGN);
     a.bind(loopTop);
     a.test(x86::rbx, x86::rbx);
     a.jle(done);
 
-    // ── 3. Timestamp pulse (value ignored, still visible to observers) ─
+    // ── 3. Timestamp pulse (only kept for burst timing) ────────────────
     a.xor_(x86::eax, x86::eax);
-    a.mov(x86::rax, imm((uint64_t)&global_ref_sync));
-    a.call(x86::rax); // RAX = timestamp (unused)
+    a.mov(x86::rax, imm(ref_sync_fn()));
+    a.call(x86::rax); // RAX = timestamp
+    a.mov(x86::r13, x86::rax);
 
     // ── 4. idx = (idx + 1) % burstCount ────────────────────────────────
     a.add(x86::r12, 1); // ++idx
@@ -221,23 +737,25 @@ void hammer_jitted_seq_sync(const hammer_pattern_t& pattern,
     a.lfence();
     a.jmp(x86::r11);
 
-    // ── 6. One code block per burst ────────────────────────────────────
+    // ── 6. One code block per burst, each starting on its own line ─────
     std::vector<Label> burstLabel(pattern_length);
     for(uint64_t i = 0; i < pattern_length; ++i) {
         burstLabel[i] = a.newLabel();
+        a.align(AlignMode::kCode, CODE_ALIGN);
         a.bind(burstLabel[i]);
 
         for(auto p : convert_addresses_to_virtual(pattern[i])) {
-            a.mov(x86::r10, imm((uint64_t)p));
-            a.mov(x86::rax, x86::ptr(x86::r10));
-            a.clflushopt(x86::ptr(x86::r10));
+            emit_aggressor_access(a, p);
         }
         a.lfence();
         a.jmp(afterBurst);
     }
 
     // ── 7. Housekeeping & loop ─────────────────────────────────────────
+    a.align(AlignMode::kCode, CODE_ALIGN);
     a.bind(afterBurst);
+    emit_burst_timing(a);
+    emit_phase_sweep(a);
     a.dec(x86::rbx);
     a.jmp(loopTop);
 
@@ -251,19 +769,13 @@ void hammer_jitted_seq_sync(const hammer_pattern_t& pattern,
     a.pop(x86::rbx);
     a.ret();
 
-    // ── 9. Jump-table data ─────────────────────────────────────────────
+    // ── 9. Jump-table data (never shares a line with code) ─────────────
+    a.align(AlignMode::kData, CODE_ALIGN);
     a.bind(jumpTable);
     for(auto& lbl : burstLabel)
         a.embedLabel(lbl);
 
     // ── 10. Make it callable & run once ────────────────────────────────
-    using hammer_fn_t = void (*)();
-    hammer_fn_t fn    = nullptr;
-    jit_runtime.add(reinterpret_cast<void**>(&fn), &code);
-    sched_yield();
-    sched_yield();
-    sched_yield();
-    sched_yield();
-    fn();
-    jit_runtime.release(fn);
+    begin_phase_sweep(static_cast<uint64_t>(std::max(pattern_repetitions, 0)), pattern_length);
+    run_jitted(code);
 }
@@ -0,0 +1,275 @@
+#include <hammer/kernels.hpp>
+
+#include <immintrin.h>
+#include <stdexcept>
+#include <string>
+
+/*──────────────────────────── scalar ─────────────────────────────*/
+
+static size_t apply_matrix_scalar(const size_t* matrix, size_t rows, size_t addr) {
+    size_t result = 0;
+    for(size_t i = 0; i < rows; i++) {
+        // parity compiles to a few xor-folds + setp, no popcnt needed
+        result |= (size_t)__builtin_parityll(matrix[i] & addr) << i;
+    }
+    return result;
+}
+
+static void fill_line_scalar(volatile char* line, uint64_t pattern) {
+    auto* words = reinterpret_cast<volatile uint64_t*>(line);
+    for(size_t i = 0; i < CACHE_LINE_SIZE / sizeof(uint64_t); i++) {
+        words[i] = pattern;
+    }
+    _mm_clflushopt(const_cast<char*>(line));
+}
+
+static uint64_t scan_line_scalar(const volatile char* line, uint64_t pattern) {
+    const auto* words = reinterpret_cast<const volatile uint64_t*>(line);
+    uint64_t mismatches = 0;
+    for(size_t i = 0; i < CACHE_LINE_SIZE / sizeof(uint64_t); i++) {
+        uint64_t diff = words[i] ^ pattern;
+        if(diff == 0) {
+            continue;
+        }
+        for(size_t b = 0; b < sizeof(uint64_t); b++) {
+            if((diff >> (8 * b)) & 0xFF) {
+                mismatches |= 1ULL << (i * sizeof(uint64_t) + b);
+            }
+        }
+    }
+    return mismatches;
+}
+
+static void stream_fill_scalar(volatile char* dst, size_t bytes, uint64_t pattern) {
+    auto* words = reinterpret_cast<long long*>(const_cast<char*>(dst));
+    for(size_t i = 0; i < bytes / sizeof(uint64_t); i++) {
+        _mm_stream_si64(words + i, (long long)pattern);
+    }
+    _mm_sfence();
+}
+
+static size_t find_mismatch_scalar(const volatile char* src, size_t bytes, uint64_t pattern) {
+    for(size_t off = 0; off < bytes; off += CACHE_LINE_SIZE) {
+        const auto* words = reinterpret_cast<const volatile uint64_t*>(src + off);
+        uint64_t diff     = 0;
+        for(size_t i = 0; i < CACHE_LINE_SIZE / sizeof(uint64_t); i++) {
+            diff |= words[i] ^ pattern;
+        }
+        _mm_clflushopt(const_cast<char*>(src + off));
+        if(diff != 0) {
+            return off;
+        }
+    }
+    return bytes;
+}
+
+/*───────────────────────────── AVX2 ──────────────────────────────*/
+
+__attribute__((target("avx2"))) static size_t
+apply_matrix_avx2(const size_t* matrix, size_t rows, size_t addr) {
+    const __m256i a = _mm256_set1_epi64x((long long)addr);
+    size_t result   = 0;
+    for(size_t i = 0; i < rows; i += 4) {
+        const size_t left = rows - i;
+        const __m256i load_mask =
+            _mm256_set_epi64x(left > 3 ? -1 : 0, left > 2 ? -1 : 0,
+                              left > 1 ? -1 : 0, -1);
+        __m256i v = _mm256_maskload_epi64((const long long*)(matrix + i), load_mask);
+        v = _mm256_and_si256(v, a);
+
+        // Fold each 64-bit lane onto its lowest bit to get the parity.
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 32));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 16));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 8));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 4));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 2));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 1));
+
+        auto bits = (size_t)_mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_slli_epi64(v, 63)));
+        result |= bits << i;
+    }
+    return result;
+}
+
+__attribute__((target("avx2"))) static void fill_line_avx2(volatile char* line,
+                                                           uint64_t pattern) {
+    const __m256i p = _mm256_set1_epi64x((long long)pattern);
+    auto* dst       = reinterpret_cast<__m256i*>(const_cast<char*>(line));
+    _mm256_store_si256(dst, p);
+    _mm256_store_si256(dst + 1, p);
+    _mm_clflushopt(const_cast<char*>(line));
+}
+
+__attribute__((target("avx2"))) static uint64_t
+scan_line_avx2(const volatile char* line, uint64_t pattern) {
+    const __m256i p = _mm256_set1_epi64x((long long)pattern);
+    const auto* src = reinterpret_cast<const __m256i*>(const_cast<const char*>(line));
+    auto lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(src), p));
+    auto hi = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256(src + 1), p));
+    return ~(((uint64_t)hi << 32) | lo);
+}
+
+__attribute__((target("avx2"))) static void
+stream_fill_avx2(volatile char* dst, size_t bytes, uint64_t pattern) {
+    const __m256i p = _mm256_set1_epi64x((long long)pattern);
+    auto* out       = reinterpret_cast<__m256i*>(const_cast<char*>(dst));
+    for(size_t i = 0; i < bytes / sizeof(__m256i); i++) {
+        _mm256_stream_si256(out + i, p);
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx2"))) static size_t
+find_mismatch_avx2(const volatile char* src, size_t bytes, uint64_t pattern) {
+    const __m256i p = _mm256_set1_epi64x((long long)pattern);
+    for(size_t off = 0; off < bytes; off += CACHE_LINE_SIZE) {
+        auto* line = reinterpret_cast<__m256i*>(const_cast<char*>(src + off));
+        const __m256i diff = _mm256_or_si256(
+            _mm256_xor_si256(_mm256_stream_load_si256(line), p),
+            _mm256_xor_si256(_mm256_stream_load_si256(line + 1), p));
+        _mm_clflushopt(line);
+        if(!_mm256_testz_si256(diff, diff)) {
+            return off;
+        }
+    }
+    return bytes;
+}
+
+/*──────────────────────────── AVX-512 ────────────────────────────*/
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) static size_t
+apply_matrix_avx512(const size_t* matrix, size_t rows, size_t addr) {
+    const __m512i a   = _mm512_set1_epi64((long long)addr);
+    const __m512i one = _mm512_set1_epi64(1);
+    size_t result     = 0;
+    for(size_t i = 0; i < rows; i += 8) {
+        const size_t left = rows - i;
+        const auto load_mask = (__mmask8)(left >= 8 ? 0xFF : (1U << left) - 1);
+        __m512i v = _mm512_maskz_loadu_epi64(load_mask, matrix + i);
+        v         = _mm512_popcnt_epi64(_mm512_and_si512(v, a));
+        result |= (size_t)_mm512_test_epi64_mask(v, one) << i;
+    }
+    return result;
+}
+
+__attribute__((target("avx512f"))) static void fill_line_avx512(volatile char* line,
+                                                                uint64_t pattern) {
+    _mm512_store_si512(const_cast<char*>(line), _mm512_set1_epi64((long long)pattern));
+    _mm_clflushopt(const_cast<char*>(line));
+}
+
+__attribute__((target("avx512f,avx512bw"))) static uint64_t
+scan_line_avx512(const volatile char* line, uint64_t pattern) {
+    const __m512i v = _mm512_load_si512(const_cast<const char*>(line));
+    return _mm512_cmpneq_epi8_mask(v, _mm512_set1_epi64((long long)pattern));
+}
+
+__attribute__((target("avx512f"))) static void
+stream_fill_avx512(volatile char* dst, size_t bytes, uint64_t pattern) {
+    const __m512i p = _mm512_set1_epi64((long long)pattern);
+    auto* out       = const_cast<char*>(dst);
+    for(size_t off = 0; off < bytes; off += sizeof(__m512i)) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(out + off), p);
+    }
+    _mm_sfence();
+}
+
+// Four lines per iteration: one mask test per 256 bytes on the common path.
+__attribute__((target("avx512f"))) static size_t
+find_mismatch_avx512(const volatile char* src, size_t bytes, uint64_t pattern) {
+    const __m512i p = _mm512_set1_epi64((long long)pattern);
+    auto* base      = const_cast<char*>(src);
+    size_t off      = 0;
+    for(; off + 4 * CACHE_LINE_SIZE <= bytes; off += 4 * CACHE_LINE_SIZE) {
+        __m512i diff = _mm512_setzero_si512();
+        for(size_t l = 0; l < 4; l++) {
+            void* line = base + off + l * CACHE_LINE_SIZE;
+            diff = _mm512_or_si512(diff, _mm512_xor_si512(_mm512_stream_load_si512(line), p));
+            _mm_clflushopt(line);
+        }
+        if(_mm512_test_epi64_mask(diff, diff) != 0) {
+            break; // locate the line below
+        }
+    }
+    for(; off < bytes; off += CACHE_LINE_SIZE) {
+        void* line = base + off;
+        const __m512i v = _mm512_stream_load_si512(line);
+        _mm_clflushopt(line);
+        if(_mm512_cmpneq_epi64_mask(v, p) != 0) {
+            return off;
+        }
+    }
+    return bytes;
+}
+
+/*─────────────────────────── dispatch ────────────────────────────*/
+
+static bool cpu_supports(kernel_variant variant) {
+    __builtin_cpu_init();
+    switch(variant) {
+    case kernel_variant::avx512:
+        return __builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512vpopcntdq");
+    case kernel_variant::avx2: return __builtin_cpu_supports("avx2");
+    case kernel_variant::scalar: return true;
+    }
+    return false;
+}
+
+static kernel_table make_table(kernel_variant variant) {
+    switch(variant) {
+    case kernel_variant::avx512:
+        return { variant, &apply_matrix_avx512, &fill_line_avx512, &scan_line_avx512,
+                 &stream_fill_avx512, &find_mismatch_avx512 };
+    case kernel_variant::avx2:
+        return { variant, &apply_matrix_avx2, &fill_line_avx2, &scan_line_avx2,
+                 &stream_fill_avx2, &find_mismatch_avx2 };
+    case kernel_variant::scalar: break;
+    }
+    return { kernel_variant::scalar, &apply_matrix_scalar, &fill_line_scalar,
+             &scan_line_scalar, &stream_fill_scalar, &find_mismatch_scalar };
+}
+
+kernel_variant detect_kernel_variant() {
+    for(auto v : { kernel_variant::avx512, kernel_variant::avx2 }) {
+        if(cpu_supports(v)) {
+            return v;
+        }
+    }
+    return kernel_variant::scalar;
+}
+
+static kernel_table s_kernels = make_table(detect_kernel_variant());
+
+void select_kernels(kernel_variant variant) {
+    if(!cpu_supports(variant)) {
+        throw std::invalid_argument("CPU does not support " +
+                                    std::string(to_string(variant)) + " kernels");
+    }
+    s_kernels = make_table(variant);
+}
+
+const kernel_table& kernels() {
+    return s_kernels;
+}
+
+std::string_view to_string(kernel_variant variant) {
+    switch(variant) {
+    case kernel_variant::avx512: return "avx512";
+    case kernel_variant::avx2: return "avx2";
+    case kernel_variant::scalar: return "scalar";
+    }
+    return "unknown";
+}
+
+kernel_variant parse_kernel_variant(std::string_view name) {
+    for(auto v : { kernel_variant::avx512, kernel_variant::avx2, kernel_variant::scalar }) {
+        if(name == to_string(v)) {
+            return v;
+        }
+    }
+    throw std::invalid_argument("unknown kernel variant: " + std::string(name));
+}
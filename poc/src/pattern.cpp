@@ -1,7 +1,10 @@
 #include <hammer/dram_address.hpp>
 #include <hammer/pattern.hpp>
+#include <hammer/row_mapping.hpp>
 
+#include <set>
 #include <stdexcept>
+#include <tuple>
 #include <vector>
 
 inline std::vector<dram_address> address_unique(std::vector<dram_address> flat) {
@@ -52,6 +55,10 @@ std::vector<dram_address> create_row_pair_addresses_colstride(size_t subchannel,
         colstrides.push_back(col);
     }
 
+    // Second aggressor two physical rows away, so the pair sandwiches a victim
+    const size_t pair_row =
+        physical_neighbour(active_row_remap(), base_row, 2).value_or(base_row + 2);
+
     std::vector<dram_address> addresses;
     addresses.reserve(num_pairs * 2);
     size_t cur_stride = 0;
@@ -59,7 +66,7 @@ std::vector<dram_address> create_row_pair_addresses_colstride(size_t subchannel,
         auto da1 = dram_address(subchannel, rank, bank_group, bank, base_row,
                                 colstrides[cur_stride]);
         auto da2 = dram_address(subchannel, rank, bank_group, bank,
-                                base_row + 2, colstrides[cur_stride]);
+                                pair_row, colstrides[cur_stride]);
         addresses.push_back(da1);
         addresses.push_back(da2);
         cur_stride++;
@@ -68,9 +75,16 @@ std::vector<dram_address> create_row_pair_addresses_colstride(size_t subchannel,
     return addresses;
 }
 
+// Physical neighbours of every aggressor, under the active remapping or, while
+// it is being learned, under every known one
 std::vector<dram_address> make_victim_addrs(const std::vector<dram_address>& aggressors) {
+    std::vector<row_remap> remaps{ active_row_remap() };
+    if(row_remap_learning()) {
+        remaps.assign(kRowRemaps.begin(), kRowRemaps.end());
+    }
+
     std::vector<dram_address> victims;
-    victims.reserve(aggressors.size()); // two per aggressor
+    victims.reserve(aggressors.size() * 2 * remaps.size()); // two per aggressor
 
     for(const auto& aggressor : aggressors) {
         std::size_t sc  = aggressor.subchannel();
@@ -78,12 +92,14 @@ std::vector<dram_address> make_victim_addrs(const std::vector<dram_address>& agg
         std::size_t bg  = aggressor.bank_group();
         std::size_t bk  = aggressor.bank();
         std::size_t col = aggressor.column();
-        std::size_t row = aggressor.row();
 
-        if(row > 0) {
-            victims.emplace_back(sc, rk, bg, bk, row - 1, col);
+        for(auto remap : remaps) {
+            for(long distance : { -1L, 1L }) {
+                if(auto row = physical_neighbour(remap, aggressor.row(), distance)) {
+                    victims.emplace_back(sc, rk, bg, bk, *row, col);
+                }
+            }
         }
-        victims.emplace_back(sc, rk, bg, bk, row + 1, col);
     }
 
     return victims;
@@ -94,7 +110,19 @@ std::vector<dram_address> pattern_aggressors(const hammer_pattern_t& pat) {
 }
 
 std::vector<dram_address> pattern_victims(const hammer_pattern_t& pat) {
-    return address_unique(make_victim_addrs(pattern_aggressors(pat)));
+    const auto aggressors = pattern_aggressors(pat);
+    auto victims          = address_unique(make_victim_addrs(aggressors));
+
+    // A row that is another pair's aggressor must keep its aggressor data
+    using row_key = std::tuple<size_t, size_t, size_t, size_t, size_t>;
+    std::set<row_key> aggressor_rows;
+    for(const auto& a : aggressors) {
+        aggressor_rows.emplace(a.subchannel(), a.rank(), a.bank_group(), a.bank(), a.row());
+    }
+    std::erase_if(victims, [&](const dram_address& v) {
+        return aggressor_rows.count({ v.subchannel(), v.rank(), v.bank_group(), v.bank(), v.row() }) > 0;
+    });
+    return victims;
 }
 
 hammer_pattern_t assemble_skh_mod128_pattern(int subchannel,
@@ -278,7 +306,7 @@ hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
                                              const std::vector<int>& ranks,
                                              const std::vector<int>& bank_groups,
                                              const std::vector<int>& banks,
-                                             int row_base_offset,
+                                             const std::vector<int>& row_base_offsets,
                                              int reads_per_trefi,
                                              int column_stride,
                                              std::size_t burst_rotation,
@@ -286,6 +314,10 @@ hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
     if(subchannels.empty() || ranks.empty() || bank_groups.empty() || banks.empty()) {
         throw std::invalid_argument("selector lists must not be empty");
     }
+    if(row_base_offsets.size() !=
+       subchannels.size() * ranks.size() * bank_groups.size() * banks.size()) {
+        throw std::invalid_argument("need exactly one row base offset per bank");
+    }
 
     hammer_pattern_t result;
     bool first = true;
@@ -297,8 +329,8 @@ hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
             for(int bg : bank_groups) {
                 for(int bk : banks) {
                     hammer_pattern_t pat =
-                        builder(sc, rk, bg, bk, row_base_offset, reads_per_trefi,
-                                column_stride, offset_increment);
+                        builder(sc, rk, bg, bk, row_base_offsets[stride],
+                                reads_per_trefi, column_stride, offset_increment);
 
                     pat = rotate_pattern_right(pat, burst_rotation);
 
@@ -316,4 +348,22 @@ hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+hammer_pattern_t assemble_multi_bank_pattern(bank_pattern_builder_t builder,
+                                             const std::vector<int>& subchannels,
+                                             const std::vector<int>& ranks,
+                                             const std::vector<int>& bank_groups,
+                                             const std::vector<int>& banks,
+                                             int row_base_offset,
+                                             int reads_per_trefi,
+                                             int column_stride,
+                                             std::size_t burst_rotation,
+                                             int offset_increment) {
+    std::vector<int> row_base_offsets(
+        subchannels.size() * ranks.size() * bank_groups.size() * banks.size(),
+        row_base_offset);
+    return assemble_multi_bank_pattern(builder, subchannels, ranks, bank_groups,
+                                       banks, row_base_offsets, reads_per_trefi,
+                                       column_stride, burst_rotation, offset_increment);
+}
@@ -0,0 +1,119 @@
+#include <hammer/phase_profiler.hpp>
+#include <hammer/time_utils.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+
+std::string_view to_string(sweep_phase phase) {
+    switch(phase) {
+    case sweep_phase::assemble: return "assemble";
+    case sweep_phase::victims: return "victims";
+    case sweep_phase::data_init: return "data_init";
+    case sweep_phase::jit_compile: return "jit_compile";
+    case sweep_phase::hammer: return "hammer";
+    case sweep_phase::scan: return "scan";
+    case sweep_phase::observers: return "observers";
+    case sweep_phase::integrity: return "integrity";
+    case sweep_phase::thermal_hold: return "thermal_hold";
+    }
+    return "unknown";
+}
+
+void phase_histogram::add(double ns) {
+    min_ns = count == 0 ? ns : std::min(min_ns, ns);
+    max_ns = std::max(max_ns, ns);
+    sum_ns += ns;
+    ++count;
+    const int bucket = ns < 1 ? 0 : static_cast<int>(std::log2(ns));
+    ++buckets[std::min<std::size_t>(bucket, kBuckets - 1)];
+}
+
+double phase_histogram::quantile_ns(double q) const {
+    const auto rank = static_cast<uint64_t>(std::ceil(q * count));
+    uint64_t seen   = 0;
+    for(std::size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if(seen >= rank && seen > 0) {
+            return std::min(std::ldexp(1.0, static_cast<int>(i) + 1), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+phase_profiler::phase_profiler() {
+    tsc_cycles_per_ns(); // calibrate before the first phase starts
+    last_ = start_ = tsc_now();
+}
+
+void phase_profiler::account(uint64_t now) {
+    if(!stack_.empty()) {
+        current_[static_cast<int>(stack_.back())] += now - last_;
+    }
+    last_ = now;
+}
+
+void phase_profiler::push(sweep_phase phase) {
+    account(tsc_now());
+    stack_.push_back(phase);
+    HAMMER_PROBE2(phase_begin, static_cast<int>(phase), to_string(phase).data());
+}
+
+void phase_profiler::pop() {
+    if(stack_.empty()) {
+        throw std::logic_error("phase_profiler: pop() without push()");
+    }
+    account(tsc_now());
+    [[maybe_unused]] const sweep_phase phase = stack_.back();
+    stack_.pop_back();
+    HAMMER_PROBE3(phase_end, static_cast<int>(phase), to_string(phase).data(),
+                  current_[static_cast<int>(phase)]);
+}
+
+void phase_profiler::end_point() {
+    account(tsc_now());
+    const double cycles_per_ns = tsc_cycles_per_ns();
+    for(std::size_t i = 0; i < kNumSweepPhases; ++i) {
+        histograms_[i].add(current_[i] / cycles_per_ns);
+    }
+    HAMMER_PROBE1(point_end, points_);
+    current_.fill(0);
+    ++points_;
+}
+
+void phase_profiler::print_summary(std::ostream& os) const {
+    if(points_ == 0) {
+        return;
+    }
+    const double wall_ns = (tsc_now() - start_) / tsc_cycles_per_ns();
+    double tracked_ns    = 0;
+    for(const auto& h : histograms_) {
+        tracked_ns += h.sum_ns;
+    }
+
+    const auto flags = os.flags();
+    const auto prec  = os.precision();
+    os << "\n[+] Time per phase over " << points_ << " fuzz points (" << std::fixed
+       << std::setprecision(1) << wall_ns / 1e9 << " s wall time):\n"
+       << "    " << std::left << std::setw(12) << "phase" << std::right << std::setw(10)
+       << "total s" << std::setw(8) << "share" << std::setw(12) << "mean ms"
+       << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms" << std::setw(12)
+       << "max ms" << '\n';
+    for(std::size_t i = 0; i < kNumSweepPhases; ++i) {
+        const auto& h = histograms_[i];
+        os << "    " << std::left << std::setw(12) << to_string(static_cast<sweep_phase>(i))
+           << std::right << std::setw(10) << h.sum_ns / 1e9 << std::setw(7)
+           << 100 * h.sum_ns / wall_ns << '%' << std::setprecision(3) << std::setw(12)
+           << h.sum_ns / h.count / 1e6 << std::setw(12) << h.quantile_ns(0.5) / 1e6
+           << std::setw(12) << h.quantile_ns(0.99) / 1e6 << std::setw(12) << h.max_ns / 1e6
+           << std::setprecision(1) << '\n';
+    }
+    os << "    " << std::left << std::setw(12) << "other" << std::right << std::setw(10)
+       << (wall_ns - tracked_ns) / 1e9 << std::setw(7)
+       << 100 * (wall_ns - tracked_ns) / wall_ns << "%\n"
+       << "    hammering: " << 100 * histogram(sweep_phase::hammer).sum_ns / wall_ns
+       << "% of wall time\n";
+    os.flags(flags);
+    os.precision(prec);
+}
@@ -0,0 +1,157 @@
+#include <hammer/profile.hpp>
+#include <hammer/time_utils.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+static constexpr char kFingerprintPrefix[] = "fingerprint.";
+
+static uint64_t fnv1a(const std::string& s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for(unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+fs::path profile_store::path_for(const host_fingerprint& fp) const {
+    std::string identity;
+    for(const auto& field : kProfileIdentityFields) {
+        auto it = fp.find(field);
+        identity += field + '=' + (it != fp.end() ? it->second : "") + '\n';
+    }
+
+    std::ostringstream name;
+    name << "profile_" << std::hex << std::setw(16) << std::setfill('0')
+         << fnv1a(identity) << ".txt";
+    return dir_ / name.str();
+}
+
+static calibration_profile parse_profile(std::istream& in) {
+    std::map<std::string, std::string> kv;
+    std::string line;
+    while(std::getline(in, line)) {
+        if(line.empty() || line[0] == '#') {
+            continue;
+        }
+        auto eq = line.find('=');
+        if(eq == std::string::npos) {
+            throw std::runtime_error("malformed profile line: " + line);
+        }
+        kv[line.substr(0, eq)] = line.substr(eq + 1);
+    }
+
+    auto get_int = [&](const std::string& key) { return std::stoi(kv.at(key)); };
+
+    calibration_profile p;
+    for(const auto& [key, value] : kv) {
+        if(key.rfind(kFingerprintPrefix, 0) == 0) {
+            p.fingerprint[key.substr(sizeof(kFingerprintPrefix) - 1)] = value;
+        }
+    }
+    p.pattern_id            = kv.at("pattern_id");
+    p.ref_threshold         = get_int("ref_threshold");
+    p.column_stride         = get_int("column_stride");
+    p.best_reads_per_trefi  = get_int("best_reads_per_trefi");
+    p.best_self_sync_cycles = get_int("best_self_sync_cycles");
+    p.best_flips            = std::stoul(kv.at("best_flips"));
+    p.reads_per_trefi_min   = get_int("reads_per_trefi_min");
+    p.reads_per_trefi_max   = get_int("reads_per_trefi_max");
+    p.self_sync_cycles_min  = get_int("self_sync_cycles_min");
+    p.self_sync_cycles_max  = get_int("self_sync_cycles_max");
+    p.updated               = kv["updated"];
+    return p;
+}
+
+std::optional<calibration_profile>
+profile_store::load(const host_fingerprint& fp, std::vector<std::string>* changed) const {
+    const auto path = path_for(fp);
+    std::ifstream in(path);
+    if(!in) {
+        return std::nullopt;
+    }
+
+    calibration_profile profile;
+    try {
+        profile = parse_profile(in);
+    } catch(const std::exception&) {
+        // Unreadable profiles are treated like stale ones.
+        in.close();
+        fs::rename(path, fs::path(path).replace_extension(".stale"));
+        return std::nullopt;
+    }
+    in.close();
+
+    std::vector<std::string> diff;
+    for(const auto& [key, value] : fp) {
+        auto it = profile.fingerprint.find(key);
+        if(it == profile.fingerprint.end() || it->second != value) {
+            diff.push_back(key);
+        }
+    }
+    if(!diff.empty()) {
+        fs::rename(path, fs::path(path).replace_extension(".stale"));
+        if(changed) {
+            *changed = std::move(diff);
+        }
+        return std::nullopt;
+    }
+
+    return profile;
+}
+
+void profile_store::save(const calibration_profile& p) const {
+    fs::create_directories(dir_);
+    const auto path = path_for(p.fingerprint);
+
+    // Write to a temporary file first so an interrupted run never leaves a
+    // truncated profile behind.
+    auto tmp = fs::path(path).replace_extension(".tmp");
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if(!out) {
+            throw std::runtime_error("Cannot open " + tmp.string());
+        }
+        out << "# Phoenix calibration profile\n";
+        for(const auto& [key, value] : p.fingerprint) {
+            out << kFingerprintPrefix << key << '=' << value << '\n';
+        }
+        out << "pattern_id=" << p.pattern_id << '\n'
+            << "ref_threshold=" << p.ref_threshold << '\n'
+            << "column_stride=" << p.column_stride << '\n'
+            << "best_reads_per_trefi=" << p.best_reads_per_trefi << '\n'
+            << "best_self_sync_cycles=" << p.best_self_sync_cycles << '\n'
+            << "best_flips=" << p.best_flips << '\n'
+            << "reads_per_trefi_min=" << p.reads_per_trefi_min << '\n'
+            << "reads_per_trefi_max=" << p.reads_per_trefi_max << '\n'
+            << "self_sync_cycles_min=" << p.self_sync_cycles_min << '\n'
+            << "self_sync_cycles_max=" << p.self_sync_cycles_max << '\n'
+            << "updated=" << iso_timestamp() << '\n';
+    }
+    fs::rename(tmp, path);
+}
+
+bool profile_store::invalidate(const host_fingerprint& fp) const {
+    return fs::remove(path_for(fp));
+}
+
+std::vector<int> narrow_range(const std::vector<int>& full, int lo, int hi) {
+    if(full.empty() || lo > hi) {
+        return full;
+    }
+    const int step = full.size() > 1 ? std::max(1, full[1] - full[0]) : 1;
+
+    // Only values of the sweep itself, so the margin never leaves its range or grid
+    std::vector<int> values;
+    std::copy_if(full.begin(), full.end(), std::back_inserter(values),
+                 [&](int v) { return v >= lo - step && v <= hi + step; });
+    return values.empty() ? full : values;
+}
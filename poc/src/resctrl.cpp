@@ -0,0 +1,263 @@
+#include <hammer/resctrl.hpp>
+
+#include <algorithm>
+#include <bitset>
+#include <cerrno>
+#include <csignal>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Write end of the self-pipe; the handler only forwards the signal number to
+// the watcher thread, which restores resctrl outside of signal context
+static int g_signal_fd = -1;
+
+static void forward_signal(int sig) {
+    const int saved_errno   = errno;
+    const unsigned char num = static_cast<unsigned char>(sig);
+    [[maybe_unused]] const auto n = write(g_signal_fd, &num, 1);
+    errno = saved_errno;
+}
+
+static std::string read_file(const fs::path& path) {
+    std::ifstream in(path);
+    if(!in) {
+        throw std::runtime_error("cannot read " + path.string());
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::string trim(const std::string& s) {
+    const auto first = s.find_first_not_of(" \t\n");
+    if(first == std::string::npos) {
+        return "";
+    }
+    return s.substr(first, s.find_last_not_of(" \t\n") - first + 1);
+}
+
+// Domain ids of a schemata line such as "L3:0=ffff;1=ffff".
+static std::vector<std::string> domains(const std::string& line) {
+    std::vector<std::string> ids;
+    std::istringstream ss(line.substr(line.find(':') + 1));
+    std::string item;
+    while(std::getline(ss, item, ';')) {
+        ids.push_back(trim(item.substr(0, item.find('='))));
+    }
+    return ids;
+}
+
+static std::string schemata_line(const std::string& resource,
+                                 const std::vector<std::string>& ids,
+                                 const std::string& value) {
+    std::string line = resource + ':';
+    for(std::size_t i = 0; i < ids.size(); ++i) {
+        line += (i ? ";" : "") + ids[i] + '=' + value;
+    }
+    return line;
+}
+
+bool resctrl_isolation::available(const fs::path& root) {
+    std::error_code ec;
+    return fs::exists(root / "info" / "L3" / "cbm_mask", ec);
+}
+
+resctrl_isolation::resctrl_isolation(resctrl_params params, pid_t tid)
+: params_{ std::move(params) }, tid_{ tid }, group_dir_{ params_.root / params_.group } {
+    if(!available(params_.root)) {
+        throw std::runtime_error("resctrl with L3 allocation is not mounted at " +
+                                 params_.root.string());
+    }
+
+    std::istringstream schemata(read_file(params_.root / "schemata"));
+    std::string line;
+    while(std::getline(schemata, line)) {
+        line = trim(line);
+        if(const auto colon = line.find(':'); colon != std::string::npos) {
+            root_schemata_[line.substr(0, colon)] = line;
+        }
+    }
+    if(!root_schemata_.count("L3")) {
+        throw std::runtime_error("default resctrl group has no L3 schemata");
+    }
+
+    const unsigned long full =
+        std::stoul(trim(read_file(params_.root / "info/L3/cbm_mask")), nullptr, 16);
+    const unsigned ways = std::bitset<64>(full).count();
+    const unsigned min_bits =
+        std::stoul(trim(read_file(params_.root / "info/L3/min_cbm_bits")));
+    if(params_.l3_ways < std::max(1u, min_bits) || params_.l3_ways + min_bits > ways) {
+        throw std::runtime_error("cannot reserve " + std::to_string(params_.l3_ways) +
+                                 " of " + std::to_string(ways) + " L3 ways");
+    }
+    // The upper ways for the hammer thread, the rest for everyone else; both contiguous
+    const unsigned long dedicated = ((1UL << params_.l3_ways) - 1) << (ways - params_.l3_ways);
+    auto hex = [](unsigned long v) {
+        std::ostringstream ss;
+        ss << std::hex << v;
+        return ss.str();
+    };
+    const auto l3_domains = domains(root_schemata_["L3"]);
+    group_l3_ = schemata_line("L3", l3_domains, hex(dedicated));
+    root_l3_  = schemata_line("L3", l3_domains, hex(full & ~dedicated));
+
+    if(params_.mba >= 0) {
+        if(!root_schemata_.count("MB")) {
+            throw std::runtime_error("resctrl has no memory bandwidth allocation (MB)");
+        }
+        root_mb_ =
+            schemata_line("MB", domains(root_schemata_["MB"]), std::to_string(params_.mba));
+    }
+
+    std::error_code ec;
+    fs::create_directory(group_dir_, ec);
+    if(ec) {
+        throw std::runtime_error("cannot create resctrl group " + group_dir_.string() + ": " +
+                                 ec.message());
+    }
+    start_signal_watcher();
+
+    try {
+        write_schemata(group_dir_, group_l3_);
+        set_enabled(true);
+    } catch(...) {
+        restore();
+        stop_signal_watcher();
+        throw;
+    }
+}
+
+resctrl_isolation::~resctrl_isolation() {
+    restore();
+    stop_signal_watcher();
+}
+
+void resctrl_isolation::start_signal_watcher() {
+    if(g_signal_fd >= 0 || pipe(signal_pipe_) != 0) {
+        // Another instance owns the handlers, or no pipe: restore on destruction only
+        signal_pipe_[0] = signal_pipe_[1] = -1;
+        return;
+    }
+    g_signal_fd = signal_pipe_[1];
+    signal_watcher_ = std::thread([this] {
+        unsigned char sig = 0;
+        while(read(signal_pipe_[0], &sig, 1) < 0 && errno == EINTR) {
+        }
+        if(sig == 0) {
+            return; // stop_signal_watcher()
+        }
+        restore();
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    });
+
+    struct sigaction sa {};
+    sa.sa_handler = forward_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, &old_sigint_);
+    sigaction(SIGTERM, &sa, &old_sigterm_);
+}
+
+void resctrl_isolation::stop_signal_watcher() {
+    if(!signal_watcher_.joinable()) {
+        return;
+    }
+    sigaction(SIGINT, &old_sigint_, nullptr);
+    sigaction(SIGTERM, &old_sigterm_, nullptr);
+    const unsigned char stop = 0;
+    [[maybe_unused]] const auto n = write(signal_pipe_[1], &stop, 1);
+    signal_watcher_.join();
+    g_signal_fd = -1;
+    close(signal_pipe_[0]);
+    close(signal_pipe_[1]);
+    signal_pipe_[0] = signal_pipe_[1] = -1;
+}
+
+void resctrl_isolation::write_schemata(const fs::path& group_dir, const std::string& line) {
+    std::ofstream out(group_dir / "schemata");
+    out << line << '\n';
+    out.close();
+    if(!out) {
+        std::string status;
+        try {
+            status = trim(read_file(params_.root / "info" / "last_cmd_status"));
+        } catch(const std::exception&) {
+        }
+        throw std::runtime_error("resctrl rejected \"" + line + "\": " + status);
+    }
+}
+
+void resctrl_isolation::write_task(const fs::path& group_dir) {
+    std::ofstream out(group_dir / "tasks");
+    out << tid_ << '\n';
+    out.close();
+    if(!out) {
+        throw std::runtime_error("cannot move thread " + std::to_string(tid_) + " to " +
+                                 group_dir.string());
+    }
+}
+
+void resctrl_isolation::set_enabled(bool enabled) {
+    std::lock_guard lock{ mutex_ };
+    if(enabled) {
+        write_schemata(params_.root, root_l3_);
+        write_task(group_dir_);
+    } else {
+        write_task(params_.root);
+        write_schemata(params_.root, root_schemata_["L3"]);
+    }
+    enabled_ = enabled;
+}
+
+void resctrl_isolation::begin_hammer() {
+    std::lock_guard lock{ mutex_ };
+    if(enabled_ && !root_mb_.empty()) {
+        write_schemata(params_.root, root_mb_);
+        throttled_ = true;
+    }
+}
+
+void resctrl_isolation::end_hammer() {
+    std::lock_guard lock{ mutex_ };
+    unthrottle();
+}
+
+void resctrl_isolation::unthrottle() {
+    if(throttled_) {
+        write_schemata(params_.root, root_schemata_["MB"]);
+        throttled_ = false;
+    }
+}
+
+std::string resctrl_isolation::describe() const {
+    std::string s = "group " + group_dir_.string() + " " + group_l3_ + ", default " + root_l3_;
+    if(!root_mb_.empty()) {
+        s += " (" + root_mb_ + " while hammering)";
+    }
+    return s;
+}
+
+void resctrl_isolation::restore() noexcept {
+    std::lock_guard lock{ mutex_ };
+    if(restored_) {
+        return;
+    }
+    restored_ = true;
+    // Keep undoing the remaining changes if one of them fails
+    auto attempt = [](auto&& undo) {
+        try {
+            undo();
+        } catch(const std::exception&) {
+        }
+    };
+    attempt([&] { unthrottle(); });
+    attempt([&] { write_task(params_.root); });
+    attempt([&] { write_schemata(params_.root, root_schemata_["L3"]); });
+    std::error_code ec;
+    fs::remove(group_dir_, ec);
+}
@@ -0,0 +1,120 @@
+#include <hammer/row_mapping.hpp>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+static row_remap s_row_remap = row_remap::direct;
+static bool s_learning       = false;
+
+std::string_view to_string(row_remap remap) {
+    switch(remap) {
+    case row_remap::direct: return "direct";
+    case row_remap::samsung: return "samsung";
+    }
+    return "unknown";
+}
+
+row_remap parse_row_remap(std::string_view name) {
+    if(name == "micron") {
+        return row_remap::samsung;
+    }
+    for(auto remap : kRowRemaps) {
+        if(name == to_string(remap)) {
+            return remap;
+        }
+    }
+    throw std::invalid_argument("unknown row remapping " + std::string(name));
+}
+
+size_t to_physical_row(row_remap remap, size_t logical) {
+    switch(remap) {
+    case row_remap::direct: return logical;
+    case row_remap::samsung: {
+        const size_t bit3 = (logical >> 3) & 1;
+        return logical ^ (bit3 << 1) ^ (bit3 << 2);
+    }
+    }
+    return logical;
+}
+
+size_t to_logical_row(row_remap remap, size_t physical) {
+    // Both schemes are involutions
+    return to_physical_row(remap, physical);
+}
+
+std::optional<size_t> physical_neighbour(row_remap remap, size_t logical, long distance) {
+    const long physical = static_cast<long>(to_physical_row(remap, logical)) + distance;
+    if(physical < 0 || static_cast<size_t>(physical) >= dram_address::row_count()) {
+        return std::nullopt;
+    }
+    return to_logical_row(remap, static_cast<size_t>(physical));
+}
+
+void set_row_remap(row_remap remap) {
+    s_row_remap = remap;
+}
+
+row_remap active_row_remap() {
+    return s_row_remap;
+}
+
+void set_row_remap_learning(bool enable) {
+    s_learning = enable;
+}
+
+bool row_remap_learning() {
+    return s_learning;
+}
+
+void row_adjacency_inference::record(const std::vector<dram_address>& aggressors,
+                                     const std::vector<bit_flip_t>& flips) {
+    using row_key = std::tuple<size_t, size_t, size_t, size_t, size_t>;
+    auto key      = [](const dram_address& a, size_t row) {
+        return row_key{ a.subchannel(), a.rank(), a.bank_group(), a.bank(), row };
+    };
+
+    std::set<row_key> hammered, flipped;
+    for(const auto& a : aggressors) {
+        hammered.insert(key(a, a.row()));
+    }
+    std::vector<const dram_address*> rows;
+    for(const auto& f : flips) {
+        if(flipped.insert(key(f.address, f.address.row())).second) {
+            rows.push_back(&f.address);
+        }
+    }
+
+    rows_ += rows.size();
+    for(std::size_t i = 0; i < kRowRemaps.size(); ++i) {
+        for(const dram_address* victim : rows) {
+            for(long distance : { -1L, 1L }) {
+                const auto row = physical_neighbour(kRowRemaps[i], victim->row(), distance);
+                if(row && hammered.count(key(*victim, *row))) {
+                    ++explained_[i];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+std::vector<row_adjacency_inference::score> row_adjacency_inference::scores() const {
+    std::vector<score> out;
+    for(std::size_t i = 0; i < kRowRemaps.size(); ++i) {
+        out.push_back({ kRowRemaps[i], explained_[i] });
+    }
+    std::stable_sort(out.begin(), out.end(),
+                     [](const score& a, const score& b) { return a.explained > b.explained; });
+    return out;
+}
+
+std::optional<row_remap> row_adjacency_inference::decide(std::size_t min_lead) const {
+    const auto s = scores();
+    if(s[0].explained >= s[1].explained + min_lead) {
+        return s[0].remap;
+    }
+    return std::nullopt;
+}
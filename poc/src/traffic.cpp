@@ -0,0 +1,154 @@
+#include <hammer/traffic.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <functional>
+#include <numeric>
+#include <pthread.h>
+#include <random>
+#include <sched.h>
+#include <stdexcept>
+#include <sys/mman.h>
+
+// Work between two bandwidth updates and throttling decisions
+static constexpr std::size_t kTrafficChunk = 1UL << 20;
+static constexpr std::size_t kLine         = 64;
+
+std::string_view to_string(traffic_kind kind) {
+    switch(kind) {
+    case traffic_kind::stream: return "stream";
+    case traffic_kind::chase: return "chase";
+    case traffic_kind::write: return "write";
+    }
+    return "unknown";
+}
+
+traffic_kind parse_traffic_kind(std::string_view name) {
+    for(auto kind : { traffic_kind::stream, traffic_kind::chase, traffic_kind::write }) {
+        if(name == to_string(kind)) {
+            return kind;
+        }
+    }
+    throw std::invalid_argument("unknown traffic kind " + std::string(name));
+}
+
+background_traffic::background_traffic(config cfg, int hammer_core) : cfg_{ std::move(cfg) } {
+    if(std::find(cfg_.cores.begin(), cfg_.cores.end(), hammer_core) != cfg_.cores.end()) {
+        throw std::invalid_argument("background traffic must not run on the hammer core");
+    }
+    cfg_.buffer_bytes = std::max(kTrafficChunk, cfg_.buffer_bytes / kTrafficChunk * kTrafficChunk);
+
+    for(std::size_t i = 0; i < cfg_.cores.size(); ++i) {
+        auto w    = std::make_unique<worker>();
+        w->buffer = mmap(nullptr, cfg_.buffer_bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(w->buffer == MAP_FAILED) {
+            for(auto& prev : workers_) {
+                munmap(prev->buffer, cfg_.buffer_bytes);
+            }
+            throw std::runtime_error("cannot map background traffic buffer");
+        }
+        madvise(w->buffer, cfg_.buffer_bytes, MADV_HUGEPAGE); // fewer TLB misses, best effort
+        workers_.push_back(std::move(w));
+    }
+    window_start_ = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < workers_.size(); ++i) {
+        threads_.emplace_back(&background_traffic::run, this, std::ref(*workers_[i]), cfg_.cores[i]);
+    }
+}
+
+background_traffic::~background_traffic() {
+    quit_ = true;
+    for(auto& t : threads_) {
+        t.join();
+    }
+    for(auto& w : workers_) {
+        munmap(w->buffer, cfg_.buffer_bytes);
+    }
+}
+
+void background_traffic::run(worker& w, int cpu) {
+    sched_param normal{};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    // Fault the buffer in from the worker's core, so it lands on its NUMA node
+    auto* base              = static_cast<char*>(w.buffer);
+    const std::size_t lines = cfg_.buffer_bytes / kLine;
+    if(cfg_.kind == traffic_kind::chase) {
+        // Sattolo's algorithm: a single cycle through all lines
+        std::vector<uint32_t> next(lines);
+        std::iota(next.begin(), next.end(), 0);
+        std::mt19937_64 rng(cpu);
+        for(std::size_t i = lines - 1; i > 0; --i) {
+            std::swap(next[i], next[std::uniform_int_distribution<std::size_t>(0, i - 1)(rng)]);
+        }
+        for(std::size_t i = 0; i < lines; ++i) {
+            *reinterpret_cast<char**>(base + i * kLine) = base + next[i] * kLine;
+        }
+    } else {
+        std::memset(base, 0x5a, cfg_.buffer_bytes);
+    }
+
+    using clock         = std::chrono::steady_clock;
+    auto start          = clock::now();
+    uint64_t done       = 0;
+    std::size_t offset  = 0;
+    char* const* cursor = reinterpret_cast<char* const*>(base);
+    while(!quit_.load(std::memory_order_relaxed)) {
+        switch(cfg_.kind) {
+        case traffic_kind::stream:
+            for(std::size_t off = 0; off < kTrafficChunk; off += kLine) {
+                (void)*reinterpret_cast<volatile const uint64_t*>(base + offset + off);
+            }
+            break;
+        case traffic_kind::chase:
+            for(std::size_t i = 0; i < kTrafficChunk / kLine; ++i) {
+                cursor = reinterpret_cast<char* const*>(*reinterpret_cast<char* const volatile*>(cursor));
+            }
+            break;
+        case traffic_kind::write: {
+            const __m128i value = _mm_set1_epi8(static_cast<char>(done >> 20));
+            for(std::size_t off = 0; off < kTrafficChunk; off += 16) {
+                _mm_stream_si128(reinterpret_cast<__m128i*>(base + offset + off), value);
+            }
+            _mm_sfence();
+            break;
+        }
+        }
+        offset = (offset + kTrafficChunk) % cfg_.buffer_bytes;
+        done += kTrafficChunk;
+        w.bytes.fetch_add(kTrafficChunk, std::memory_order_relaxed);
+
+        if(cfg_.target_mbps > 0) {
+            const auto due = start + std::chrono::duration_cast<clock::duration>(
+                                         std::chrono::duration<double>(done / (cfg_.target_mbps * 1e6)));
+            const auto now = clock::now();
+            if(due > now) {
+                std::this_thread::sleep_until(due);
+            } else if(now - due > std::chrono::milliseconds(100)) {
+                // Fell behind (descheduled, MBA throttling): do not catch up in a burst
+                start = now;
+                done  = 0;
+            }
+        }
+    }
+}
+
+background_traffic::window background_traffic::take_window() {
+    uint64_t bytes = 0;
+    for(const auto& w : workers_) {
+        bytes += w->bytes.load(std::memory_order_relaxed);
+    }
+    const auto now = std::chrono::steady_clock::now();
+    window out;
+    out.seconds   = std::chrono::duration<double>(now - window_start_).count();
+    out.mbps      = out.seconds > 0 ? (bytes - window_bytes_) / out.seconds / 1e6 : 0.0;
+    window_start_ = now;
+    window_bytes_ = bytes;
+    return out;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// Minimal checks for the unit tests: failures are counted, not fatal.
+inline int g_check_failures = 0;
+
+#define CHECK(cond)                                                                    \
+    do {                                                                               \
+        if(!(cond)) {                                                                  \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #cond ") failed\n"; \
+            ++g_check_failures;                                                        \
+        }                                                                              \
+    } while(0)
+
+/// Exit code of a test executable named @p name.
+inline int check_result(const char* name) {
+    if(g_check_failures) {
+        std::cerr << name << ": " << g_check_failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << name << ": all checks passed\n";
+    return EXIT_SUCCESS;
+}
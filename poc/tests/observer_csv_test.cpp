@@ -0,0 +1,92 @@
+#include "check.hpp"
+
+#include <hammer/observer_csv.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static const std::string kLegacyHeader =
+    "timestamp,reads_per_trefi,sync_cycles_threshold,row_base_offset,"
+    "virt_addr,subch,rank,bg,bank,row,col,expected_hex,actual_hex";
+
+static std::string first_line(const fs::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+static std::size_t line_count(const fs::path& path) {
+    std::ifstream in(path);
+    std::size_t n = 0;
+    for(std::string line; std::getline(in, line);) {
+        ++n;
+    }
+    return n;
+}
+
+static void write_file(const fs::path& path, const std::string& contents) {
+    std::ofstream out(path);
+    out << contents;
+}
+
+// A CSV with other columns is moved aside instead of being appended to.
+static void test_rotates_file_with_old_header(const fs::path& dir) {
+    const fs::path csv = dir / "bit_flips.csv";
+    const std::string old_contents =
+        kLegacyHeader + "\n2024-01-01T00:00:00,40,1000,7,0x1000,0,0,1,2,3,4,0x55,0x54\n";
+    write_file(csv, old_contents);
+    write_file(dir / "bit_flips.old.csv", "taken\n");
+
+    { CsvWriterObserver writer(csv, "avx2"); }
+
+    const fs::path rotated = dir / "bit_flips.old1.csv";
+    CHECK(fs::exists(rotated));
+    CHECK(first_line(rotated) == kLegacyHeader);
+    CHECK(line_count(rotated) == 2);
+    CHECK(first_line(dir / "bit_flips.old.csv") == "taken");
+    CHECK(first_line(csv).rfind("timestamp,", 0) == 0);
+    CHECK(first_line(csv) != kLegacyHeader);
+    CHECK(line_count(csv) == 1);
+}
+
+// A CSV with the current header is appended to without a second header.
+static void test_appends_to_file_with_current_header(const fs::path& dir) {
+    const fs::path csv = dir / "current.csv";
+    { CsvWriterObserver writer(csv, "scalar"); }
+    const std::string header = first_line(csv);
+    write_file(csv, header + "\nrow\n");
+
+    { CsvWriterObserver writer(csv, "scalar"); }
+
+    CHECK(line_count(csv) == 2);
+    CHECK(!fs::exists(dir / "current.old.csv"));
+}
+
+// Flips are labelled with the base row of their own bank, not the first one.
+static void test_base_row_of_flip_bank() {
+    const hammer_pattern_t pattern;
+    const std::vector<dram_address> banks{ { 0, 0, 1, 2, 0, 0 }, { 0, 0, 3, 1, 0, 0 } };
+    const std::vector<int> base_rows{ 100, 8292 };
+    FuzzPoint fp{ 5, 40, pattern, 1000, base_rows.front(), &banks, &base_rows };
+
+    CHECK(fp.base_row_for(dram_address(0, 0, 1, 2, 102, 64)) == 100);
+    CHECK(fp.base_row_for(dram_address(0, 0, 3, 1, 8293, 0)) == 8292);
+    CHECK(fp.base_row_for(dram_address(0, 0, 2, 2, 7, 0)) == 100); // not a target bank
+    CHECK(fp.base_rows_string() == "100;8292");
+}
+
+int main() {
+    dram_address::configure(16, 1);
+    test_base_row_of_flip_bank();
+    const fs::path dir =
+        fs::temp_directory_path() / ("observer_csv_test." + std::to_string(getpid()));
+    fs::create_directories(dir);
+    test_rotates_file_with_old_header(dir);
+    test_appends_to_file_with_current_header(dir);
+    fs::remove_all(dir);
+    return check_result("observer_csv");
+}
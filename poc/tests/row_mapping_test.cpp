@@ -0,0 +1,83 @@
+#include "check.hpp"
+
+#include <hammer/row_mapping.hpp>
+
+#include <optional>
+#include <vector>
+
+static dram_address row(size_t r) {
+    return dram_address(0, 0, 0, 0, r, 0);
+}
+
+static bit_flip_t flip_in(size_t r) {
+    return bit_flip_t{ row(r), 0x55, 0x54 };
+}
+
+static void test_physical_neighbour_direct() {
+    CHECK(physical_neighbour(row_remap::direct, 100, 1) == 101u);
+    CHECK(physical_neighbour(row_remap::direct, 100, -2) == 98u);
+    CHECK(physical_neighbour(row_remap::direct, 0, -1) == std::nullopt);
+    CHECK(physical_neighbour(row_remap::direct, dram_address::row_count() - 1, 1) == std::nullopt);
+}
+
+static void test_physical_neighbour_samsung() {
+    // Logical rows 8..15 map to physical 14,15,12,13,10,11,8,9
+    CHECK(to_physical_row(row_remap::samsung, 8) == 14u);
+    CHECK(to_physical_row(row_remap::samsung, 14) == 8u);
+    CHECK(to_physical_row(row_remap::samsung, 5) == 5u);
+    for(size_t r = 0; r < 4 * kRowRemapPeriod; ++r) {
+        CHECK(to_logical_row(row_remap::samsung, to_physical_row(row_remap::samsung, r)) == r);
+    }
+
+    // Physical 7 sits next to physical 8, which is logical 14
+    CHECK(physical_neighbour(row_remap::samsung, 7, 1) == 14u);
+    // Logical 8 is physical 14; two rows up is physical 16 = logical 16
+    CHECK(physical_neighbour(row_remap::samsung, 8, 2) == 16u);
+    // Logical 15 is physical 9; one row down is physical 8 = logical 14
+    CHECK(physical_neighbour(row_remap::samsung, 15, -1) == 14u);
+    CHECK(physical_neighbour(row_remap::samsung, 0, -1) == std::nullopt);
+}
+
+// Logical 14 is physical 8, so its flipped neighbour logical 7 (physical 7) is
+// only adjacent under samsung; the second aggressor is far from both.
+static void record_samsung_victim(row_adjacency_inference& inference) {
+    inference.record({ row(14), row(40) }, { flip_in(7) });
+}
+
+static void test_inference_decides_samsung() {
+    row_adjacency_inference inference;
+    CHECK(inference.decide(1) == std::nullopt);
+
+    record_samsung_victim(inference);
+    CHECK(inference.rows() == 1);
+    CHECK(inference.decide(2) == std::nullopt);
+
+    record_samsung_victim(inference);
+    CHECK(inference.decide(2) == row_remap::samsung);
+    const auto scores = inference.scores();
+    CHECK(scores[0].remap == row_remap::samsung && scores[0].explained == 2);
+    CHECK(scores[1].remap == row_remap::direct && scores[1].explained == 0);
+}
+
+static void test_inference_ties_stay_undecided() {
+    row_adjacency_inference inference;
+    // Rows 0..7 are not remapped, so both schemes explain the flip between 2 and 4
+    inference.record({ row(2), row(4) }, { flip_in(3), flip_in(3) });
+    CHECK(inference.rows() == 1);
+    CHECK(inference.decide(1) == std::nullopt);
+    CHECK(inference.decide(0).has_value());
+
+    // A flip next to no aggressor counts for neither scheme
+    inference.record({ row(2), row(4) }, { flip_in(100) });
+    CHECK(inference.rows() == 2);
+    CHECK(inference.scores()[0].explained == 1);
+}
+
+int main() {
+    dram_address::configure(16, 1);
+    test_physical_neighbour_direct();
+    test_physical_neighbour_samsung();
+    test_inference_decides_samsung();
+    test_inference_ties_stay_undecided();
+    return check_result("row_mapping");
+}
@@ -0,0 +1,883 @@
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <sched.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+#include <hammer/allocation.hpp>
+#include <hammer/coverage.hpp>
+#include <hammer/dram_address.hpp>
+#include <hammer/edac.hpp>
+#include <hammer/integrity.hpp>
+#include <hammer/eviction.hpp>
+#include <hammer/hwmon.hpp>
+#include <hammer/jitted.hpp>
+#include <hammer/kernels.hpp>
+#include <hammer/observer_activations.hpp>
+#include <hammer/observer_coverage.hpp>
+#include <hammer/observer_csv.hpp>
+#include <hammer/observer_desync.hpp>
+#include <hammer/observer_edac.hpp>
+#include <hammer/observer_fanout.hpp>
+#include <hammer/observer_integrity.hpp>
+#include <hammer/observer_jit_stats.hpp>
+#include <hammer/observer_phase_sweep.hpp>
+#include <hammer/observer_profile.hpp>
+#include <hammer/observer_progress.hpp>
+#include <hammer/observer_row_remap.hpp>
+#include <hammer/observer_thermal.hpp>
+#include <hammer/observer_traffic.hpp>
+#include <hammer/pagemap.hpp>
+#include <hammer/phase_profiler.hpp>
+#include <hammer/profile.hpp>
+#include <hammer/resctrl.hpp>
+#include <hammer/row_mapping.hpp>
+
+#include "campaign.hpp"
+
+#define SUPERPAGE_MEM_SIZE (1UL << 30)
+
+void configure_unbuffered_output() {
+    setvbuf(stdout, nullptr, _IONBF, 0);
+    setvbuf(stderr, nullptr, _IONBF, 0);
+}
+
+void allocate_single_superpage(int dimm_size_gib, int dimm_ranks) {
+    std::cout << "[+] Allocating single superpage with:\n"
+              << "    DIMM size: " << dimm_size_gib << " GiB\n"
+              << "    DIMM ranks: " << dimm_ranks << std::endl;
+
+    allocation alloc;
+
+    alloc.allocate(1);
+    dram_address::initialize(std::move(alloc), dimm_size_gib, dimm_ranks);
+
+    void* mem         = dram_address::alloc().ptr();
+    auto mem_addr_phy = vaddr2paddr(reinterpret_cast<uint64_t>(mem));
+
+    std::cout << "[+] Mapped 0x" << std::hex << SUPERPAGE_MEM_SIZE
+              << " Bytes at vaddr=0x" << reinterpret_cast<uint64_t>(mem)
+              << ", paddr=0x" << mem_addr_phy << std::dec << std::endl;
+}
+
+const std::unordered_map<std::string_view, hammer_fn_t> kHammerFnRegistry{
+    { "self_sync", &hammer_jitted_self_sync },
+    { "seq_sync", &hammer_jitted_seq_sync }
+};
+
+hammer_fn_t resolve_hammer_fn(std::string_view name) {
+    if(const auto it = kHammerFnRegistry.find(name); it != kHammerFnRegistry.end()) {
+        return it->second;
+    }
+    throw std::invalid_argument("unknown hammer function: " + std::string(name));
+}
+
+const std::unordered_map<std::string_view, bank_pattern_builder_t> kPatternRegistry{
+    { "skh_mod128", &assemble_skh_mod128_pattern },
+    { "skh_mod2608", &assemble_skh_mod2608_pattern }
+};
+
+bank_pattern_builder_t resolve_pattern_builder(std::string_view name) {
+    if(const auto it = kPatternRegistry.find(name); it != kPatternRegistry.end()) {
+        return it->second;
+    }
+    throw std::invalid_argument("unknown pattern: " + std::string(name));
+}
+
+void set_thread_affinity(int core_id) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core_id, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+std::vector<dram_address> get_sync_rows(const cli_params& p) {
+    std::vector<dram_address> addrs;
+    addrs.reserve(p.sync_row_count);
+
+    for(int row = p.sync_row_start;
+        addrs.size() < static_cast<size_t>(p.sync_row_count); ++row) {
+        for(int sc : p.target_subch) {
+            for(int rk : p.target_ranks) {
+                for(int bg : p.target_bg) {
+                    for(int bk : p.target_banks) {
+                        addrs.emplace_back(sc, rk, bg, bk, row, 0);
+                    }
+                }
+            }
+        }
+    }
+    addrs.resize(p.sync_row_count); // truncate if we over‑shot
+    return addrs;
+}
+
+// Rows touched by one bank's pattern (aggressors and victims), relative to its base row.
+// Under a remapping, the rows depend on the base row's position within its remap
+// block, so this is the union over all positions and over every scheme the
+// campaign may switch to (all of them while the remapping is being learned).
+std::pair<int, int> pattern_footprint(bank_pattern_builder_t builder, const cli_params& p) {
+    const int probe_base =
+        static_cast<int>(dram_address::row_count() / 2 / kRowRemapPeriod * kRowRemapPeriod);
+    const row_remap active = active_row_remap();
+    std::vector<row_remap> remaps{ active };
+    if(row_remap_learning()) {
+        remaps.assign(kRowRemaps.begin(), kRowRemaps.end());
+    }
+
+    int lo = INT_MAX, hi = INT_MIN;
+    for(row_remap remap : remaps) {
+        set_row_remap(remap);
+        for(int base = probe_base; base < probe_base + static_cast<int>(kRowRemapPeriod); ++base) {
+            auto pat = builder(0, 0, 0, 0, base, p.reads_per_trefi.front(), p.column_stride,
+                               p.aggressor_spacing);
+            for(const auto& addrs : { pattern_aggressors(pat), pattern_victims(pat) }) {
+                for(const auto& da : addrs) {
+                    lo = std::min(lo, static_cast<int>(da.row()) - base);
+                    hi = std::max(hi, static_cast<int>(da.row()) - base);
+                }
+            }
+        }
+    }
+    set_row_remap(active);
+    return { lo, hi };
+}
+
+std::vector<coverage_point> plan_sweep(bank_pattern_builder_t builder,
+                                       const cli_params& p,
+                                       const std::vector<dram_address>& sync_rows) {
+    const std::size_t num_banks = p.target_subch.size() * p.target_ranks.size() *
+        p.target_bg.size() * p.target_banks.size();
+
+    std::vector<coverage_point> plan;
+    if(!p.coverage) {
+        for(int row = p.aggressor_row_start; row < p.aggressor_row_end; ++row) {
+            plan.push_back({ std::vector<int>(num_banks, row) });
+        }
+        return plan;
+    }
+
+    coverage_plan_params cp;
+    cp.num_banks     = num_banks;
+    cp.rows_per_bank = static_cast<int>(dram_address::row_count());
+    cp.region_rows   = p.coverage_region_rows;
+    std::tie(cp.footprint_lo, cp.footprint_hi) = pattern_footprint(builder, p);
+    cp.excluded_row_start = INT_MAX;
+    cp.excluded_row_end   = INT_MIN;
+    for(const auto& sr : sync_rows) {
+        cp.excluded_row_start = std::min(cp.excluded_row_start, static_cast<int>(sr.row()));
+        cp.excluded_row_end = std::max(cp.excluded_row_end, static_cast<int>(sr.row()) + 1);
+    }
+    cp.max_points = p.coverage_points;
+
+    plan = plan_coverage(cp);
+    std::cout << "[+] Coverage plan: " << plan.size() << " placements per bank over "
+              << cp.rows_per_bank << " rows (footprint " << cp.footprint_lo << ".."
+              << cp.footprint_hi << ", " << cp.region_rows << " rows/region)\n";
+    return plan;
+}
+
+bool elevate_to_max_priority() {
+    int max_priority = sched_get_priority_max(SCHED_FIFO);
+    if(max_priority == -1) {
+        std::cerr << "Failed to get max priority: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    sched_param param{};
+    param.sched_priority = max_priority;
+
+    if(sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+        std::cerr << "Failed to set scheduler: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+std::string run_command(const std::string& cmd) {
+    std::array<char, 256> buffer{};
+    std::string result;
+
+    // Use unique_ptr for RAII-safe pipe closing
+    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
+    if(!pipe) {
+        throw std::runtime_error("popen() failed!");
+    }
+
+    while(fgets(buffer.data(), static_cast<int>(buffer.size()), pipe.get()) != nullptr) {
+        result.append(buffer.data());
+    }
+
+    return result;
+}
+
+int detect_ranks() {
+    std::string output = run_command("sudo dmidecode -t memory");
+    std::istringstream iss(output);
+    std::string line;
+
+    for(; std::getline(iss, line);) {
+        if(line.find("Rank:") != std::string::npos) {
+            std::string value = line.substr(line.find(":") + 1);
+            value.erase(0, value.find_first_not_of(" \t")); // Trim leading space
+            if(!value.empty() && value != "Unknown") {
+                return std::stoi(value);
+            }
+        }
+    }
+
+    throw std::runtime_error("No valid Rank found.");
+}
+
+int detect_dimm_gib() {
+    std::string output = run_command("sudo dmidecode -t memory");
+    std::istringstream iss(output);
+    std::string line;
+    int min_gib           = INT_MAX;
+    bool found_valid_dimm = false;
+
+    while(std::getline(iss, line)) {
+        if(line.find("Size:") == std::string::npos ||
+           line.find("No Module") != std::string::npos)
+            continue;
+
+        std::string value = line.substr(line.find(":") + 1);
+        std::istringstream valss(value);
+        int size;
+        std::string unit;
+        valss >> size >> unit;
+
+        if(size == 0)
+            continue;
+
+        int gib = (unit == "MB") ? size / 1024 : size;
+        if(gib > 0) {
+            found_valid_dimm = true;
+            if(gib < min_gib) {
+                min_gib = gib;
+            }
+        }
+    }
+
+    if(!found_valid_dimm || min_gib == INT_MAX || min_gib == 0) {
+        throw std::runtime_error("No valid non-zero DIMM size found.");
+    }
+
+    return min_gib;
+}
+
+// Helper to trim whitespace from both ends of a string
+static std::string trim(const std::string& s) {
+    auto first = s.find_first_not_of(" \t\n\r");
+    if(first == std::string::npos)
+        return "";
+    auto last = s.find_last_not_of(" \t\n\r");
+    return s.substr(first, last - first + 1);
+}
+
+// Uses your existing run_command() helper
+static std::string get_cpu_model_string() {
+    // Grab the first "model name" line, strip off the "model name : " prefix
+    const std::string cmd =
+        "grep \"model name\" /proc/cpuinfo | head -1 | cut -d: -f2-";
+    std::string raw = run_command(cmd);
+    return trim(raw);
+}
+
+// CPU, microcode, DIMM and BIOS memory settings a calibration profile is valid for.
+static host_fingerprint collect_host_fingerprint() {
+    host_fingerprint fp;
+    fp["cpu_model"] = get_cpu_model_string();
+    fp["microcode"] =
+        trim(run_command("grep -m1 microcode /proc/cpuinfo | cut -d: -f2-"));
+    fp["bios_version"] = trim(run_command("sudo dmidecode -s bios-version"));
+
+    // One "Memory Device" block per slot; skip empty slots.
+    std::map<std::string, std::vector<std::string>> dimm_fields;
+    std::map<std::string, std::string> device;
+    auto flush_device = [&]() {
+        if(!device.empty() && device["Size"] != "No Module Installed") {
+            for(const char* key : { "Part Number", "Serial Number", "Configured Memory Speed",
+                                    "Configured Voltage" }) {
+                dimm_fields[key].push_back(device[key]);
+            }
+        }
+        device.clear();
+    };
+
+    std::istringstream iss(run_command("sudo dmidecode -t memory"));
+    std::string line;
+    bool in_device = false;
+    while(std::getline(iss, line)) {
+        if(line == "Memory Device") {
+            flush_device();
+            in_device = true;
+            continue;
+        }
+        auto colon = line.find(':');
+        if(in_device && colon != std::string::npos) {
+            device[trim(line.substr(0, colon))] = trim(line.substr(colon + 1));
+        }
+    }
+    flush_device();
+
+    auto join = [](const std::vector<std::string>& v) {
+        std::string out;
+        for(const auto& s : v) {
+            out += (out.empty() ? "" : ",") + s;
+        }
+        return out;
+    };
+    fp["dimm_part"]      = join(dimm_fields["Part Number"]);
+    fp["dimm_serial"]    = join(dimm_fields["Serial Number"]);
+    fp["memory_speed"]   = join(dimm_fields["Configured Memory Speed"]);
+    fp["memory_voltage"] = join(dimm_fields["Configured Voltage"]);
+    return fp;
+}
+
+// ACTs per tREFI of clflush- and eviction-based hammering on the pattern's aggressors.
+static void report_access_calibration(const std::vector<dram_address>& aggressors,
+                                      eviction_sets& sets,
+                                      double trefi_ns) {
+    auto lines = convert_addresses_to_virtual(aggressors);
+    const uint64_t threshold = sets.miss_threshold();
+    sets.exclude_banks(aggressors);
+
+    std::cout << "[+] Access calibration on " << lines.size()
+              << " aggressor lines (miss threshold " << threshold << " cycles, tREFI "
+              << trefi_ns << " ns):\n";
+    for(auto* mode_sets : { static_cast<eviction_sets*>(nullptr), &sets }) {
+        const access_rate r = measure_access_rate(lines, mode_sets, threshold, trefi_ns);
+        std::cout << "    " << std::left << std::setw(8) << r.mode << std::right << std::fixed
+                  << std::setprecision(1) << r.cycles_per_access << " cycles/access, "
+                  << 100 * r.dram_fraction << "% from DRAM, " << r.acts_per_trefi
+                  << " ACTs/tREFI\n"
+                  << std::defaultfloat;
+    }
+    std::cout << "    " << sets.built() << " eviction sets built in " << std::fixed
+              << std::setprecision(0) << sets.build_ms() << " ms\n"
+              << std::defaultfloat;
+}
+
+// ns per from_virt/to_virt of the generic and the compile-time translation.
+static void report_mapping_benchmark() {
+    constexpr std::size_t kAddrs  = 4096; // fits in L1 with the results
+    constexpr std::size_t kRounds = 256;
+    auto& alloc = dram_address::alloc();
+    std::mt19937_64 rng(42);
+    std::vector<volatile char*> virts(kAddrs);
+    for(auto& v : virts) {
+        v = static_cast<volatile char*>(alloc.ptr()) + rng() % alloc.size();
+    }
+    std::vector<dram_address> addrs(kAddrs);
+
+    std::cout << "[+] Address translation benchmark (" << kAddrs * kRounds
+              << " translations per direction):\n";
+    for(bool generic : { true, false }) {
+        dram_address::use_generic_mapping(generic);
+        uint64_t sink = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for(std::size_t r = 0; r < kRounds; ++r) {
+            for(std::size_t i = 0; i < kAddrs; ++i) {
+                addrs[i] = dram_address::from_virt(virts[i]);
+                sink += addrs[i].m_row;
+            }
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        for(std::size_t r = 0; r < kRounds; ++r) {
+            for(const auto& a : addrs) {
+                sink += reinterpret_cast<uintptr_t>(a.to_virt());
+            }
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+        const volatile uint64_t keep = sink;
+        (void)keep;
+
+        const double n = kAddrs * kRounds;
+        std::cout << "    " << std::left << std::setw(24) << dram_address::mapping_name()
+                  << std::right << std::fixed << std::setprecision(2) << " from_virt "
+                  << std::chrono::duration<double, std::nano>(t1 - t0).count() / n
+                  << " ns, to_virt "
+                  << std::chrono::duration<double, std::nano>(t2 - t1).count() / n << " ns\n"
+                  << std::defaultfloat;
+    }
+}
+
+// REF-to-REF interval spread of the serial and the parallel REF probe.
+static void report_ref_probe(const hammer_pattern_t& pattern,
+                             std::vector<dram_address>& sync_rows,
+                             int ref_threshold,
+                             unsigned width) {
+    constexpr std::size_t kSamples = 2000;
+    std::cout << "[+] REF-to-REF intervals over " << kSamples << " REFs (threshold "
+              << ref_threshold << " cycles):\n";
+    for(unsigned w : { 1U, width }) {
+        jit_set_ref_probe_width(w);
+        const ref_interval_stats r =
+            jit_measure_ref_intervals(pattern, sync_rows, ref_threshold, kSamples);
+        std::cout << "    " << (w == 1 ? "serial  " : "parallel") << " x" << w << std::fixed
+                  << std::setprecision(1) << "  median " << r.median_cycles << ", mean "
+                  << r.mean_cycles << ", stddev " << r.stddev_cycles << " cycles, "
+                  << r.missed << " missed, " << r.spurious << " spurious\n"
+                  << std::defaultfloat;
+    }
+}
+
+// Narrow the sweep to what worked before, unless overridden on the command line.
+static void warm_start(cli_params& p, const calibration_profile& prof) {
+    auto given = [&](const char* opt) { return p.explicit_options.count(opt) > 0; };
+
+    if(!given("--ref-threshold")) {
+        p.ref_threshold = prof.ref_threshold;
+    }
+    if(!given("--column-stride")) {
+        p.column_stride = prof.column_stride;
+    }
+    if(!given("--pattern")) {
+        p.pattern_id = prof.pattern_id;
+    }
+    if(!given("--reads-per-trefi")) {
+        p.reads_per_trefi = narrow_range(p.reads_per_trefi, prof.reads_per_trefi_min,
+                                         prof.reads_per_trefi_max);
+    }
+    if(!given("--self-sync-cycles")) {
+        p.self_sync_cycles = narrow_range(p.self_sync_cycles, prof.self_sync_cycles_min,
+                                          prof.self_sync_cycles_max);
+    }
+}
+
+std::optional<host_context> init_host() {
+    static constexpr std::array<const char*, 1> AllowedModels = {
+        "AMD Ryzen 7 7700X 8-Core Processor"
+    };
+
+    try {
+        auto cpu_model = get_cpu_model_string();
+        std::cout << "CPU model: " << cpu_model << '\n';
+    } catch(const std::exception& e) {
+        std::cerr << "Failed to detect CPU model: " << e.what() << '\n';
+        return std::nullopt;
+    }
+
+    if(geteuid() != 0) {
+        std::cerr << "[!] This program must be run with sudo/root privileges." << std::endl;
+        return std::nullopt;
+    }
+
+    if(!elevate_to_max_priority()) {
+        std::cerr << "Warning: Running without elevated priority.\n";
+    } else {
+        std::cout << "Running with maximum scheduling priority.\n";
+    }
+
+    configure_unbuffered_output();
+
+    host_context host;
+    host.dimm_ranks    = detect_ranks();
+    host.dimm_size_gib = detect_dimm_gib();
+    allocate_single_superpage(host.dimm_size_gib, host.dimm_ranks);
+    return host;
+}
+
+int run_campaign(cli_params params, host_context& host, campaign_control* control) {
+    const host_fingerprint& fingerprint = host.fingerprint;
+    profile_store profiles(params.profile_dir);
+    if(!params.profile_dir.empty()) {
+        if(host.fingerprint.empty()) {
+            host.fingerprint = collect_host_fingerprint();
+        }
+        if(params.profile_invalidate && profiles.invalidate(fingerprint)) {
+            std::cout << "[+] Discarded calibration profile as requested\n";
+        }
+
+        std::vector<std::string> changed;
+        if(auto prof = profiles.load(fingerprint, &changed)) {
+            std::cout << "[+] Warm-starting from calibration profile "
+                      << profiles.path_for(fingerprint).string() << " (updated "
+                      << prof->updated << ")\n";
+            warm_start(params, *prof);
+        } else if(!changed.empty()) {
+            std::cout << "[!] Calibration profile invalidated, changed:";
+            for(const auto& field : changed) {
+                std::cout << ' ' << field;
+            }
+            std::cout << '\n';
+        }
+    }
+
+    try {
+        select_kernels(params.kernels == "auto" ? detect_kernel_variant()
+                                                : parse_kernel_variant(params.kernels));
+    } catch(const std::exception& e) {
+        std::cerr << "[!] " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    // Dump and record the variant that actually runs, not "auto"
+    params.kernels = to_string(kernels().variant);
+
+    std::cout << params << '\n';
+    std::cout << "[+] Kernel variant: " << params.kernels
+              << " (detected: " << to_string(detect_kernel_variant()) << ")\n";
+
+    if(params.mapping_bench) {
+        report_mapping_benchmark();
+        return EXIT_SUCCESS;
+    }
+    dram_address::use_generic_mapping(params.mapping == "generic");
+    std::cout << "[+] Address mapping: " << dram_address::mapping_name() << '\n';
+
+    auto hammer_fn       = resolve_hammer_fn(params.hammer_fn);
+    auto pattern_builder = resolve_pattern_builder(params.pattern_id);
+
+    // The pattern footprint, and with it the sweep plan, depends on the row remapping
+    const bool infer_row_remap = params.row_remap == "infer";
+    set_row_remap(infer_row_remap ? row_remap::direct : parse_row_remap(params.row_remap));
+    set_row_remap_learning(infer_row_remap);
+    std::unique_ptr<RowRemapObserver> row_remap_log;
+    if(infer_row_remap) {
+        row_remap_log = std::make_unique<RowRemapObserver>(params.row_remap_lead);
+    }
+
+    auto sync_rows = get_sync_rows(params);
+    auto plan      = plan_sweep(pattern_builder, params, sync_rows);
+
+    int total_iterations = params.reads_per_trefi.size() *
+        params.self_sync_cycles.size() * plan.size();
+    ProgressBarObserver ui(total_iterations);
+    CsvWriterObserver csv(params.csv_path, params.kernels);
+    CoverageObserver coverage(dram_address::row_count(),
+                              params.coverage_region_rows, params.coverage_report_path);
+    calibration_profile profile_base;
+    profile_base.fingerprint   = fingerprint;
+    profile_base.pattern_id    = params.pattern_id;
+    profile_base.ref_threshold = params.ref_threshold;
+    profile_base.column_stride = params.column_stride;
+    ProfileObserver profile(profiles, profile_base);
+    JitStatsObserver jit_stats;
+
+    set_thread_affinity(params.cpu_core);
+
+    std::unique_ptr<resctrl_isolation> isolation;
+    if(params.resctrl) {
+        resctrl_params rp;
+        rp.l3_ways = params.resctrl_l3_ways;
+        rp.mba     = params.resctrl_mba;
+        try {
+            isolation = std::make_unique<resctrl_isolation>(
+                rp, static_cast<pid_t>(syscall(SYS_gettid)));
+            std::cout << "[+] resctrl isolation: " << isolation->describe() << '\n';
+        } catch(const std::exception& e) {
+            std::cerr << "[!] resctrl isolation unavailable: " << e.what() << '\n';
+        }
+    }
+    // Burst timing perturbs the hammer loop, so only measure it on request
+    const bool burst_timing = params.burst_timing || params.resctrl_compare;
+    std::unique_ptr<DesyncObserver> desync;
+    if(burst_timing && params.hammer_fn == "self_sync") {
+        desync = std::make_unique<DesyncObserver>(params.desync_log_path, isolation.get());
+    }
+    std::unique_ptr<edac_counters> ce_counters;
+    std::unique_ptr<ras_trace> ras_events;
+    std::unique_ptr<EdacObserver> edac;
+    if(params.edac) {
+        try {
+            ce_counters = std::make_unique<edac_counters>();
+            try {
+                ras_events = std::make_unique<ras_trace>();
+            } catch(const std::exception& e) {
+                std::cerr << "[!] No RAS trace events, counting corrected errors only: "
+                          << e.what() << '\n';
+            }
+            edac = std::make_unique<EdacObserver>(*ce_counters, ras_events.get(),
+                                                  params.edac_log_path);
+            std::cout << "[+] Watching " << ce_counters->size() << " EDAC counters on "
+                      << ce_counters->controllers() << " memory controllers\n";
+        } catch(const std::exception& e) {
+            std::cerr << "[!] EDAC unavailable: " << e.what() << '\n';
+        }
+    }
+    std::unique_ptr<integrity_checker> integrity;
+    std::unique_ptr<IntegrityObserver> integrity_log;
+    if(params.integrity_every > 0) {
+        auto& alloc = dram_address::alloc();
+        integrity   = std::make_unique<integrity_checker>(
+            static_cast<volatile char*>(alloc.ptr()), alloc.size(), params.cpu_core,
+            params.integrity_threads);
+        integrity_log = std::make_unique<IntegrityObserver>(params.integrity_log_path,
+                                                            sync_rows, *integrity);
+    }
+    std::unique_ptr<dimm_temperatures> temps;
+    std::unique_ptr<ThermalObserver> thermal;
+    const bool thermal_gate = params.thermal_min_c > 0 || params.thermal_max_c > 0;
+    if(params.thermal || thermal_gate) {
+        try {
+            temps   = std::make_unique<dimm_temperatures>(
+                params.cpu_core, std::chrono::milliseconds(params.thermal_period_ms));
+            thermal = std::make_unique<ThermalObserver>(params.thermal_log_path, *temps);
+            std::cout << "[+] Sampling " << temps->sensors().size()
+                      << " DIMM temperature sensors every " << params.thermal_period_ms
+                      << " ms\n";
+        } catch(const std::exception& e) {
+            std::cerr << "[!] DIMM temperatures unavailable: " << e.what() << '\n';
+            if(thermal_gate) {
+                return EXIT_FAILURE; // an ungated run would not be comparable
+            }
+        }
+    }
+    std::unique_ptr<PhaseSweepObserver> phase_sweep;
+    if(params.phase_sweep_period > 0) {
+        phase_sweep = std::make_unique<PhaseSweepObserver>(params.phase_sweep_log_path);
+    }
+    std::unique_ptr<background_traffic> traffic;
+    std::unique_ptr<TrafficObserver> traffic_log;
+    if(params.traffic != "off") {
+        background_traffic::config tc;
+        tc.kind         = parse_traffic_kind(params.traffic);
+        tc.cores        = params.traffic_cores;
+        tc.buffer_bytes = static_cast<std::size_t>(params.traffic_buffer_mib) << 20;
+        tc.target_mbps  = params.traffic_mbps;
+        if(tc.cores.empty()) {
+            tc.cores.push_back(params.cpu_core == 0 ? 1 : 0);
+        }
+        try {
+            traffic     = std::make_unique<background_traffic>(tc, params.cpu_core);
+            traffic_log = std::make_unique<TrafficObserver>(params.traffic_log_path, *traffic);
+            std::cout << "[+] Background traffic: " << params.traffic << " on " << tc.cores.size()
+                      << " cores";
+            if(tc.target_mbps > 0) {
+                std::cout << ", " << tc.target_mbps << " MB/s per thread";
+            }
+            std::cout << '\n';
+        } catch(const std::exception& e) {
+            std::cerr << "[!] Background traffic unavailable: " << e.what() << '\n';
+            return EXIT_FAILURE; // an idle run would not be comparable
+        }
+    }
+    std::unique_ptr<ActivationObserver> activations;
+    if(params.predict_activations) {
+        activations = std::make_unique<ActivationObserver>(
+            params.activation_log_path, params.refresh_window_trefis, params.trefi_ns);
+    }
+    FanOutObserver observer{ { &ui, &csv, &jit_stats, params.coverage ? &coverage : nullptr,
+                               params.profile_dir.empty() ? nullptr : &profile,
+                               phase_sweep.get(), desync.get(), edac.get(),
+                               integrity_log.get(), thermal.get(), activations.get(),
+                               traffic_log.get(), row_remap_log.get() } };
+
+    jit_use_hugepage_code(params.jit_hugepage);
+    jit_set_burst_timing(burst_timing);
+
+    // Eviction sets only depend on the allocation, keep them for later campaigns
+    eviction_sets* evsets = nullptr;
+    if(params.access_mode == "evict") {
+        eviction_set_params ep;
+        ep.stride = params.evset_stride;
+        ep.ways   = params.evset_ways;
+        if(!host.evsets || host.evset_params.stride != ep.stride ||
+           host.evset_params.ways != ep.ways) {
+            host.evsets       = std::make_unique<eviction_sets>(ep);
+            host.evset_params = ep;
+        }
+        evsets = host.evsets.get();
+    }
+    jit_use_eviction_sets(evsets);
+    jit_set_phase_sweep(params.phase_sweep_period);
+    jit_set_ref_probe_width(params.ref_probe_width);
+
+    constexpr uint64_t aggressor_fill = 0x0068'0005'5555'5FD3ULL;
+    constexpr uint64_t victim_fill    = 0x0068'000A'AAAA'AFD3ULL;
+
+    std::cout << "Sync rows:" << '\n';
+    for(const auto& sync_row : sync_rows) {
+        std::cout << sync_row.to_string() << '\n';
+    }
+
+    if(integrity) {
+        // Victim rows already hold victim_fill, so the whole allocation has a
+        // single expected value once aggressor rows are restored after each point
+        integrity->fill(victim_fill);
+        std::cout << "[+] Filled " << (dram_address::alloc().size() >> 20)
+                  << " MiB for integrity checks in " << integrity->last_ms() << " ms ("
+                  << integrity->threads() << " threads)\n";
+    }
+
+    phase_profiler phases;
+    jit_set_phase_profiler(&phases);
+
+    bool phase_sweep_checked = false;
+    bool ref_probe_reported  = false;
+    bool ref_calibrated      = params.profile_dir.empty();
+    // Target banks in the order of assemble_multi_bank_pattern and point.base_rows
+    std::vector<dram_address> target_banks;
+    for(int sc : params.target_subch) {
+        for(int rk : params.target_ranks) {
+            for(int bg : params.target_bg) {
+                for(int bk : params.target_banks) {
+                    target_banks.emplace_back(sc, rk, bg, bk, 0, 0);
+                }
+            }
+        }
+    }
+
+    for(std::size_t plan_point = 0; plan_point < plan.size(); ++plan_point) {
+        const auto& point = plan[plan_point];
+        const int row     = point.base_rows.front();
+        for(int reads : params.reads_per_trefi) {
+            for(int sync_cycles : params.self_sync_cycles) {
+                if(control && control->stop && control->stop->load(std::memory_order_relaxed)) {
+                    continue; // cancelled, skip the remaining points
+                }
+
+                if(thermal_gate) {
+                    const double max_c = params.thermal_max_c > 0
+                        ? params.thermal_max_c
+                        : std::numeric_limits<double>::infinity();
+                    if(!temps->wait_for_band(params.thermal_min_c, max_c, std::chrono::seconds(0))) {
+                        scoped_phase timed(&phases, sweep_phase::thermal_hold);
+                        const std::atomic<bool>* stop = control ? control->stop : nullptr;
+                        if(!temps->wait_for_band(params.thermal_min_c, max_c,
+                                                 std::chrono::seconds(params.thermal_timeout_s),
+                                                 stop) &&
+                           !(stop && stop->load())) {
+                            std::cerr << "[!] DIMM temperature not within band after "
+                                      << params.thermal_timeout_s << " s, running point anyway\n";
+                        }
+                    }
+                }
+
+                hammer_pattern_t pat;
+                {
+                    scoped_phase timed(&phases, sweep_phase::assemble);
+                    pat = assemble_multi_bank_pattern(
+                        pattern_builder, params.target_subch, params.target_ranks,
+                        params.target_bg, params.target_banks, point.base_rows, reads,
+                        params.column_stride, params.pattern_trefi_offset_per_bank,
+                        params.aggressor_spacing);
+                    if(params.pattern_phase_offset > 0) {
+                        // Burst i runs slot i + offset, like after `offset` sweep shifts
+                        pat = rotate_pattern_right(
+                            pat, pat.size() - params.pattern_phase_offset % pat.size());
+                    }
+                }
+                if(phase_sweep && !phase_sweep_checked) {
+                    const auto needed =
+                        static_cast<uint64_t>(params.phase_sweep_period) * pat.size();
+                    if(static_cast<uint64_t>(params.trefi_sync_count) < needed) {
+                        std::cerr << "[!] Phase sweep covers "
+                                  << params.trefi_sync_count / params.phase_sweep_period
+                                  << " of " << pat.size() << " phases, use --trefi-repeat "
+                                  << needed << " for all\n";
+                    }
+                    phase_sweep_checked = true;
+                }
+
+                std::vector<dram_address> aggressors, victims;
+                {
+                    scoped_phase timed(&phases, sweep_phase::victims);
+                    aggressors = pattern_aggressors(pat);
+                    victims    = pattern_victims(pat);
+                }
+
+                if(evsets && evsets->built() == 0) {
+                    report_access_calibration(aggressors, *evsets, params.trefi_ns);
+                }
+                if(params.ref_probe_width > 1 && !ref_probe_reported) {
+                    report_ref_probe(pat, sync_rows, params.ref_threshold,
+                                     params.ref_probe_width);
+                    ref_probe_reported = true;
+                }
+                if(!ref_calibrated) {
+                    // The profile keeps the threshold this host needs, not the one passed in
+                    const int measured = jit_calibrate_ref_threshold(pat, sync_rows, 200000);
+                    std::cout << "[+] Measured REF threshold: " << measured
+                              << " cycles (running with " << params.ref_threshold << ")\n";
+                    profile.set_ref_threshold(measured);
+                    ref_calibrated = true;
+                }
+
+                {
+                    scoped_phase timed(&phases, sweep_phase::data_init);
+                    initialize_data_pattern(aggressors, aggressor_fill);
+                    initialize_data_pattern(victims, victim_fill);
+                }
+
+                FuzzPoint fp{ static_cast<int>(plan_point), reads, pat, sync_cycles, row,
+                              &target_banks, &point.base_rows, &victims, &phases };
+
+                if(isolation && params.resctrl_compare) {
+                    isolation->set_enabled(phases.points() % 2 == 0);
+                }
+
+                {
+                    scoped_phase timed(&phases, sweep_phase::observers);
+                    observer.on_pre_iteration(fp);
+                }
+
+                {
+                    // Code execution itself is accounted to sweep_phase::hammer
+                    scoped_phase timed(&phases, sweep_phase::jit_compile);
+                    if(isolation) {
+                        isolation->begin_hammer();
+                    }
+                    if(control && !control->first_hammer) {
+                        control->first_hammer = std::chrono::steady_clock::now();
+                    }
+                    hammer_fn(pat, sync_rows, params.ref_threshold,
+                              params.trefi_sync_count, sync_cycles);
+                    if(isolation) {
+                        isolation->end_hammer();
+                    }
+                }
+
+                std::vector<bit_flip_t> flips;
+                {
+                    scoped_phase timed(&phases, sweep_phase::scan);
+                    flips = collect_bit_flips(victims, victim_fill);
+                }
+
+                std::vector<bit_flip_t> integrity_flips;
+                if(integrity) {
+                    scoped_phase timed(&phases, sweep_phase::integrity);
+                    initialize_data_pattern(aggressors, victim_fill);
+                    if((phases.points() + 1) % params.integrity_every == 0) {
+                        integrity_flips    = integrity->verify(victim_fill);
+                        fp.integrity_flips = &integrity_flips;
+                    }
+                }
+
+                {
+                    scoped_phase timed(&phases, sweep_phase::observers);
+                    observer.on_post_iteration(fp, flips);
+                }
+                phases.end_point();
+            }
+        }
+    }
+
+    observer.on_campaign_end();
+    phases.print_summary(std::cout);
+    jit_set_phase_profiler(nullptr);
+    jit_use_eviction_sets(nullptr);
+    jit_set_ref_probe_width(1);
+    jit_set_burst_timing(false);
+    set_row_remap(row_remap::direct);
+    set_row_remap_learning(false);
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include <hammer/eviction.hpp>
+#include <hammer/profile.hpp>
+
+#include "phoenix_cli.hpp"
+
+/// Host state that outlives a campaign: set up once by phoenix, and once per
+/// daemon lifetime by phoenixd.
+struct host_context {
+    // Collected (via sudo dmidecode) by the first campaign with a profile store
+    host_fingerprint fingerprint;
+    int dimm_ranks{};
+    int dimm_size_gib{};
+    // Built lazily by --access-mode evict campaigns
+    std::unique_ptr<eviction_sets> evsets;
+    eviction_set_params evset_params;
+};
+
+/// Lets a caller cancel a running campaign and time its startup.
+struct campaign_control {
+    /// Checked before every fuzz point; remaining points are skipped once set.
+    const std::atomic<bool>* stop{ nullptr };
+    /// Set when the first hammer function is called.
+    std::optional<std::chrono::steady_clock::time_point> first_hammer;
+};
+
+/// Checks for root, raises the scheduling priority and maps the superpage. Returns nullopt (after printing why) on failure.
+std::optional<host_context> init_host();
+
+/// Runs one sweep with @p params on an initialized host; returns an exit code.
+int run_campaign(cli_params params, host_context& host, campaign_control* control = nullptr);
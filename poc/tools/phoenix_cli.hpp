@@ -3,6 +3,8 @@
 #include <CLI/CLI.hpp>
 #include <filesystem>
 #include <iomanip>
+#include <iostream>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -16,6 +18,7 @@ struct cli_params {
 
     /* timing knobs */
     int ref_threshold{};
+    unsigned ref_probe_width{ 1 };
     std::string self_sync_cycles_str;
     std::string reads_per_trefi_str;
     std::vector<int> self_sync_cycles;
@@ -28,10 +31,34 @@ struct cli_params {
     int aggressor_spacing{};
     int column_stride{};
     int pattern_trefi_offset_per_bank{};
+    int pattern_phase_offset{};
+    std::string row_remap{ "direct" };
+    int row_remap_lead{};
+
+    /* in-run phase sweep */
+    int phase_sweep_period{};
+    std::filesystem::path phase_sweep_log_path{ "results/phase_windows.csv" };
+
+    /* coverage planner */
+    bool coverage{ false };
+    int coverage_region_rows{};
+    std::size_t coverage_points{};
+    std::filesystem::path coverage_report_path;
 
     /* selectors */
     std::string hammer_fn{ "self_sync" };
     std::string pattern_id{ "skh_mod128" };
+    std::string kernels{ "auto" };
+    std::string mapping{ "auto" };
+    bool mapping_bench{ false };
+    bool jit_hugepage{ true };
+    bool burst_timing{ false };
+
+    /* access primitive */
+    std::string access_mode{ "clflush" };
+    std::size_t evset_stride{};
+    std::size_t evset_ways{};
+    double trefi_ns{};
 
     /* topology masks */
     std::vector<int> target_subch;
@@ -39,9 +66,51 @@ struct cli_params {
     std::vector<int> target_bg;
     std::vector<int> target_banks;
 
+    /* resctrl isolation */
+    bool resctrl{ false };
+    unsigned resctrl_l3_ways{};
+    int resctrl_mba{};
+    bool resctrl_compare{ false };
+    std::filesystem::path desync_log_path{ "results/desync.csv" };
+
+    /* full-allocation integrity check */
+    int integrity_every{};
+    unsigned integrity_threads{};
+    std::filesystem::path integrity_log_path{ "results/integrity_flips.csv" };
+
+    /* ECC corrected errors */
+    bool edac{ false };
+    std::filesystem::path edac_log_path{ "results/corrected_errors.csv" };
+
+    /* DIMM temperature */
+    bool thermal{ false };
+    int thermal_period_ms{};
+    double thermal_min_c{};
+    double thermal_max_c{};
+    int thermal_timeout_s{};
+    std::filesystem::path thermal_log_path{ "results/dimm_temperature.csv" };
+
+    /* activation prediction */
+    bool predict_activations{ false };
+    int refresh_window_trefis{};
+    std::filesystem::path activation_log_path{ "results/activation_counts.csv" };
+
+    /* background traffic */
+    std::string traffic{ "off" };
+    std::vector<int> traffic_cores;
+    double traffic_mbps{};
+    int traffic_buffer_mib{};
+    std::filesystem::path traffic_log_path{ "results/background_traffic.csv" };
+
     /* output */
     std::filesystem::path csv_path{ "results/bit_flips.csv" };
 
+    /* calibration profile */
+    std::filesystem::path profile_dir{};
+    bool profile_invalidate{ false };
+    // options given on the command line; these take precedence over the profile
+    std::set<std::string> explicit_options;
+
     /* formatted dump for logging */
     friend std::ostream& operator<<(std::ostream& os, const cli_params& p) {
         constexpr int W = 28;
@@ -64,6 +133,7 @@ struct cli_params {
         line("sync_row_start", p.sync_row_start);
 
         line("ref_threshold", p.ref_threshold);
+        line("ref_probe_width", p.ref_probe_width);
         line("self_sync_cycles", '[' + join(p.self_sync_cycles) + ']');
         line("reads_per_trefi", '[' + join(p.reads_per_trefi) + ']');
         line("trefi_sync_count", p.trefi_sync_count);
@@ -73,9 +143,54 @@ struct cli_params {
         line("aggressor_spacing", p.aggressor_spacing);
         line("column_stride", p.column_stride);
         line("pattern_trefi_offset_per_bank", p.pattern_trefi_offset_per_bank);
+        line("pattern_phase_offset", p.pattern_phase_offset);
+        line("row_remap", p.row_remap);
+        line("row_remap_lead", p.row_remap_lead);
+
+        line("phase_sweep_period", p.phase_sweep_period);
+        line("phase_sweep_log_path", p.phase_sweep_log_path.string());
+
+        line("coverage", p.coverage ? "on" : "off");
+        line("coverage_region_rows", p.coverage_region_rows);
+        line("coverage_points", p.coverage_points);
+        line("coverage_report_path", p.coverage_report_path.string());
 
         line("hammer_fn", p.hammer_fn);
         line("pattern_id", p.pattern_id);
+        line("kernels", p.kernels);
+        line("mapping", p.mapping);
+        line("jit_hugepage", p.jit_hugepage ? "on" : "off");
+        line("burst_timing", p.burst_timing ? "on" : "off");
+        line("access_mode", p.access_mode);
+        line("evset_stride", p.evset_stride);
+        line("evset_ways", p.evset_ways);
+        line("trefi_ns", p.trefi_ns);
+
+        line("resctrl", p.resctrl ? "on" : "off");
+        line("resctrl_l3_ways", p.resctrl_l3_ways);
+        line("resctrl_mba", p.resctrl_mba);
+        line("resctrl_compare", p.resctrl_compare ? "on" : "off");
+        line("desync_log_path", p.desync_log_path.string());
+        line("integrity_every", p.integrity_every);
+        line("integrity_threads", p.integrity_threads);
+        line("integrity_log_path", p.integrity_log_path.string());
+        line("edac", p.edac ? "on" : "off");
+        line("edac_log_path", p.edac_log_path.string());
+
+        line("thermal", p.thermal ? "on" : "off");
+        line("thermal_period_ms", p.thermal_period_ms);
+        line("thermal_min_c", p.thermal_min_c);
+        line("thermal_max_c", p.thermal_max_c);
+        line("thermal_timeout_s", p.thermal_timeout_s);
+        line("thermal_log_path", p.thermal_log_path.string());
+        line("predict_activations", p.predict_activations ? "on" : "off");
+        line("refresh_window_trefis", p.refresh_window_trefis);
+        line("activation_log_path", p.activation_log_path.string());
+        line("traffic", p.traffic);
+        line("traffic_cores", '[' + join(p.traffic_cores) + ']');
+        line("traffic_mbps", p.traffic_mbps);
+        line("traffic_buffer_mib", p.traffic_buffer_mib);
+        line("traffic_log_path", p.traffic_log_path.string());
 
         line("target_subch", '[' + join(p.target_subch) + ']');
         line("target_ranks", '[' + join(p.target_ranks) + ']');
@@ -83,6 +198,7 @@ struct cli_params {
         line("target_banks", '[' + join(p.target_banks) + ']');
 
         line("csv_path", p.csv_path.string());
+        line("profile_dir", p.profile_dir.string());
         return os;
     }
 };
@@ -117,8 +233,9 @@ inline std::vector<int> parse_range(const std::string& input) {
     return values;
 }
 
-cli_params parse_cli(int argc, char* argv[]) {
-    cli_params p;
+/// Parses @p argv into @p p. Returns -1 on success, otherwise the exit code
+/// after printing help or the error (so phoenixd can reject a job and go on).
+inline int parse_cli(int argc, const char* const argv[], cli_params& p) {
     CLI::App app{ "Phoenix" };
 
     //------------------------------------------------------------------
@@ -158,6 +275,10 @@ cli_params parse_cli(int argc, char* argv[]) {
     app.add_option("--ref-threshold", p.ref_threshold, "Latency threshold to infer that a REF command occurred (by detecting access slowdowns)")
         ->default_val(1150);
 
+    app.add_option("--ref-probe-width", p.ref_probe_width, "Sync lines per REF probe, each in another bank group and loaded in parallel; REF is detected when the whole group exceeds --ref-threshold (1 = one sync row at a time)")
+        ->default_val(1)
+        ->check(CLI::Range(1U, 8U));
+
     //------------------------------------------------------------------
     // Selectors
     //------------------------------------------------------------------
@@ -166,6 +287,38 @@ cli_params parse_cli(int argc, char* argv[]) {
     app.add_option("-p,--pattern", p.pattern_id,
                    "Which pattern to use (e.g., skh_mod128 or skh_mod2608)");
 
+    app.add_option("--kernels", p.kernels, "SIMD kernel variant for address translation, row fill and victim scan (auto, avx512, avx2 or scalar)")
+        ->default_val("auto")
+        ->check(CLI::IsMember({ "auto", "avx512", "avx2", "scalar" }));
+
+    app.add_option("--mapping", p.mapping, "Address translation: auto uses the compile-time mapping of the detected platform, generic the runtime matrix with the --kernels variant")
+        ->default_val("auto")
+        ->check(CLI::IsMember({ "auto", "generic" }));
+
+    app.add_flag("--mapping-bench", p.mapping_bench, "Time the generic and the compile-time address translation, then exit");
+
+    app.add_flag("--jit-hugepage,!--no-jit-hugepage", p.jit_hugepage, "Place the JIT-compiled hammer code in 2 MiB hugepages (default) instead of regular 4 KiB pages");
+
+    app.add_flag("--burst-timing", p.burst_timing, "Time every burst and count self-sync desync bursts in the JIT code (adds work after every burst; needed for the burst jitter summary and --desync-log)");
+
+    //------------------------------------------------------------------
+    // Access primitive
+    //------------------------------------------------------------------
+    app.add_option("--access-mode", p.access_mode, "How aggressor and sync row lines leave the cache after each load: clflush (clflushopt) or evict (loads of a per-line L3 eviction set, no flush instructions)")
+        ->default_val("clflush")
+        ->check(CLI::IsMember({ "clflush", "evict" }));
+
+    app.add_option("--evset-stride", p.evset_stride, "Stride in bytes of congruent eviction set candidates within the superpage (power of two spanning the L3 set index bits)")
+        ->default_val(1 << 18);
+
+    app.add_option("--evset-ways", p.evset_ways, "Target eviction set size, i.e. the L3 associativity")
+        ->default_val(16)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--trefi-ns", p.trefi_ns, "tREFI in nanoseconds, used to report achievable ACTs per tREFI of the access modes")
+        ->default_val(3900)
+        ->check(CLI::PositiveNumber);
+
     //------------------------------------------------------------------
     // Pattern layout
     //------------------------------------------------------------------
@@ -186,6 +339,136 @@ cli_params parse_cli(int argc, char* argv[]) {
         ->default_val(16)
         ->check(CLI::NonNegativeNumber);
 
+    app.add_option("--pattern-phase-offset", p.pattern_phase_offset, "Start the schedule this many tREFI slots into the pattern, i.e. hammer the phase a phase sweep logged as phase_offset (confirmation runs)")
+        ->default_val(0)
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_option("--row-remap", p.row_remap, "DIMM-internal row remapping used to place aggressor pairs and victims (as DramRowMapping of the FPGA experiments), or infer it from the flips of the first fuzz points")
+        ->default_val("direct")
+        ->check(CLI::IsMember({ "direct", "samsung", "micron", "infer" }));
+
+    app.add_option("--row-remap-lead", p.row_remap_lead, "With --row-remap infer, decide once a scheme explains this many more flipped rows than any other")
+        ->default_val(8)
+        ->check(CLI::PositiveNumber);
+
+    //------------------------------------------------------------------
+    // In-run phase sweep
+    //------------------------------------------------------------------
+    app.add_option("--phase-sweep-period", p.phase_sweep_period, "Advance the schedule by one extra tREFI slot every N tREFIs within a run, so one run walks through all phases of the pattern against the DIMM's refresh counter (0 = off)")
+        ->default_val(0)
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_option("--phase-sweep-log", p.phase_sweep_log_path, "Path to output CSV file with the phase windows of each phase-sweep run")
+        ->default_val("results/phase_windows.csv");
+
+    //------------------------------------------------------------------
+    // Coverage planner
+    //------------------------------------------------------------------
+    app.add_flag("--coverage", p.coverage, "Sweep aggressor placements over all rows of the mapped memory, stratified by bank and row region, instead of --aggressor-row-start..--aggressor-row-end");
+
+    app.add_option("--coverage-region-rows", p.coverage_region_rows, "Rows per region used to stratify the coverage sweep")
+        ->default_val(512)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--coverage-points", p.coverage_points, "Maximum number of placements to test in coverage mode (0 = all)")
+        ->default_val(0);
+
+    app.add_option("--coverage-report", p.coverage_report_path, "Path to output CSV file with per-region coverage (printed to stdout in any case)");
+
+    //------------------------------------------------------------------
+    // resctrl isolation
+    //------------------------------------------------------------------
+    app.add_flag("--resctrl", p.resctrl, "Run the hammer thread in a resctrl group with dedicated L3 ways, taken away from all other processes (needs resctrl mounted at /sys/fs/resctrl)");
+
+    app.add_option("--resctrl-l3-ways", p.resctrl_l3_ways, "Number of L3 ways reserved for the hammer thread")
+        ->default_val(4)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--resctrl-mba", p.resctrl_mba, "Memory bandwidth (MB schemata value: percent on Intel, 1/8 GB/s on AMD) of all other processes while hammering (-1 = unlimited)")
+        ->default_val(-1);
+
+    app.add_flag("--resctrl-compare", p.resctrl_compare, "Alternate fuzz points with and without isolation to compare their desync rates (implies --burst-timing)");
+
+    app.add_option("--desync-log", p.desync_log_path, "Path to output CSV file with the self-sync desync rate of each fuzz point (with --burst-timing)")
+        ->default_val("results/desync.csv");
+
+    //------------------------------------------------------------------
+    // Full-allocation integrity check
+    //------------------------------------------------------------------
+    app.add_option("--integrity-every", p.integrity_every, "Fill the whole allocation with the victim data pattern and verify all of it every N fuzz points, reporting flips outside the victim rows (0 = off)")
+        ->default_val(0)
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_option("--integrity-threads", p.integrity_threads, "Worker threads of the integrity check (0 = all cores except --core)")
+        ->default_val(0);
+
+    app.add_option("--integrity-log", p.integrity_log_path, "Path to output CSV file with the flips found by integrity checks")
+        ->default_val("results/integrity_flips.csv");
+
+    //------------------------------------------------------------------
+    // ECC corrected errors
+    //------------------------------------------------------------------
+    app.add_flag("--edac", p.edac, "Attribute corrected ECC errors (EDAC counters, decoded through RAS trace events when run as root) to fuzz points");
+
+    app.add_option("--edac-log", p.edac_log_path, "Path to output CSV file with the corrected errors of each fuzz point")
+        ->default_val("results/corrected_errors.csv");
+
+    //------------------------------------------------------------------
+    // DIMM temperature
+    //------------------------------------------------------------------
+    app.add_flag("--thermal", p.thermal, "Sample DIMM temperatures (hwmon spd5118/jc42 sensors) on a background thread and log them per fuzz point");
+
+    app.add_option("--thermal-period", p.thermal_period_ms, "Sampling period of the DIMM temperature sensors in milliseconds")
+        ->default_val(250)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--thermal-min", p.thermal_min_c, "Hold each fuzz point until all DIMM sensors read at least this many degrees Celsius (implies --thermal)")
+        ->default_val(0);
+
+    app.add_option("--thermal-max", p.thermal_max_c, "Hold each fuzz point until all DIMM sensors read at most this many degrees Celsius, 0 = no upper bound (implies --thermal)")
+        ->default_val(0)
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_option("--thermal-timeout", p.thermal_timeout_s, "Give up holding a fuzz point for the temperature band after this many seconds")
+        ->default_val(600)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--thermal-log", p.thermal_log_path, "Path to output CSV file with the DIMM temperatures of each fuzz point")
+        ->default_val("results/dimm_temperature.csv");
+
+    //------------------------------------------------------------------
+    // Activation prediction
+    //------------------------------------------------------------------
+    app.add_flag("--predict-activations", p.predict_activations, "Log for every bit flip the activations of its neighbour rows between two refreshes, predicted from the pattern schedule");
+
+    app.add_option("--refresh-window", p.refresh_window_trefis, "Refresh window in tREFIs, i.e. REF commands between two refreshes of the same row (8192 for DDR5 tREFW = 32 ms)")
+        ->default_val(8192)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--activation-log", p.activation_log_path, "Path to output CSV file with the predicted activations of each bit flip")
+        ->default_val("results/activation_counts.csv");
+
+    //------------------------------------------------------------------
+    // Background traffic
+    //------------------------------------------------------------------
+    app.add_option("--traffic", p.traffic, "Memory traffic to generate on other cores while fuzzing: stream (sequential reads), chase (random dependent loads), write (non-temporal stores) or off")
+        ->default_val("off")
+        ->check(CLI::IsMember({ "off", "stream", "chase", "write" }));
+
+    app.add_option("--traffic-cores", p.traffic_cores, "Cores of the traffic threads, one thread per core (default: the first core other than --core)")
+        ->expected(1, -1);
+
+    app.add_option("--traffic-mbps", p.traffic_mbps, "Target bandwidth of each traffic thread in MB/s (0 = as fast as possible)")
+        ->default_val(0)
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_option("--traffic-buffer", p.traffic_buffer_mib, "Buffer of each traffic thread in MiB, outside the test allocation; should exceed the LLC")
+        ->default_val(256)
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--traffic-log", p.traffic_log_path, "Path to output CSV file with the background traffic bandwidth of each fuzz point")
+        ->default_val("results/background_traffic.csv");
+
     //------------------------------------------------------------------
     // Target selection
     //------------------------------------------------------------------
@@ -211,10 +494,24 @@ cli_params parse_cli(int argc, char* argv[]) {
     //------------------------------------------------------------------
     app.add_option("--csv", p.csv_path, "Path to output CSV file containing bit flip results");
 
+    //------------------------------------------------------------------
+    // Calibration profile
+    //------------------------------------------------------------------
+    app.add_option("--profile-dir", p.profile_dir, "Directory of per-host/DIMM calibration profiles used to warm-start the sweep (default: none, profiles disabled)");
+
+    app.add_flag("--profile-invalidate", p.profile_invalidate, "Discard the calibration profile of this host/DIMM before running");
+
     try {
         app.parse(argc, argv);
     } catch(const CLI::ParseError& e) {
-        std::exit(app.exit(e));
+        return app.exit(e);
+    }
+
+    for(const char* opt : { "--ref-threshold", "--reads-per-trefi", "--self-sync-cycles",
+                            "--column-stride", "--pattern" }) {
+        if(app.count(opt) > 0) {
+            p.explicit_options.insert(opt);
+        }
     }
 
     //------------------------------------------------------------------
@@ -226,8 +523,16 @@ cli_params parse_cli(int argc, char* argv[]) {
     } catch(const std::exception& e) {
         std::cerr << "Failed to parse --self-sync-cycles or --reads-per-trefi: "
                   << e.what() << "\n";
-        std::exit(1);
+        return 1;
     }
 
+    return -1;
+}
+
+inline cli_params parse_cli(int argc, char* argv[]) {
+    cli_params p;
+    if(const int code = parse_cli(argc, argv, p); code >= 0) {
+        std::exit(code);
+    }
     return p;
 }
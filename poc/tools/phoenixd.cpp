@@ -0,0 +1,299 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include "campaign.hpp"
+
+// Protocol (SOCK_SEQPACKET, one message each way):
+//   request: "<cwd>\0<arg>\0<arg>\0..." with the client's stdout and stderr
+//            attached as SCM_RIGHTS, so job output goes straight to the client
+//   reply:   the job's exit code as int32_t
+// Jobs run one at a time; queued clients wait in the listen backlog.
+
+static constexpr std::size_t kMaxRequest = 64 * 1024;
+
+static bool send_request(int sock, const std::string& payload, int out_fd, int err_fd) {
+    iovec iov{ const_cast<char*>(payload.data()), payload.size() };
+    alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr* c    = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type  = SCM_RIGHTS;
+    c->cmsg_len   = CMSG_LEN(2 * sizeof(int));
+    const int fds[2]{ out_fd, err_fd };
+    std::memcpy(CMSG_DATA(c), fds, sizeof(fds));
+    return sendmsg(sock, &msg, 0) == static_cast<ssize_t>(payload.size());
+}
+
+/// Returns cwd followed by the arguments; @p fds receives stdout and stderr.
+static std::optional<std::vector<std::string>> recv_request(int sock, int fds[2]) {
+    std::vector<char> buf(kMaxRequest);
+    iovec iov{ buf.data(), buf.size() };
+    alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    const ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    for(cmsghdr* c = CMSG_FIRSTHDR(&msg); n >= 0 && c; c = CMSG_NXTHDR(&msg, c)) {
+        if(c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS &&
+           c->cmsg_len == CMSG_LEN(2 * sizeof(int))) {
+            std::memcpy(fds, CMSG_DATA(c), 2 * sizeof(int));
+        }
+    }
+    if(n <= 0 || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || fds[0] < 0 || fds[1] < 0) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> fields;
+    for(ssize_t start = 0, i = 0; i < n; ++i) {
+        if(buf[i] == '\0') {
+            fields.emplace_back(buf.data() + start, i - start);
+            start = i + 1;
+        }
+    }
+    if(fields.empty()) {
+        return std::nullopt;
+    }
+    return fields;
+}
+
+/// Sets @p stop once the client hangs up (it sends nothing after the request).
+/// Runs off the hammer core and without the daemon's real-time priority.
+static void watch_client(int conn, int hammer_core, std::atomic<bool>* stop,
+                         const std::atomic<bool>* done) {
+    sched_param normal{};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &normal);
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for(long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); ++cpu) {
+        if(cpu != hammer_core) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    while(!done->load()) {
+        pollfd p{ conn, POLLIN, 0 };
+        if(poll(&p, 1, 100) > 0) {
+            stop->store(true);
+            return;
+        }
+    }
+}
+
+static void run_job(int conn, host_context& host, uint64_t id) {
+    const auto submitted = std::chrono::steady_clock::now();
+    int fds[2]{ -1, -1 };
+    const auto request = recv_request(conn, fds);
+    if(!request) {
+        std::cerr << "[!] job " << id << ": malformed request\n";
+        for(int fd : fds) {
+            if(fd >= 0) {
+                close(fd);
+            }
+        }
+        return;
+    }
+
+    // Everything the campaign prints goes to the client from here on
+    std::cout.flush();
+    const int saved_out = dup(STDOUT_FILENO), saved_err = dup(STDERR_FILENO);
+    dup2(fds[0], STDOUT_FILENO);
+    dup2(fds[1], STDERR_FILENO);
+
+    int code = EXIT_FAILURE;
+    std::atomic<bool> stop{ false }, done{ false };
+    campaign_control control;
+    control.stop = &stop;
+    if(chdir(request->front().c_str()) != 0) {
+        std::cerr << "[!] phoenixd cannot enter " << request->front() << ": "
+                  << std::strerror(errno) << '\n';
+    } else {
+        std::vector<const char*> argv{ "phoenix" };
+        for(std::size_t i = 1; i < request->size(); ++i) {
+            argv.push_back((*request)[i].c_str());
+        }
+        cli_params params;
+        code = parse_cli(static_cast<int>(argv.size()), argv.data(), params);
+        if(code < 0) {
+            std::thread watcher(watch_client, conn, params.cpu_core, &stop, &done);
+            try {
+                code = run_campaign(std::move(params), host, &control);
+            } catch(const std::exception& e) {
+                std::cerr << "[!] " << e.what() << '\n';
+                code = EXIT_FAILURE;
+            }
+            done = true;
+            watcher.join();
+        }
+    }
+    std::string startup;
+    if(control.first_hammer) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1)
+           << std::chrono::duration<double, std::milli>(*control.first_hammer - submitted).count()
+           << " ms";
+        startup = ss.str();
+        std::cout << "[+] phoenixd: first hammer run " << startup << " after submission\n";
+    }
+
+    std::cout.flush();
+    dup2(saved_out, STDOUT_FILENO);
+    dup2(saved_err, STDERR_FILENO);
+    for(int fd : { saved_out, saved_err, fds[0], fds[1] }) {
+        close(fd);
+    }
+    if(chdir("/") != 0) {
+        std::cerr << "[!] cannot leave " << request->front() << '\n';
+    }
+
+    std::cout << "[+] job " << id << ": exit " << code << (stop ? " (cancelled)" : "");
+    if(!startup.empty()) {
+        std::cout << ", first hammer run after " << startup;
+    }
+    std::cout << '\n';
+
+    const int32_t reply = code;
+    send(conn, &reply, sizeof(reply), MSG_NOSIGNAL);
+}
+
+static int make_socket(const std::string& path, sockaddr_un& addr) {
+    if(path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[!] socket path too long: " << path << '\n';
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    const int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if(sock < 0) {
+        std::cerr << "[!] socket: " << std::strerror(errno) << '\n';
+    }
+    return sock;
+}
+
+static int serve(const std::string& socket_path) {
+    auto host = init_host();
+    if(!host) {
+        return EXIT_FAILURE;
+    }
+    // A client that goes away must not take the daemon with it
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un addr{};
+    const int listen_fd = make_socket(socket_path, addr);
+    if(listen_fd < 0) {
+        return EXIT_FAILURE;
+    }
+    unlink(socket_path.c_str());
+    if(bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+       chmod(socket_path.c_str(), 0600) != 0 || listen(listen_fd, 16) != 0) {
+        std::cerr << "[!] cannot listen on " << socket_path << ": " << std::strerror(errno)
+                  << '\n';
+        return EXIT_FAILURE;
+    }
+    std::cout << "[+] phoenixd listening on " << socket_path << '\n';
+
+    for(uint64_t job = 1;; ++job) {
+        const int conn = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if(conn < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[!] accept: " << std::strerror(errno) << '\n';
+            return EXIT_FAILURE;
+        }
+        run_job(conn, *host, job);
+        close(conn);
+    }
+}
+
+static int submit(const std::string& socket_path, const std::vector<std::string>& args) {
+    sockaddr_un addr{};
+    const int sock = make_socket(socket_path, addr);
+    if(sock < 0) {
+        return EXIT_FAILURE;
+    }
+    if(connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "[!] cannot connect to " << socket_path << " (is phoenixd running?): "
+                  << std::strerror(errno) << '\n';
+        return EXIT_FAILURE;
+    }
+
+    char cwd[PATH_MAX];
+    if(!getcwd(cwd, sizeof(cwd))) {
+        std::cerr << "[!] getcwd: " << std::strerror(errno) << '\n';
+        return EXIT_FAILURE;
+    }
+    std::string payload = cwd;
+    payload += '\0';
+    for(const auto& arg : args) {
+        payload += arg;
+        payload += '\0';
+    }
+    if(payload.size() > kMaxRequest || !send_request(sock, payload, STDOUT_FILENO, STDERR_FILENO)) {
+        std::cerr << "[!] cannot submit job: " << std::strerror(errno) << '\n';
+        return EXIT_FAILURE;
+    }
+
+    int32_t code;
+    if(recv(sock, &code, sizeof(code), 0) != sizeof(code)) {
+        std::cerr << "[!] phoenixd closed the connection\n";
+        return EXIT_FAILURE;
+    }
+    return code;
+}
+
+int main(int argc, char* argv[]) {
+    CLI::App app{ "Phoenix daemon: maps memory once and runs campaigns submitted over a Unix socket" };
+    app.require_subcommand(1);
+    app.fallthrough();
+
+    std::string socket_path;
+    app.add_option("-s,--socket", socket_path, "Unix socket of the daemon")
+        ->default_val("/run/phoenixd.sock");
+
+    auto* serve_cmd = app.add_subcommand("serve", "Set up the host once and run submitted campaigns one at a time");
+
+    std::vector<std::string> args;
+    auto* submit_cmd = app.add_subcommand("submit", "Run a campaign on phoenixd and stream its output; phoenix options follow --");
+    submit_cmd->add_option("args", args, "phoenix options");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if(serve_cmd->parsed()) {
+        return serve(socket_path);
+    }
+    if(submit_cmd->parsed()) {
+        return submit(socket_path, args);
+    }
+    return EXIT_FAILURE;
+}